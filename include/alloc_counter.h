@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+
+// 全局堆分配计数
+// 以 ANIM_COUNT_ALLOCS 构建时 alloc_counter.cpp 替换全局 operator new / delete，每次分配累加计数；
+// 用于验证稳定状态下的帧循环不产生堆分配 (取前后差值)。替换会让整个进程 (含第三方库) 的每次分配多一次原子加法，
+// 因此默认关闭，此时不替换分配函数，alloc_count 恒为 0
+#ifdef ANIM_COUNT_ALLOCS
+constexpr bool kAllocCountEnabled = true;
+#else
+constexpr bool kAllocCountEnabled = false;
+#endif
+uint64_t alloc_count();
@@ -0,0 +1,12 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// 基准测试入口
+// 通过命令行 `--bench <名称> [参数...]` 运行，结果输出到标准输出
+
+// 判断指定基准是否需要 OpenGL 上下文 (需要时由 main 先创建隐藏窗口)
+bool bench_needs_gl(const std::string& name);
+
+// 运行指定基准，返回进程退出码 (未知名称时打印可用列表并返回 -1)
+int bench_run(const std::string& name, const std::vector<std::string>& args);
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "glm.hpp"
+#include "cluster_culling.h"
+
+// 包围盒与球是否相交 (球心到包围盒的最近距离不超过半径)
+bool aabb_sphere_overlap(const glm::vec3& lo, const glm::vec3& hi, const glm::vec3& center, float radius);
+// 包围盒与射线段是否相交 (slab 测试)；invDir 为方向各分量的倒数，t ∈ [0, maxT]，相交时可输出进入点的 t
+bool aabb_ray_overlap(const glm::vec3& lo, const glm::vec3& hi, const glm::vec3& origin, const glm::vec3& invDir, float maxT,
+                      float* enterT = nullptr);
+
+// 层次包围盒统计
+struct BvhStats {
+    size_t objects = 0;    // 树中的对象数
+    size_t nodes = 0;      // 节点数 (含叶子)
+    size_t rebuilds = 0;   // 累计重建次数
+    size_t refits = 0;     // 累计重新拟合的叶子数
+    float sahRatio = 1.0f; // 当前 SAH 代价 / 重建时的代价
+};
+
+// 动态层次包围盒 (AABB 树)
+// 每个叶子一个对象，对象以调用方的编号 (如立方体下标) 标识
+// - 对象包围盒变化时只更新叶子并记录，maintain 时沿父节点向上重新拟合 (包围盒不变时提前结束)
+// - 新对象在 maintain 时按 SAH 代价选择兄弟节点插入 (一次新增很多对象时直接重建)，移除时由兄弟节点替代父节点
+// - 重新拟合会使树质量下降：SAH 代价超过重建时的 kRebuildRatio 倍，或累计更新数超过对象数时，
+//   在 maintain 中按分桶 SAH 整体重建
+// 查询前须先 maintain；查询使用内部的遍历栈，不能在多个线程上同时查询
+class Bvh {
+public:
+    static constexpr uint32_t kNull = ~0u;
+    static constexpr float kRebuildRatio = 1.5f;
+
+    // 设置或更新对象的包围盒 (世界空间)
+    void set(uint32_t object, const glm::vec3& lo, const glm::vec3& hi);
+    // 移除对象 (不在树中时忽略)
+    void remove(uint32_t object);
+    bool contains(uint32_t object) const { return object < objectLeaf_.size() && objectLeaf_[object] != kNull; }
+    // 清空
+    void clear();
+
+    // 重新拟合变化的叶子，必要时整体重建
+    void maintain();
+    // 按分桶 SAH 整体重建
+    void rebuild();
+
+    // 与视锥相交的对象追加到 out (节点完全位于视锥内时其子树不再测试)，返回访问的节点数
+    size_t queryFrustum(const Frustum& frustum, std::vector<uint32_t>& out) const;
+    // 与球相交的对象追加到 out，返回访问的节点数
+    size_t querySphere(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const;
+    // 包围盒与射线段 origin + t * dir (t ∈ [0, maxT]) 相交的对象追加到 out，返回访问的节点数
+    size_t queryRay(const glm::vec3& origin, const glm::vec3& dir, float maxT, std::vector<uint32_t>& out) const;
+
+    BvhStats stats() const;
+
+private:
+    struct Node {
+        glm::vec3 lo, hi;
+        uint32_t parent = kNull;
+        uint32_t child[2] = { kNull, kNull };
+        uint32_t object = kNull; // 叶子节点的对象 (内部节点为 kNull)
+        bool leaf() const { return object != kNull; }
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> freeNodes_;    // 可复用的节点
+    std::vector<uint32_t> objectLeaf_;   // 对象 → 叶子节点
+    std::vector<uint32_t> dirtyLeaves_;  // 包围盒变化、等待重新拟合的叶子
+    std::vector<uint32_t> pendingLeaves_; // 尚未插入树中的新叶子
+    uint32_t root_ = kNull;
+    size_t objectCount_ = 0;
+    size_t updatesSinceBuild_ = 0;
+    size_t rebuilds_ = 0;
+    size_t refits_ = 0;
+    double internalArea_ = 0.0;          // 内部节点表面积之和 (SAH 代价的分子)
+    double builtCost_ = 0.0;             // 重建时的 SAH 代价
+    mutable std::vector<uint64_t> stack_; // 遍历栈 (低 32 位为节点，视锥查询时高位为仍需测试的平面掩码)
+
+    bool inTree(uint32_t node) const { return node == root_ || nodes_[node].parent != kNull; }
+    uint32_t allocNode();
+    void freeNode(uint32_t node);
+    // 设置节点包围盒，同时维护内部节点的表面积之和
+    void setBounds(uint32_t node, const glm::vec3& lo, const glm::vec3& hi);
+    // 由子节点重新计算包围盒，返回包围盒是否变化
+    bool refitNode(uint32_t node);
+    void insertLeaf(uint32_t leaf);
+    void removeLeaf(uint32_t leaf);
+    // 当前 SAH 代价 (内部节点表面积之和 / 根节点表面积)
+    double sahCost() const;
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "glm.hpp"
+#include "mesh.h"
+
+// 视锥体
+// 6 个平面 (左、右、下、上、近、远)，法线指向内侧并已归一化：dot(plane.xyz, p) + plane.w >= 0 为内侧
+struct Frustum {
+    glm::vec4 planes[6];
+
+    // 从裁剪矩阵提取平面 (Gribb-Hartmann)
+    // 传入 projection * view 得到世界空间平面，再乘以模型矩阵则得到模型空间平面
+    static Frustum fromMatrix(const glm::mat4& clip);
+    // 包围球是否与视锥相交 (保守判断，可能把视锥角落外的球判为可见)
+    bool intersectsSphere(const glm::vec3& center, float radius) const;
+};
+
+// 簇背面判断
+// 法线锥完全背向视点时返回 true；eye 与簇数据须在同一空间 (通常为模型空间)
+// 使用包围球的保守形式，视点位于簇附近时不会误剔除
+bool cluster_backfacing(const Meshlet& m, const glm::vec3& eye);
+
+// 逐簇剔除统计 (可在多个 Pass 之间累加)
+struct ClusterCullStats {
+    size_t meshes = 0;          // 参与剔除的网格数
+    size_t meshesCulled = 0;    // 包围球整体位于视锥外的网格数
+    size_t clusters = 0;        // 逐簇测试的簇数
+    size_t frustumCulled = 0;   // 视锥外的簇数
+    size_t backfaceCulled = 0;  // 背面的簇数
+    size_t triangles = 0;       // 剔除后提交的三角形数
+    size_t fullTriangles = 0;   // 不剔除时提交的三角形数
+
+    ClusterCullStats& operator+=(const ClusterCullStats& o) {
+        meshes += o.meshes;
+        meshesCulled += o.meshesCulled;
+        clusters += o.clusters;
+        frustumCulled += o.frustumCulled;
+        backfaceCulled += o.backfaceCulled;
+        triangles += o.triangles;
+        fullTriangles += o.fullTriangles;
+        return *this;
+    }
+};
+
+// 逐簇剔除单个网格
+// frustum 与 eye 须与簇数据在同一空间；存活簇的索引追加到 out，统计累加到 stats
+// 只更新 clusters / frustumCulled / backfaceCulled / triangles
+void cluster_cull_mesh(const std::vector<Meshlet>& meshlets, const unsigned int* indices, const Frustum& frustum,
+                       const glm::vec3& eye, bool backface, std::vector<uint32_t>& out, ClusterCullStats& stats);
@@ -4,6 +4,9 @@
 #include <string>
 #include "glm.hpp"
 #include "shader.h"
+#include "vertex_format.h"
+#include "geometry_pool.h"
+#include "instance_buffer.h"
 
 // 立方体顶点结构
 struct VertexCube {
@@ -19,7 +22,10 @@ public:
     // 构造函数
     // length, width, height: 立方体的长宽高
     // color: 立方体的基础颜色
-    Cube(float length, float width, float height, glm::vec3 color);
+    // format: GPU 端顶点格式 (Packed 时使用 16 字节压缩顶点与 16 位索引)
+    // pool: 立方体布局的共享几何池 (格式须一致)，为空时使用独立缓冲区
+    Cube(float length, float width, float height, glm::vec3 color, VertexFormat format = VertexFormat::Float32,
+         GeometryPool* pool = nullptr);
     ~Cube();
 
     // 禁止拷贝构造和赋值操作，防止 VAO/VBO 双重释放 (RAII)
@@ -37,10 +43,23 @@ public:
     
     // 绘制立方体
     void Draw(Shader &shader);
+    // 在绘制用的 VAO 上配置实例属性 (几何池中的立方体配置在池的 VAO 上，池内其他对象不应使用实例属性)
+    void attachInstances(const CubeInstanceBuffer &instances);
+    // 实例化绘制 instanceCount 个立方体 (须先 attachInstances)
+    void DrawInstanced(Shader &shader, uint32_t instanceCount);
+    // 绘制时绑定的 VAO (几何池中的立方体为池的 VAO)
+    GLuint vertexArray() const { return pool_ ? pool_->vertexArray() : VAO; }
 
 private:
-    unsigned int VAO, VBO, EBO; // OpenGL 资源 ID
+    unsigned int VAO, VBO, EBO; // OpenGL 资源 ID (使用几何池时为 0)
+    GeometryPool* pool_;         // 共享几何池
+    GeometryAllocation alloc_;   // 在几何池中的分配
+    VertexFormat format_;        // GPU 端顶点格式
+    GLenum indexType_;           // 索引类型
+    PositionQuantization quant_; // 位置反量化参数
 
     // 构建立方体网格数据
     void build(float length, float width, float height, glm::vec3 color);
+    // 设置顶点解码参数
+    void setDecode(Shader &shader);
 };
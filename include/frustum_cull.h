@@ -0,0 +1,66 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "glm.hpp"
+#include "cluster_culling.h"
+
+class ThreadPool;
+
+// 包围盒数组 (SoA)
+// 中心与半边长的各分量分别连续存放，剔除时一次加载 4 个包围盒的同一分量；存储补齐到 4 的倍数
+// 半边长为负的包围盒始终被剔除 (用于占位的隐藏对象)
+struct AabbSoA {
+    std::vector<float> cx, cy, cz; // 中心
+    std::vector<float> ex, ey, ez; // 半边长
+
+    // 设置数量 (新增项为空盒)，保留已有项
+    void resize(size_t count);
+    size_t size() const { return count_; }
+    void set(size_t index, const glm::vec3& center, const glm::vec3& extent);
+    // 标记为始终剔除
+    void hide(size_t index) { set(index, glm::vec3(0.0f), glm::vec3(-1e30f)); }
+
+private:
+    size_t count_ = 0;
+};
+
+// 变换包围盒 (Arvo)：中心按矩阵变换，半边长乘以矩阵左上 3x3 的逐元素绝对值
+inline void aabb_transform(const glm::mat4& m, const glm::vec3& center, const glm::vec3& extent,
+                           glm::vec3& outCenter, glm::vec3& outExtent)
+{
+    outCenter = glm::vec3(m * glm::vec4(center, 1.0f));
+    outExtent = glm::abs(glm::vec3(m[0])) * extent.x + glm::abs(glm::vec3(m[1])) * extent.y + glm::abs(glm::vec3(m[2])) * extent.z;
+}
+
+// 平面到包围盒最靠内角点的有符号距离，小于 0 时包围盒完全位于平面外侧
+// 求和顺序与 SSE 实现一致，保证标量、SIMD 与层次包围盒的测试结果逐项相同
+inline float aabb_plane_reach(const glm::vec4& p, const glm::vec3& c, const glm::vec3& e)
+{
+    return p.x * c.x + p.w + p.y * c.y + p.z * c.z + std::abs(p.x) * e.x + std::abs(p.y) * e.y + std::abs(p.z) * e.z;
+}
+
+// 以同一矩阵变换全部包围盒 (out 的数量调整为与 in 相同)
+void aabb_transform_all(const glm::mat4& m, const AabbSoA& in, AabbSoA& out);
+
+// 视锥剔除统计
+struct FrustumCullStats {
+    size_t tested = 0;   // 测试的包围盒数 (不含隐藏项)
+    size_t visible = 0;  // 与视锥相交的包围盒数
+
+    FrustumCullStats& operator+=(const FrustumCullStats& o) {
+        tested += o.tested;
+        visible += o.visible;
+        return *this;
+    }
+};
+
+// 包围盒视锥剔除
+// visible[i] 为 1 表示第 i 个包围盒与视锥相交 (保守判断：按平面逐个测试最靠内的角点)，返回可见数
+// 使用 SSE 一次测试 4 个包围盒；数量超过 kParallelCullMin 且提供 pool 时分块并行
+const size_t kParallelCullMin = 16384;
+size_t frustum_cull_aabbs(const Frustum& frustum, const AabbSoA& boxes, std::vector<uint8_t>& visible,
+                          ThreadPool* pool = nullptr);
+// 逐个包围盒的标量实现 (基准对比与不支持 SSE 的平台)
+size_t frustum_cull_aabbs_scalar(const Frustum& frustum, const AabbSoA& boxes, std::vector<uint8_t>& visible);
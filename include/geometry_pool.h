@@ -0,0 +1,109 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <glad/glad.h>
+#include "vertex_format.h"
+
+// 区间空闲链表分配器
+// 以元素为单位管理 [0, capacity) 区间；首次适配分配，释放时与相邻空闲块合并
+class FreeListAllocator {
+public:
+    explicit FreeListAllocator(uint32_t capacity = 0);
+
+    // 分配 size 个元素，空间不足时返回 false
+    bool allocate(uint32_t size, uint32_t& outOffset);
+    // 释放之前分配的区间
+    void free(uint32_t offset, uint32_t size);
+    // 扩容 (新增部分并入空闲空间)
+    void grow(uint32_t newCapacity);
+
+    uint32_t capacity() const { return capacity_; }
+    uint32_t used() const { return used_; }
+    // 最大连续空闲块 (衡量碎片化程度)
+    uint32_t largestFree() const;
+
+private:
+    std::map<uint32_t, uint32_t> free_; // 空闲块：起始偏移 -> 长度
+    uint32_t capacity_;
+    uint32_t used_;
+};
+
+// 几何池中的一段分配 (偏移以元素为单位)
+struct GeometryAllocation {
+    uint32_t vertexOffset = 0;
+    uint32_t vertexCount = 0;
+    uint32_t indexOffset = 0;
+    uint32_t indexCount = 0;
+
+    bool valid() const { return vertexCount > 0; }
+};
+
+// 共享几何池
+// 同一顶点格式的所有静态网格子分配在一对大缓冲区中，共用一个 VAO；
+// 绘制时通过 glDrawElementsBaseVertex 指定偏移，索引相对于各自的基准顶点
+// 空间不足时按倍数扩容并用 glCopyBufferSubData 迁移已有数据
+class GeometryPool {
+public:
+    // format/cubeLayout: 顶点格式与布局 (决定顶点步长与属性配置)
+    // Packed 格式使用 16 位索引 (相对基准顶点)，顶点数不少于 65536 的网格不能放入池中
+    GeometryPool(VertexFormat format, bool cubeLayout = false, uint32_t vertexCapacity = 1u << 16, uint32_t indexCapacity = 1u << 18);
+    ~GeometryPool();
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    // 判断网格能否放入池中
+    bool accepts(size_t vertexCount) const;
+    // 分配并上传顶点/索引 (数据须已是池的顶点格式与索引类型)，失败时返回无效分配
+    GeometryAllocation add(const void* vertices, uint32_t vertexCount, const void* indices, uint32_t indexCount);
+    // 释放分配，空间可被之后添加的网格复用
+    void remove(const GeometryAllocation& alloc);
+
+    // 绑定池的 VAO
+    void bind() const;
+    // 绘制一段分配 (调用前需 bind)
+    void draw(const GeometryAllocation& alloc) const;
+    // 绘制分配内的一段索引 (firstIndex 相对分配起点，用于 LOD 等子范围)
+    void draw(const GeometryAllocation& alloc, uint32_t firstIndex, uint32_t indexCount) const;
+    // 实例化绘制一段分配 (实例属性由调用方配置在池的 VAO 上)
+    void drawInstanced(const GeometryAllocation& alloc, uint32_t instanceCount) const;
+
+    // 每帧索引流：剔除后压缩的索引写入独立的流式索引缓冲区 (格式同池的索引类型，相对各自的基准顶点)
+    // 通过与主 VAO 共享顶点缓冲区的第二个 VAO 绘制；每次上传时重新分配存储，不与仍在使用的旧数据同步
+    void uploadStream(const void* indices, size_t indexCount);
+    // 绑定流式 VAO
+    void bindStream() const;
+    // 绘制流中的一段索引 (调用前需 bindStream)
+    void drawStream(uint32_t firstIndex, uint32_t indexCount, uint32_t vertexOffset) const;
+
+    VertexFormat format() const { return format_; }
+    GLenum indexType() const { return indexType_; }
+    GLuint vertexArray() const { return vao_; }
+    GLuint streamVertexArray() const { return streamVao_; }
+    size_t vertexStride() const { return vertexStride_; }
+    size_t indexSize() const { return indexSize_; }
+
+    // 统计
+    size_t allocationCount() const { return allocations_; }
+    const FreeListAllocator& vertexSpace() const { return vertexSpace_; }
+    const FreeListAllocator& indexSpace() const { return indexSpace_; }
+
+private:
+    VertexFormat format_;
+    bool cubeLayout_;
+    GLenum indexType_;
+    size_t vertexStride_;
+    size_t indexSize_;
+    GLuint vao_, vbo_, ebo_;
+    GLuint streamVao_, streamEbo_;
+    size_t streamCapacity_;  // 流式索引缓冲区容量 (索引数)
+    FreeListAllocator vertexSpace_;
+    FreeListAllocator indexSpace_;
+    size_t allocations_;
+
+    // 重新分配缓冲区并迁移数据
+    void growBuffer(GLuint& buffer, size_t oldBytes, size_t newBytes);
+    // 配置 VAO (缓冲区重建后需重新调用)
+    void setupVao();
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <glad/glad.h>
+
+// GL 状态调用计数 (所有调用累计，取前后差值得到每帧数量)
+struct GLStateCounters {
+    uint64_t issued = 0;  // 实际执行的 GL 调用数
+    uint64_t elided = 0;  // 与缓存状态相同而省略的调用数
+};
+
+// GL 状态缓存
+// 记录程序、VAO、各纹理单元的绑定、帧缓冲、视口、深度/剔除开关与当前纹理单元，
+// 设置与缓存相同的状态时不调用 GL。只在 GL 线程上使用；绘制与资源创建路径都需经由它修改这些状态，
+// 其他直接调用 GL 的代码 (如 ImGui 后端) 结束后调用 invalidate()
+class GLState {
+public:
+    // 可跟踪的纹理单元数 (更高的单元直接调用 GL)
+    static const int kMaxTextureUnits = 8;
+    // 可跟踪的 Uniform 缓冲区绑定点数
+    static const int kMaxUniformBindings = 4;
+
+    // 全局实例 (对应唯一的 GL 上下文)
+    static GLState& shared();
+
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vao);
+    // 切换当前纹理单元 (unit 为下标，不是 GL_TEXTURE0 + n)
+    void activeTexture(GLuint unit);
+    // 在指定单元上绑定纹理 (只有绑定变化时才切换当前纹理单元)
+    void bindTexture(GLuint unit, GLenum target, GLuint texture);
+    // 在当前纹理单元上绑定纹理 (资源创建时使用)
+    void bindTexture(GLenum target, GLuint texture);
+    void bindFramebuffer(GLuint framebuffer);
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    void setDepthTest(bool enabled);
+    void setCullFace(bool enabled);
+    // 剔除的面 (GL_BACK / GL_FRONT)
+    void cullFace(GLenum mode);
+    // Uniform 缓冲区的区间绑定 (glBindBufferRange(GL_UNIFORM_BUFFER, ...))
+    void bindUniformRange(GLuint binding, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+    // 对象删除前调用：删除已绑定的对象会使绑定回到 0，名字随后可能被复用
+    void forgetProgram(GLuint program);
+    void forgetVertexArray(GLuint vao);
+    void forgetTexture(GLuint texture);
+    void forgetFramebuffer(GLuint framebuffer);
+    void forgetBuffer(GLuint buffer);
+
+    // 使全部缓存失效，之后的每项设置都会执行一次 GL 调用
+    void invalidate();
+
+    const GLStateCounters& counters() const { return counters_; }
+
+private:
+    GLState();
+
+    // 三态开关：未知时一定执行
+    enum class Flag : uint8_t { Unknown, Off, On };
+
+    struct TextureUnit {
+        GLuint texture2D;
+        GLuint textureCube;
+        bool known;
+    };
+    struct UniformRange {
+        GLuint buffer;
+        GLintptr offset;
+        GLsizeiptr size;
+        bool known;
+    };
+
+    GLuint program_;
+    GLuint vao_;
+    GLuint activeUnit_;
+    GLuint framebuffer_;
+    GLint viewport_[4];
+    bool programKnown_;
+    bool vaoKnown_;
+    bool activeUnitKnown_;
+    bool framebufferKnown_;
+    bool viewportKnown_;
+    Flag depthTest_;
+    Flag cullFace_;
+    GLenum cullMode_;
+    TextureUnit units_[kMaxTextureUnits];
+    UniformRange uniformRanges_[kMaxUniformBindings];
+    GLStateCounters counters_;
+
+    // 与缓存比较：相同返回 false 并计入 elided，否则计入 issued
+    bool change(bool same);
+    void setFlag(Flag& cached, GLenum cap, bool enabled);
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <glad/glad.h>
+
+// GPU 计时器 (GL_TIME_ELAPSED 查询)
+// 每帧一次 begin/end；查询在环形队列中轮换，只读取已经可用的旧结果，不等待 GPU
+// 同一时刻只能有一个 GL_TIME_ELAPSED 查询处于活动状态，计时区间不能嵌套
+class GpuTimer {
+public:
+    GpuTimer();
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    // 一次计时的结果，tag 为 begin 时传入的标记 (如渲染模式)
+    struct Result {
+        double ms;
+        int tag;
+    };
+
+    void begin(int tag = 0);
+    void end();
+
+    // 最近一次可用的结果 (毫秒)；尚无结果时为 0
+    double lastMs() const { return lastMs_; }
+    // 按提交顺序取出一个新收到的结果 (每个结果只取出一次)，没有新结果时返回 false
+    bool popResult(Result& out);
+
+private:
+    static const int kQueries = 4; // 在途查询数 (GPU 最多落后几帧)
+
+    GLuint queries_[kQueries];
+    bool issued_[kQueries];  // 查询是否已提交且结果尚未读取
+    int tags_[kQueries];     // 各查询提交时的标记
+    Result ready_[kQueries]; // 已读取、尚未取出的结果 (按提交顺序)
+    int readyCount_;
+    int next_;               // 下一次 begin 使用的查询
+    bool active_;
+    double lastMs_;
+
+    // 读取所有已可用的结果
+    void collect();
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// FNV-1a 64 位哈希
+// 用于缓存失效校验 (源文件内容、导入参数等)，不用于安全场景
+const uint64_t kFnv64Offset = 0xcbf29ce484222325ull;
+const uint64_t kFnv64Prime = 0x100000001b3ull;
+
+inline uint64_t fnv1a64(const void* data, size_t size, uint64_t seed = kFnv64Offset) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= kFnv64Prime;
+    }
+    return h;
+}
+
+// 以 0 结尾字符串的 FNV-1a 64 位哈希，可在编译期求值 (与 fnv1a64 对相同字节的结果一致)
+constexpr uint64_t fnv1a64_str(const char* s, uint64_t seed = kFnv64Offset) {
+    uint64_t h = seed;
+    for (; *s; ++s) {
+        h ^= static_cast<unsigned char>(*s);
+        h *= kFnv64Prime;
+    }
+    return h;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include "glm.hpp"
+
+// 实例属性的起始 location (0 - 2 为立方体顶点属性)
+// 3 - 6: 模型矩阵，7 - 9: 法线矩阵，10: 颜色
+const GLuint kInstanceAttribBase = 3;
+
+// 每个立方体实例的数据 (紧密排列，与顶点着色器的实例属性对应)
+struct CubeInstance {
+    glm::mat4 model;
+    glm::vec3 normalMatrix[3]; // 法线矩阵 (模型矩阵左上 3x3 的逆转置) 的三列
+    glm::vec3 color;
+};
+static_assert(sizeof(CubeInstance) == 112, "CubeInstance must be tightly packed");
+
+// 立方体实例缓冲区
+// CPU 端保留全部实例的副本；set 只在数据变化时记录脏实例并重算法线矩阵，
+// flush 把脏实例排序后按连续区间用 glBufferSubData 上传，未变化的实例不上传
+// 隐藏的实例以全零矩阵表示 (三角形退化，由光栅化丢弃)，实例下标保持不变
+class CubeInstanceBuffer {
+public:
+    explicit CubeInstanceBuffer(size_t capacity = 64);
+    ~CubeInstanceBuffer();
+
+    CubeInstanceBuffer(const CubeInstanceBuffer&) = delete;
+    CubeInstanceBuffer& operator=(const CubeInstanceBuffer&) = delete;
+
+    // 设置实例数量 (超过容量时扩容，全部实例重新上传)
+    void resize(size_t count);
+    size_t size() const { return instances_.size(); }
+
+    // 更新实例数据，与当前内容相同时不做任何事
+    void set(size_t index, const glm::mat4& model, const glm::vec3& color);
+    // 整体复制实例数据 (用于从其他缓冲区挑选实例，法线矩阵不重算)，与当前内容相同时不做任何事
+    void set(size_t index, const CubeInstance& instance);
+    const CubeInstance& instance(size_t index) const { return instances_[index]; }
+    // 隐藏实例 (等同于设置全零矩阵)
+    void hide(size_t index);
+    // 上传脏实例，返回上传的字节数
+    size_t flush();
+
+    // 为当前绑定的 VAO 配置实例属性 (divisor 为 1)；扩容不更换缓冲区名字，配置保持有效
+    void setupAttributes() const;
+
+    // 本次 flush 的上传次数 (连续区间数) 与累计上传字节数
+    size_t lastUploads() const { return lastUploads_; }
+    uint64_t uploadedBytes() const { return uploadedBytes_; }
+
+private:
+    GLuint vbo_;
+    size_t capacity_;
+    std::vector<CubeInstance> instances_;
+    std::vector<uint32_t> dirty_;     // 脏实例下标 (无序，flush 时排序)
+    std::vector<uint8_t> dirtyFlags_; // 实例是否已在 dirty_ 中
+    size_t lastUploads_;
+    uint64_t uploadedBytes_;
+
+    void markDirty(size_t index);
+};
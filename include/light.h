@@ -1,6 +1,8 @@
 #pragma once
 #include "glm.hpp"
+#include <cstdint>
 #include <glad/glad.h>
+#include "cluster_culling.h"
 
 // 光源管理类
 // 负责管理场景中的点光源属性，以及生成全向阴影贴图 (Omnidirectional Shadow Map)
@@ -17,10 +19,13 @@ public:
     // nearPlane, farPlane: 阴影投影的近/远平面距离
     void setupShadowCube(int size, float nearPlane, float farPlane);
 
-    // 开始深度 Pass：绑定帧缓冲，准备渲染深度图
+    // 开始深度 Pass：绑定帧缓冲并设置视口，准备渲染深度图
     void beginDepthPass();
     // 结束深度 Pass：解绑帧缓冲
     void endDepthPass();
+    // 选择深度附件：face 为 0 - 5 时附加单个面 (逐面渲染)，-1 时附加整个立方体贴图 (分层渲染，由 gl_Layer 选择面)
+    // 附件与上次相同时不重新附加；须在 beginDepthPass 之后调用
+    void attachDepthFace(int face);
 
     // 获取深度立方体纹理 ID
     GLuint depthCubeTexture() const;
@@ -33,6 +38,26 @@ public:
     float farPlane() const;
     // 获取阴影贴图尺寸
     int shadowSize() const;
+    // 立方体贴图某个面的 projection * view (光源位置或裁剪平面变化时重算)
+    const glm::mat4& faceMatrix(int face) const { return faceMatrices_[face]; }
+    // 投射体会影响的面 (位 i 对应第 i 个面)
+    // 包围球到光源的最近距离超过远平面时不影响任何面，否则为与包围球相交的面视锥
+    uint8_t casterFaces(const glm::vec3& center, float radius) const;
+
+    // 阴影缓存
+    // 是否需要重新渲染只看脏面掩码：投射体变化时以其 (变化前后的) 包围球调用 markCasterChanged，只有与包围球相交的面失效
+    // 阴影状态版本由光源位置、远平面与投射体修订号组合而成，仅用于显示
+    uint64_t shadowVersion() const;
+    // 投射体修订号 (每次 markCasterChanged / invalidateShadow 递增)
+    uint64_t casterRevision() const { return casterRevision_; }
+    // 投射体在世界空间包围球内发生变化 (移动、出现、消失或几何改变)
+    void markCasterChanged(const glm::vec3& center, float radius);
+    // 全部面失效 (渲染设置或深度程序变化等无法归到具体投射体的情况)
+    void invalidateShadow();
+    // 需要重新渲染的面 (位 i 对应第 i 个面)
+    uint8_t dirtyFaces() const { return dirtyFaces_; }
+    // 记录本次渲染了哪些面 (从脏面中清除)
+    void markFacesRendered(uint8_t faces);
 
 private:
     glm::vec3 position_; // 光源位置
@@ -43,5 +68,13 @@ private:
     int shadowSize_;       // 纹理分辨率
     float nearPlane_;      // 近平面
     float farPlane_;       // 远平面
+    int attachedFace_;     // 当前的深度附件 (-1 为整个立方体贴图)
+    glm::mat4 faceMatrices_[6];  // 各面的 projection * view
+    Frustum faceFrusta_[6];      // 各面的视锥 (世界空间)
+    uint64_t casterRevision_;    // 投射体修订号
+    uint8_t dirtyFaces_;         // 需要重新渲染的面
+
+    // 重算各面矩阵与视锥
+    void updateFaceMatrices();
 };
 
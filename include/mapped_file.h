@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// 只读内存映射文件
+// 用于直接访问大文件 (模型缓存、源资源)，避免整文件读入堆内存
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // 移动构造与赋值：转移映射所有权
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    // 禁止拷贝，防止重复解除映射 (RAII)
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 映射指定文件，失败 (文件不存在或为空) 返回 false
+    bool open(const std::string& path);
+    // 解除映射并关闭文件
+    void close();
+
+    // 映射区域首地址
+    const unsigned char* data() const { return data_; }
+    // 映射区域字节数
+    size_t size() const { return size_; }
+    // 是否已成功映射
+    bool isOpen() const { return data_ != nullptr; }
+
+private:
+    const unsigned char* data_; // 映射首地址
+    size_t size_;               // 文件大小
+#ifdef _WIN32
+    void* file_;                // 文件句柄
+    void* mapping_;             // 映射对象句柄
+#else
+    int fd_;                    // 文件描述符
+#endif
+};
@@ -1,9 +1,13 @@
 #pragma once
+#include <algorithm>
 #include <vector>
 #include <glad/glad.h>
+#include <memory>
 #include <string>
 #include "glm.hpp"
 #include "shader.h"
+#include "vertex_format.h"
+#include "geometry_pool.h"
 
 // 顶点结构体，定义了每个顶点的属性
 struct Vertex {
@@ -12,25 +16,110 @@ struct Vertex {
     glm::vec2 TexCoords;  // 纹理坐标
 };
 
+// OpenGL 纹理对象 (RAII)
+// 由 TextureRegistry 在多个 Mesh 之间共享，最后一个引用释放时删除纹理
+struct GLTexture {
+    GLuint id = 0;         // OpenGL 纹理 ID
+    int width = 0;         // 驻留后的尺寸 (占位阶段为 0)
+    int height = 0;
+    bool resident = false; // 完整图像是否已上传
+
+    GLTexture() = default;
+    ~GLTexture();
+    GLTexture(const GLTexture&) = delete;
+    GLTexture& operator=(const GLTexture&) = delete;
+};
+
+// 采样参数，纹理对象创建时设置，也是纹理共享键的一部分
+struct SamplerDesc {
+    GLenum wrapS = GL_REPEAT;
+    GLenum wrapT = GL_REPEAT;
+    GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR; // 驻留后使用；占位阶段固定为 GL_LINEAR
+    GLenum magFilter = GL_LINEAR;
+
+    bool operator==(const SamplerDesc& o) const {
+        return wrapS == o.wrapS && wrapT == o.wrapT && minFilter == o.minFilter && magFilter == o.magFilter;
+    }
+};
+
 // 纹理结构体
 struct Texture {
     unsigned int id;      // OpenGL 纹理 ID
     std::string type;     // 纹理类型 (如 texture_diffuse, texture_specular)
+    std::shared_ptr<GLTexture> handle; // 共享的纹理对象，持有期间 id 有效
+};
+
+// 已解码的图像数据 (CPU 端, RGBA8)
+struct ImageData {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels; // width * height * 4 字节
+};
+
+// 网格细节层级 (LOD)
+// 所有级别共享同一顶点数组，索引依次存放在同一索引数组中
+struct MeshLod {
+    uint32_t indexOffset = 0; // 在索引数组中的起始位置
+    uint32_t indexCount = 0;
+    float error = 0.0f;       // 相对原始网格的几何误差 (模型空间距离)
+    uint32_t reserved = 0;
 };
 
+// 网格簇 (Meshlet)
+// 原始级别的索引被顺序切分为若干小簇，每簇带包围球与法线锥，用于逐簇的视锥与背面剔除
+struct Meshlet {
+    uint32_t indexOffset = 0;     // 在索引数组中的起始位置
+    uint32_t triangleCount = 0;
+    glm::vec3 center = glm::vec3(0.0f); // 包围球 (模型空间)
+    float radius = 0.0f;
+    glm::vec3 coneAxis = glm::vec3(0.0f, 0.0f, 1.0f); // 法线锥轴
+    float coneCutoff = 1.0f;      // 锥半角的正弦，1 表示法线过于分散不参与背面剔除
+};
+
+// 每个网格最多的 LOD 级别数 (含原始级别)
+const int kMaxLodLevels = 4;
+
+// LOD 选择所属的渲染 Pass
+enum class LodPass {
+    Main,   // 相机主 Pass
+    Shadow, // 点光源阴影 Pass (6 个面共用一次选择)
+};
+const int kLodPassCount = 2;
+
+// CPU 端网格数据
+// Assimp 转换结果，在创建 OpenGL 资源前可被缓存或进一步处理
+struct MeshData {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices; // LOD0 索引在前，其后依次为各简化级别
+    std::vector<MeshLod> lods;         // 为空表示只有原始级别
+    std::vector<Meshlet> meshlets;     // 原始级别的簇划分 (为空表示不做逐簇剔除)
+    int image = -1; // 引用的图像索引 (-1 表示无纹理)
+};
+
+// 矩阵左上 3x3 的最大轴缩放 (包围球半径变换到世界空间的保守系数)
+inline float maxAxisScale(const glm::mat4& m) {
+    return std::max(glm::length(glm::vec3(m[0])), std::max(glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2]))));
+}
+
 // 网格类
 // 代表模型中的一个独立网格部分，包含顶点数据、索引数据和材质纹理
 class Mesh {
     public:
         /*  网格数据  */
         std::vector<Vertex> vertices;
-        std::vector<unsigned int> indices;
+        std::vector<unsigned int> indices; // 含所有 LOD 级别
         std::vector<Texture> textures;
+        std::vector<MeshLod> lods;         // LOD 表 (至少包含原始级别)
+        std::vector<Meshlet> meshlets;     // 原始级别的簇划分
 
         /*  函数  */
         // 构造函数：初始化网格数据
-        Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures);
-        // 析构函数：释放 OpenGL 资源 (VAO, VBO, EBO)
+        // format: GPU 端顶点格式，Packed 时上传量化顶点，顶点数少于 65536 时使用 16 位索引
+        // pool: 共享几何池 (格式须一致)；为空或网格放不进池时使用独立的 VAO/VBO/EBO
+        Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures,
+             VertexFormat format = VertexFormat::Float32, GeometryPool *pool = nullptr,
+             std::vector<MeshLod> lods = {}, std::vector<Meshlet> meshlets = {});
+        // 析构函数：释放 OpenGL 资源 (VAO, VBO, EBO) 或归还几何池空间
         ~Mesh();
         
         // 移动构造函数：支持资源所有权转移
@@ -42,13 +131,59 @@ class Mesh {
         Mesh(const Mesh&) = delete;
         Mesh& operator=(const Mesh&) = delete;
 
-        // 绘制网格
-        void Draw(Shader &shader);
+        // 绘制网格 (绑定并在结束后解绑 VAO)，使用 pass 当前选中的 LOD
+        void Draw(Shader &shader, LodPass pass = LodPass::Main);
+        // 绑定网格所在的 VAO (几何池网格绑定池的 VAO)
+        void bindGeometry() const;
+        // 在已绑定 VAO 的前提下绘制，连续绘制同一几何池的网格时无需切换 VAO
+        void DrawBound(Shader &shader, LodPass pass = LodPass::Main);
+        // 在已绑定几何池流式 VAO 的前提下绘制索引流中的一段 (逐簇剔除后的压缩索引)
+        void DrawStream(Shader &shader, uint32_t firstIndex, uint32_t indexCount);
+        // 是否带漫反射纹理 (决定使用的着色器变体)
+        bool hasTexture() const { return !textures.empty(); }
+        // 材质编号 (第一张纹理的 GL 名字，无纹理时为 0)，用作渲染队列的排序键
+        unsigned int materialId() const { return textures.empty() ? 0u : textures[0].id; }
+        // 所在的几何池 (未使用几何池时为空)
+        GeometryPool* geometryPool() const { return pool; }
+        // 绘制时绑定的 VAO (几何池网格为池的 VAO)
+        GLuint vertexArray() const;
+
+        // GPU 顶点/索引缓冲区占用字节数
+        size_t vertexBytes() const { return vboBytes; }
+        size_t indexBytes() const { return eboBytes; }
+
+        // LOD 选择 (由 Model 按距离设置，level 超出范围时截断)
+        void setLod(LodPass pass, int level);
+        int lod(LodPass pass) const { return lodLevel[static_cast<int>(pass)]; }
+        int lodCount() const { return static_cast<int>(lods.size()); }
+        // 模型空间包围球 (球心为包围盒中心)
+        const glm::vec3& boundsCenter() const { return center; }
+        float boundsRadius() const { return radius; }
+        // 模型空间包围盒的半边长 (中心同 boundsCenter)
+        const glm::vec3& boundsExtent() const { return extent; }
+        // 世界空间包围球：球心按模型矩阵变换，半径乘以最大轴缩放 (剔除、LOD 选择与阴影投射体分类共用)
+        void worldSphere(const glm::mat4& modelMatrix, glm::vec3& outCenter, float& outRadius) const {
+            outCenter = glm::vec3(modelMatrix * glm::vec4(center, 1.0f));
+            outRadius = radius * maxAxisScale(modelMatrix);
+        }
     private:
         /*  渲染数据  */
-        unsigned int VAO, VBO, EBO; // OpenGL 对象 ID
+        unsigned int VAO, VBO, EBO; // OpenGL 对象 ID (使用几何池时为 0)
+        GeometryPool *pool;         // 共享几何池
+        GeometryAllocation alloc;   // 在几何池中的分配
+        VertexFormat format;        // GPU 端顶点格式
+        GLenum indexType;           // GL_UNSIGNED_INT 或 GL_UNSIGNED_SHORT
+        PositionQuantization quant; // 位置反量化参数 (Packed 格式)
+        size_t vboBytes = 0;
+        size_t eboBytes = 0;
+        int lodLevel[kLodPassCount] = { 0, 0 }; // 各 Pass 当前 LOD 级别
+        glm::vec3 center = glm::vec3(0.0f);
+        float radius = 0.0f;
+        glm::vec3 extent = glm::vec3(0.0f);
         /*  函数  */
         // 配置网格的 OpenGL 缓冲区和属性指针
         void setupMesh();
+        // 设置纹理与顶点解码相关的 uniform
+        void applyMaterial(Shader &shader);
 };  
 
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+#include "mesh.h"
+
+// 缓存中单个网格的只读视图 (直接指向映射内存)
+struct MeshCacheEntry {
+    const Vertex* vertices = nullptr;
+    uint32_t vertexCount = 0;
+    const unsigned int* indices = nullptr;
+    uint32_t indexCount = 0;          // 含所有 LOD 级别的索引总数
+    const MeshLod* lods = nullptr;    // LOD 表 (lodCount 为 0 时为空)
+    uint32_t lodCount = 0;
+    const Meshlet* meshlets = nullptr; // 簇表 (meshletCount 为 0 时为空)
+    uint32_t meshletCount = 0;
+    int image = -1; // 引用的图像索引 (-1 表示无纹理)
+};
+
+// 缓存中单张图像的只读视图 (RGBA8)
+struct ImageCacheEntry {
+    int width = 0;
+    int height = 0;
+    const unsigned char* pixels = nullptr;
+    std::string source;   // 纹理来源 ("*N" 表示内嵌纹理，否则为相对模型目录的路径)
+    SamplerDesc sampler;  // 采样参数 (与 source 一起构成纹理共享键)
+};
+
+// 写入缓存的单张图像
+struct ImageCacheInput {
+    const ImageData* image = nullptr;
+    std::string source;
+    SamplerDesc sampler;
+};
+
+// 二进制网格缓存
+// 保存转换完成的顶点/索引流与解码后的纹理，文件位于源资源旁 (<源文件>.meshcache)
+// 通过格式版本、导入标志和源文件内容哈希判断是否失效
+// 加载时整体内存映射，数据可直接交给 glBufferData / glTexImage2D
+class MeshCache {
+public:
+    // 缓存格式版本，布局或导入后处理 (如网格优化) 变化时递增
+    static const uint32_t kVersion = 5;
+
+    // 根据源资源路径生成缓存文件路径
+    static std::string pathFor(const std::string& sourcePath);
+    // 计算文件内容哈希，文件不可读时返回 false
+    static bool hashFile(const std::string& path, uint64_t& outHash);
+    // 写入缓存 (先写临时文件再替换，避免半写入的缓存被读到)
+    static bool write(const std::string& cachePath, uint64_t sourceHash, uint32_t importFlags,
+                      const std::vector<MeshData>& meshes, const std::vector<ImageCacheInput>& images);
+
+    MeshCache();
+
+    // 打开并校验缓存，版本/标志/哈希任一不匹配即视为失效
+    bool open(const std::string& cachePath, uint64_t sourceHash, uint32_t importFlags);
+
+    size_t meshCount() const { return meshes_.size(); }
+    size_t imageCount() const { return images_.size(); }
+    const MeshCacheEntry& mesh(size_t i) const { return meshes_[i]; }
+    const ImageCacheEntry& image(size_t i) const { return images_[i]; }
+
+private:
+    MappedFile file_;                    // 缓存文件映射
+    std::vector<MeshCacheEntry> meshes_; // 网格视图
+    std::vector<ImageCacheEntry> images_; // 图像视图
+};
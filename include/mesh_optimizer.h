@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "mesh.h"
+
+// 网格优化统计 (计数形式，可在多个网格之间累加)
+// ACMR = 缓存未命中数 / 三角形数 (越低越好，理想值约 0.5)
+// ATVR = 缓存未命中数 / 顶点数   (越低越好，理想值 1.0)
+struct MeshOptimizeStats {
+    size_t triangles = 0;
+    size_t verticesBefore = 0;  // 焊接前顶点数
+    size_t verticesAfter = 0;   // 焊接并剔除未引用顶点后的顶点数
+    size_t missesBefore = 0;    // 优化前模拟缓存未命中数
+    size_t missesAfter = 0;     // 优化后模拟缓存未命中数
+
+    float acmrBefore() const { return triangles ? float(missesBefore) / float(triangles) : 0.0f; }
+    float acmrAfter() const { return triangles ? float(missesAfter) / float(triangles) : 0.0f; }
+    float atvrBefore() const { return verticesBefore ? float(missesBefore) / float(verticesBefore) : 0.0f; }
+    float atvrAfter() const { return verticesAfter ? float(missesAfter) / float(verticesAfter) : 0.0f; }
+
+    MeshOptimizeStats& operator+=(const MeshOptimizeStats& o) {
+        triangles += o.triangles;
+        verticesBefore += o.verticesBefore;
+        verticesAfter += o.verticesAfter;
+        missesBefore += o.missesBefore;
+        missesAfter += o.missesAfter;
+        return *this;
+    }
+};
+
+// 模拟 FIFO 顶点后变换缓存，返回未命中次数
+size_t mesh_simulate_vertex_cache(const std::vector<unsigned int>& indices, size_t vertexCount, int cacheSize = 16);
+
+// 焊接完全相同的顶点 (逐字节比较)，返回焊接后的顶点数
+size_t mesh_weld_vertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+// 按后变换缓存复用重排三角形 (Forsyth 线性时间算法)
+void mesh_optimize_vertex_cache(std::vector<unsigned int>& indices, size_t vertexCount);
+
+// 在保持缓存效率的前提下按簇重排三角形以降低过度绘制 (须在 mesh_optimize_vertex_cache 之后调用)
+// threshold: 允许的 ACMR 劣化比例，簇越小过度绘制越低但缓存效率越差
+void mesh_optimize_overdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, float threshold = 1.05f);
+
+// 按索引首次引用顺序重排顶点以提高取数局部性，未引用的顶点被剔除
+void mesh_optimize_vertex_fetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+// 完整优化流程：焊接 -> 缓存重排 -> 过度绘制重排 -> 取数重排
+// 只处理三角形列表；可在任意线程调用
+void mesh_optimize(MeshData& mesh, MeshOptimizeStats* stats = nullptr);
+
+// 将原始级别的三角形划分为网格簇并按簇重排索引 (须在缓存重排之后、生成 LOD 之前调用)
+// 每簇从种子三角形沿相邻三角形贪心生长，簇内顺序仍保持良好的缓存局部性
+// maxVertices / maxTriangles: 每簇的顶点与三角形上限
+void mesh_build_meshlets(MeshData& mesh, size_t maxVertices = 64, size_t maxTriangles = 124);
+
+// 二次误差度量 (QEM) 网格简化
+// 半边折叠：顶点折叠到相邻的已有顶点，输出索引仍引用原顶点数组；
+// 开放边界与位置被多个顶点共享 (UV/法线接缝) 的顶点保持不动
+// targetIndexCount: 目标索引数；targetError: 允许的最大误差 (模型空间距离)
+// outError: 实际产生的最大误差
+std::vector<unsigned int> mesh_simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                                        size_t targetIndexCount, float targetError, float* outError = nullptr);
+
+// 生成 LOD 链：每级目标为上一级一半的三角形，误差上限为包围盒对角线的 errorLimit 倍
+// 简化结果追加到 mesh.indices 末尾并写入 mesh.lods (lods[0] 为原始网格)；简化不再有效时提前停止
+void mesh_generate_lods(MeshData& mesh, int maxLevels = 4, float errorLimit = 0.05f);
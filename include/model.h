@@ -1,10 +1,94 @@
+#pragma once
 #include "mesh.h"
+#include "cluster_culling.h"
+#include "frustum_cull.h"
+#include "occlusion.h"
+#include "mesh_optimizer.h"
 #include "shader.h"
 #include <iostream>
+#include <memory>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+class MeshCache;
+class ThreadPool;
+class TextureRegistry;
+class RenderQueue;
+struct RenderView;
+class Light;
+
+// 模型引用的单张纹理 (模型内已按来源 + 采样参数去重)
+struct ModelImage {
+    std::string source;                  // "*N" 表示内嵌纹理，否则为相对模型目录的文件路径
+    SamplerDesc sampler;                 // 材质指定的环绕模式
+    std::vector<unsigned char> encoded;  // 压缩纹理数据 (png/jpg)，由 TextureStreamer 在后台解码
+};
+
+// CPU 阶段的模型转换结果 (不含任何 OpenGL 资源)
+struct ModelData {
+    std::vector<MeshData> meshes;    // 按节点遍历顺序排列的网格
+    std::vector<ModelImage> images;  // 去重后的纹理，MeshData::image 为其索引
+    std::vector<MeshOptimizeStats> optimize; // 各网格的优化统计 (与 meshes 一一对应)
+};
+
+// 模型加载选项
+struct ModelOptions {
+    VertexFormat vertexFormat = VertexFormat::Float32; // GPU 端顶点格式 (Packed 为量化压缩格式)
+    GeometryPool *geometryPool = nullptr;              // 共享几何池 (格式须与 vertexFormat 一致)，为空时每个网格独立分配
+    bool async = false;        // 异步加载：构造函数立即返回，网格转换完成后由 update() 逐个发布
+    bool hasFocus = false;     // 是否提供优先级参考点
+    glm::vec3 focus = glm::vec3(0.0f); // 异步加载的优先级参考点 (模型空间，通常为初始相机位置)；未提供时按网格尺寸排序
+};
+
+// 模型加载统计
+struct ModelLoadStats {
+    bool fromCache = false;   // 是否命中二进制网格缓存
+    double loadMs = 0.0;      // 加载耗时 (毫秒，不含后台纹理解码与上传；异步加载时为全部网格发布的时间)
+    double firstMeshMs = 0.0; // 从开始加载到第一个网格可绘制的耗时 (同步加载时与 loadMs 相同)
+    double allMeshesMs = 0.0; // 从开始加载到全部网格可绘制的耗时
+    size_t meshCount = 0;     // 网格数量
+    size_t vertexCount = 0;   // 顶点总数
+    size_t indexCount = 0;    // 索引总数
+    size_t textureRefs = 0;   // 引用纹理的网格数 (去重前每个网格都会创建一张纹理)
+    size_t uniqueTextures = 0;// 模型内去重后的纹理数
+    size_t registryHits = 0;  // 已由其他模型加载、直接复用的纹理数
+    MeshOptimizeStats optimize; // 导入时网格优化的汇总统计 (命中缓存时为空)
+    size_t vertexBytes = 0;   // GPU 顶点缓冲区总字节数
+    size_t indexBytes = 0;    // GPU 索引缓冲区总字节数
+    size_t meshletCount = 0;  // 原始级别的簇总数
+    size_t lodTriangles[kMaxLodLevels] = {}; // 各 LOD 级别的三角形总数 (网格缺少该级别时不计入)
+};
+
+// LOD 选择参数
+// 选择屏幕空间误差不超过 errorPixels * bias 的最粗级别
+struct LodSettings {
+    bool enabled = true;
+    float errorPixels = 1.0f;  // 允许的投影误差 (像素)
+    float mainBias = 1.0f;     // 主 Pass 误差倍数
+    float shadowBias = 4.0f;   // 阴影 Pass 误差倍数 (阴影经过 PCF 模糊，可使用更粗的级别)
+    float hysteresis = 0.2f;   // 滞回比例：变粗需低于阈值 (1-h)，变细需超过阈值 (1+h)，防止在阈值附近来回切换
+};
+
+// 单个 Pass 的 LOD 选择结果
+struct LodPassStats {
+    size_t meshesPerLevel[kMaxLodLevels] = {}; // 各级别被选中的网格数
+    size_t triangles = 0;                      // 选中级别的三角形数 (单次绘制)
+    size_t fullTriangles = 0;                  // 全部使用原始级别时的三角形数
+    size_t changed = 0;                        // 级别与上次不同的网格数
+};
+
+// 网格 Pass 掩码中主 Pass 的位 (位 0 - 5 为阴影立方体贴图的面)
+const uint8_t kMainPassMask = 1u << 6;
+// 遮挡体代理允许的 LOD 误差 (相对网格包围球半径)
+const float kOccluderMaxError = 0.02f;
+
+// 纹理共享统计
+struct TextureShareStats {
+    size_t decodesSaved = 0;  // 节省的解码与上传次数
+    uint64_t bytesSaved = 0;  // 节省的显存字节数 (RGBA8 + mipmap，尚未驻留的纹理不计入)
+};
+
 // 模型加载类
 // 使用 Assimp 库加载 3D 模型文件，并将其转换为 Mesh 对象集合
 class Model 
@@ -12,27 +96,157 @@ class Model
     public:
         /*  函数   */
         // 构造函数：加载指定路径的模型
-        Model(const char *path)
+        // textures: 纹理注册表，相同来源的纹理在模型与网格间共享，返回后异步解码上传
+        // options: 加载选项 (顶点格式、异步加载等)
+        Model(const char *path, TextureRegistry &textures, const ModelOptions &options = ModelOptions())
+            : options(options)
         {
-            loadModel(path);
+            if (options.async) startAsyncLoad(path, textures);
+            else loadModel(path, textures);
         }
 
-        // 绘制模型：遍历所有 Mesh 并绘制
-        void Draw(Shader &shader);   
+        // 异步加载时每帧在 GL 线程调用：从完成队列取出已转换的网格并创建 GL 资源
+        // maxMeshes: 本次最多发布的网格数 (限制单帧的缓冲区上传量)
+        // 返回本次发布的网格数；同步加载或加载完成后为空操作
+        size_t update(size_t maxMeshes = 8);
+        // 是否仍有网格未发布 (加载失败时返回 false)
+        bool loading() const;
+        // 已可绘制的网格数
+        size_t meshCount() const { return meshes.size(); }
+        // 网格总数 (异步加载时在导入完成前为 0)
+        size_t expectedMeshCount() const;
+        // 已发布网格的世界空间包围球 (包住各网格的包围球)，没有网格时返回 false
+        bool worldBounds(const glm::mat4 &modelMatrix, glm::vec3 &center, float &radius) const;
+
+        // 绘制模型：遍历所有 Mesh 并绘制，同一几何池中的连续网格只绑定一次 VAO
+        // pass: 使用该 Pass 最近一次 selectLods 选出的级别
+        void Draw(Shader &shader, LodPass pass = LodPass::Main);   
+        // 按材质选择着色器变体绘制：有纹理的网格使用 textured，其余使用 untextured，程序变化时重新激活
+        void Draw(Shader &textured, Shader &untextured, LodPass pass);
+
+        // 按投影尺寸为每个网格选择 LOD
+        // modelMatrix: 模型矩阵；eye: 相机 (或光源) 位置
+        // projScale: 距离为 1 时单位长度对应的像素数 (视口高度 / (2 * tan(fov / 2)))
+        LodPassStats selectLods(const glm::mat4 &modelMatrix, const glm::vec3 &eye, float projScale,
+                                const LodSettings &settings, LodPass pass);
+
+        // 逐簇剔除
+        // 处于原始级别且位于几何池中的网格逐簇做视锥与背面剔除，存活簇的索引压缩后追加到本帧的索引流；
+        // 其他网格只做整体包围球剔除。结果供随后的 submit / DrawClusters 使用
+        // 一帧内可对多个 Pass 依次剔除：帧开始时 resetClusterStream，全部剔除后 uploadClusterStream 一次上传
+        // viewProj: 该 Pass 的 projection * view (阴影 Pass 为单个立方体面的矩阵)；eye: 视点 (世界空间)
+        // backface: 是否剔除背面簇 (主着色器的描边依赖背面三角形，开启描边时不应剔除)
+        ClusterCullStats cullClusters(const glm::mat4 &modelMatrix, const glm::mat4 &viewProj, const glm::vec3 &eye,
+                                      bool backface, LodPass pass);
+        // 清空本帧的索引流
+        void resetClusterStream();
+        // 上传本帧的索引流 (绘制流式网格前调用)
+        void uploadClusterStream();
+        // 按最近一次 cullClusters 的结果绘制 (pass 用于未逐簇剔除网格的 LOD 级别，索引流须已上传)
+        void DrawClusters(Shader &shader, LodPass pass);
+        // 同上，按材质选择着色器变体
+        void DrawClusters(Shader &textured, Shader &untextured, LodPass pass);
+
+        // 把网格提交到渲染队列 (有纹理的网格使用 textured，其余使用 untextured)
+        // clusters: 使用最近一次 cullClusters 的结果 (须紧接该 Pass 的剔除之后调用)，否则按 LOD 完整提交全部网格
+        // passMask: 非 0 时只提交 Pass 掩码与之相交的网格 (阴影面的位由 classifyCasters 写入，主 Pass 的位由 cullMeshes 写入)
+        // 返回提交的绘制包数
+        size_t submit(RenderQueue &queue, const RenderView &view, Shader &textured, Shader &untextured,
+                      uint32_t objectSlot, const glm::mat4 &modelMatrix, bool clusters, uint8_t passMask = 0);
+        // 按世界空间包围球计算每个网格会投射阴影的立方体贴图面 (光源的面视锥与远平面范围)
+        void classifyCasters(const Light &light, const glm::mat4 &modelMatrix);
+        // 主 Pass 视锥剔除：各网格的包围盒 (导入时计算) 按模型矩阵变换后与相机视锥做 SoA 批量测试，结果写入 kMainPassMask 位
+        // frustum 为空时只变换包围盒，全部网格视为可见 (关闭视锥剔除但仍做遮挡剔除时使用)
+        FrustumCullStats cullMeshes(const glm::mat4 &modelMatrix, const Frustum *frustum);
+        // 遮挡体代理：按包围球从大到小选择网格，每个网格取误差不超过半径 kOccluderMaxError 倍的最粗 LOD，三角形总数不超过 triangleBudget
+        void buildOccluders(size_t triangleBudget, std::vector<OccluderMesh> &out) const;
+        // 主 Pass 遮挡剔除：以最近一次 cullMeshes 的世界空间包围盒测试其判为可见的网格，被遮挡的清除 kMainPassMask 位，返回被遮挡数
+        size_t cullOccluded(const OcclusionBuffer &buffer);
+
+        // 获取最近一次加载的统计信息
+        const ModelLoadStats& loadStats() const { return stats; }
+        // 相对 "每个网格各自加载纹理" 节省的解码次数与显存
+        TextureShareStats textureShareStats() const;
+
+        // CPU 转换阶段：在线程池上并行提取顶点/索引并做网格优化，按来源去重后读取压缩纹理数据
+        // directory: 模型所在目录，用于解析外部纹理文件
+        // 只访问 scene 与 out，可在任意线程调用
+        static void convertScene(const aiScene *scene, const std::string &directory, ThreadPool &pool, ModelData &out);
     private:
+        // 模型持有的纹理及其替代的重复副本数
+        struct TextureUse {
+            std::shared_ptr<GLTexture> texture;
+            size_t savedCopies;
+        };
+        struct CacheWriteJob;
+        struct AsyncLoad;
+        // 单个网格的剔除结果
+        struct ClusterDraw {
+            enum Mode { Culled, Full, Stream } mode = Full; // 整体剔除 / 按 LOD 完整绘制 / 绘制索引流中的一段
+            uint32_t firstIndex = 0;
+            uint32_t indexCount = 0;
+        };
+
         /*  模型数据  */
-        std::vector<Mesh> meshes; // 模型包含的网格列表
+        std::vector<Mesh> meshes;             // 模型包含的网格列表
+        std::vector<TextureUse> textureUses;  // 去重后的纹理
+        ModelOptions options;                 // 加载选项
+        ModelLoadStats stats;                 // 加载统计
+        std::vector<ClusterDraw> clusterDraws; // 最近一次逐簇剔除的结果 (与 meshes 一一对应)
+        std::vector<uint8_t> passMasks;       // 各网格可见的 Pass (与 meshes 一一对应，见 kMainPassMask)
+        AabbSoA localBounds;                  // 各网格的模型空间包围盒 (网格发布后补齐)
+        AabbSoA frameBounds;                  // 本帧变换到世界空间的包围盒
+        std::vector<uint8_t> meshVisible;     // 本帧视锥测试结果
+        std::vector<uint32_t> streamIndices;  // 压缩后的索引流 (CPU 暂存)
+        std::vector<uint16_t> streamShort;    // 16 位索引池使用的转换暂存
+        GeometryPool *streamPool = nullptr;   // 索引流所在的几何池
+        std::shared_ptr<AsyncLoad> async;     // 异步加载状态 (与后台任务共享)
 
         /*  函数   */
         // 加载模型文件的主入口
-        void loadModel(const std::string &path);
+        void loadModel(const std::string &path, TextureRegistry &textures);
         
-        // 递归处理 Assimp 节点树
-        void processNode(aiNode *node, const aiScene *scene);
+        // 提交后台加载任务
+        void startAsyncLoad(const std::string &path, TextureRegistry &textures);
+        // 后台加载：读取缓存或导入并转换，按优先级把纹理与网格推入完成队列
+        static void loadAsync(const std::shared_ptr<AsyncLoad> &load, const std::string &path, bool hasFocus, const glm::vec3 &focus);
+
+        // 从二进制缓存创建网格 (跳过 Assimp)，cache 在纹理上传完成前保持映射
+        void loadFromCache(const std::shared_ptr<MeshCache> &cache, const std::string &path, TextureRegistry &textures);
+
+        // GL 阶段：按顺序创建 VAO/VBO/EBO，并从注册表获取或提交纹理
+        // 提供 cachePath 时，在所有纹理解码完成后于后台写入网格缓存
+        void createMeshes(ModelData &data, const std::string &path, TextureRegistry &textures,
+                          const std::string &cachePath, uint64_t sourceHash);
+
+        // 创建缓存写入任务 (cachePath 为空时返回空)
+        static std::shared_ptr<CacheWriteJob> makeCacheJob(const std::string &cachePath, uint64_t sourceHash, size_t imageCount);
+        // 从注册表获取或提交纹理，返回按模型内编号排列的句柄；提供 job 时解码结果回填缓存写入任务
+        std::vector<std::shared_ptr<GLTexture>> createTextures(std::vector<ModelImage> &images, const std::vector<size_t> &refs,
+                                                               const std::string &path, TextureRegistry &textures,
+                                                               const std::shared_ptr<CacheWriteJob> &job);
+        // 从注册表获取或提交缓存中的纹理
+        std::vector<std::shared_ptr<GLTexture>> createCacheTextures(const std::shared_ptr<MeshCache> &cache,
+                                                                    const std::string &path, TextureRegistry &textures);
+        // 创建单个网格的 GL 资源并累计统计
+        void addMesh(MeshData &&md, const std::vector<std::shared_ptr<GLTexture>> &handles, CacheWriteJob *job);
+
+        // 转换并优化单个网格 (可在任意线程调用)
+        static MeshData convertMesh(const aiMesh *mesh, MeshOptimizeStats *optimize);
+        // 解析各网格的纹理来源并去重读取；meshImage 为各网格引用的纹理编号 (-1 表示无纹理)
+        static void collectTextures(const aiScene *scene, const std::string &directory, ThreadPool &pool,
+                                    const std::vector<const aiMesh*> &order, std::vector<int> &meshImage,
+                                    std::vector<ModelImage> &images);
+
+        // 递归收集 Assimp 节点树引用的网格 (保持遍历顺序)
+        static void processNode(const aiNode *node, const aiScene *scene, std::vector<const aiMesh*> &order);
         
-        // 将 Assimp 的 mesh 数据转换为自定义 Mesh 类
-        Mesh processMesh(aiMesh *mesh, const aiScene *scene);
+        // 将 Assimp 的 mesh 几何数据转换为 CPU 端网格数据 (纹理由 collectTextures 解析)
+        static MeshData processMesh(const aiMesh *mesh);
         
-        // 加载材质纹理
-        std::vector<Texture> loadMaterialTextures(aiMaterial *mat, const aiScene* scene);
+        // 解析材质的纹理来源与采样参数，成功时返回 true
+        static bool loadMaterialTexture(const aiMaterial *mat, const aiScene* scene, ModelImage &out);
+
+        // 读取纹理的压缩数据 (内嵌纹理直接拷贝，外部文件从模型目录读取)
+        static bool readImage(const aiScene *scene, const std::string &directory, ModelImage &image);
 };
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "glm.hpp"
+#include "frustum_cull.h"
+
+class ThreadPool;
+
+// 遮挡体代理网格 (模型空间，只含位置与三角形索引)
+struct OccluderMesh {
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    size_t triangleCount() const { return indices.size() / 3; }
+};
+
+// 遮挡缓冲区光栅化统计
+struct OcclusionRasterStats {
+    size_t occluders = 0;   // 提交的遮挡体数
+    size_t triangles = 0;   // 提交的三角形数
+    size_t rasterized = 0;  // 实际光栅化的三角形数 (不含被裁剪与不覆盖任何像素中心的，近平面裁剪后可能拆分为两个)
+};
+
+// CPU 软件光栅化的遮挡缓冲区
+// - 遮挡体的三角形按当前视图投影矩阵变换、与近平面裁剪后，以边函数一次光栅化 4 个像素 (SSE)，每个像素保留最近的深度
+// - 深度为 NDC 深度映射到 [0, 1]，清空值 1 表示没有遮挡；按像素中心采样 (与 GPU 光栅化规则相近，不做保守覆盖)
+// - 缓冲区按 kTileSize 行划分为行带，光栅化时行带在线程池上并行，同时求出每个 kTileSize² 块的最大深度
+// - 被遮挡体以世界空间包围盒测试：8 个角点投影后的屏幕矩形内每个像素都比包围盒最近深度更近时才判为遮挡，
+//   屏幕矩形向外扩展 1 个像素 (抵消像素中心采样在轮廓处多覆盖的部分)；先比较块的最大深度，只有不能整块判定时才逐像素比较
+class OcclusionBuffer {
+public:
+    static constexpr int kTileSize = 8;
+
+    // width/height 向上补齐到 kTileSize 的倍数
+    explicit OcclusionBuffer(int width = 256, int height = 128);
+
+    void resize(int width, int height);
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+    // 开始新的一帧：清空遮挡体列表并设置视图投影矩阵 (遮挡体与被遮挡体都使用它)
+    void begin(const glm::mat4& viewProj);
+    // 添加遮挡体 (只记录指针，mesh 须保持有效到 rasterize 返回)
+    void addOccluder(const OccluderMesh& mesh, const glm::mat4& modelMatrix);
+    // 变换并光栅化全部遮挡体 (三角形设置按遮挡体并行，光栅化按行带并行)
+    void rasterize(ThreadPool* pool = nullptr);
+
+    // 世界空间包围盒是否被完全遮挡 (跨越近平面或投影到屏幕外时保守地返回 false)，可在多个线程上同时调用
+    bool occluded(const glm::vec3& center, const glm::vec3& extent) const;
+    // 批量测试：只测试 visible[i] 非 0 的包围盒，被遮挡的清零，返回被遮挡数；数量较多且提供 pool 时分块并行
+    size_t cullBoxes(const AabbSoA& boxes, std::vector<uint8_t>& visible, ThreadPool* pool = nullptr) const;
+
+    const OcclusionRasterStats& stats() const { return stats_; }
+    // 逐像素深度 (行优先，第 0 行为屏幕底部)
+    const std::vector<float>& depth() const { return depth_; }
+    // 调试图像：RGBA8，有遮挡的像素按深度范围归一化为灰度 (越近越亮)，无遮挡的像素为黑色
+    void debugImage(std::vector<uint8_t>& rgba) const;
+
+private:
+    // 屏幕空间三角形 (逆时针，像素坐标)：边函数 e = a * x + b * y + c，深度平面 z = zx * x + zy * y + z0
+    struct ScreenTri {
+        float a[3], b[3], c[3];
+        float zx, zy, z0;
+        int minX, maxX, minY, maxY;
+    };
+    struct Occluder {
+        const OccluderMesh* mesh;
+        glm::mat4 modelMatrix;
+    };
+
+    int width_ = 0, height_ = 0;
+    int tilesX_ = 0, tilesY_ = 0;
+    glm::mat4 viewProj_{1.0f};
+    std::vector<float> depth_;
+    std::vector<float> tileMax_;                // 每块的最大深度
+    std::vector<Occluder> occluders_;
+    std::vector<std::vector<ScreenTri>> tris_;  // 各遮挡体设置后的三角形 (与 occluders_ 一一对应，跨帧复用)
+    OcclusionRasterStats stats_;
+
+    void setupOccluder(size_t index);
+    // 把一个已做近平面裁剪的三角形 (裁剪空间) 投影到屏幕并加入 out
+    void emitTriangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2, std::vector<ScreenTri>& out) const;
+    // 光栅化行带 [tileRow * kTileSize, (tileRow + 1) * kTileSize) 并求块的最大深度
+    void rasterizeBand(int tileRow);
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <glad/glad.h>
+
+// 程序二进制缓存统计
+struct ProgramCacheStats {
+    size_t hits = 0;      // 由二进制直接加载的程序数
+    size_t misses = 0;    // 缓存缺失、从源码编译的程序数
+    size_t rejected = 0;  // 驱动拒绝的二进制数 (驱动升级等)，已回退到源码编译
+    size_t stored = 0;    // 写入缓存的程序数
+};
+
+// 链接后程序的二进制缓存 (glGetProgramBinary / glProgramBinary)
+// 每个程序一个文件 (<目录>/<键>.progbin)，键由着色器源码、宏定义与驱动 (厂商/渲染器/版本) 共同决定，
+// 源码或驱动变化后自动使用新文件；驱动拒绝二进制时删除该文件并回退到源码编译
+// 所有函数须在 GL 线程调用
+class ProgramBinaryCache {
+public:
+    // 缓存格式版本，文件头布局变化时递增
+    static const uint32_t kVersion = 1;
+
+    // directory: 缓存文件所在目录 (须已存在)
+    // 构造时查询驱动信息；驱动不支持程序二进制 (无二进制格式或函数未加载) 时缓存不生效
+    explicit ProgramBinaryCache(std::string directory);
+
+    // 驱动是否支持程序二进制
+    bool supported() const { return supported_; }
+
+    // 尝试从缓存创建程序，成功时返回已链接的程序，否则返回 0
+    // defines: 注入源码的宏定义或几何着色器源码 (参与缓存键)
+    GLuint load(const std::string& vert, const std::string& frag, const std::string& defines = std::string());
+    // 在 glLinkProgram 之前调用，提示驱动保留可读取的二进制
+    void prepare(GLuint program) const;
+    // 保存已链接程序的二进制 (先写临时文件再替换)
+    bool store(GLuint program, const std::string& vert, const std::string& frag, const std::string& defines = std::string());
+    // 删除对应的缓存文件 (用于冷启动对比)
+    void remove(const std::string& vert, const std::string& frag, const std::string& defines = std::string());
+
+    const ProgramCacheStats& stats() const { return stats_; }
+
+private:
+    std::string directory_;
+    uint64_t driverHash_;   // 厂商/渲染器/版本字符串的哈希
+    bool supported_;
+    ProgramCacheStats stats_;
+
+    // 源码与宏定义的哈希
+    static uint64_t sourceHash(const std::string& vert, const std::string& frag, const std::string& defines);
+    // 缓存文件路径
+    std::string pathFor(uint64_t source) const;
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "glm.hpp"
+#include "mesh.h"
+
+class Shader;
+class Cube;
+class ObjectUniformBuffer;
+
+// 绘制视图：一个 Pass 的视点与深度范围 (用于前后排序)
+struct RenderView {
+    uint32_t pass = 0;               // Pass 编号 (0 - 15)，决定排序键最高位
+    LodPass lodPass = LodPass::Main; // 使用的 LOD 选择结果
+    glm::vec3 eye = glm::vec3(0.0f); // 视点 (世界空间)
+    float depthRange = 1.0f;         // 深度归一化范围 (远平面距离)
+};
+
+// 绘制包
+// 排序键 (高位优先)：[63:60] Pass | [59:52] 程序 | [51:36] 材质 (纹理) | [35:28] 几何 (VAO) | [27:4] 深度 | [3:0] 保留
+// 深度为包围球到视点的最近距离，越近越小 (由前向后，提高 early-z 剔除率)
+struct DrawPacket {
+    enum Kind : uint8_t { MeshLodDraw, MeshStreamDraw, CubeInstancesDraw };
+
+    uint64_t key = 0;
+    Shader* shader = nullptr;
+    Mesh* mesh = nullptr;
+    Cube* cube = nullptr;
+    uint32_t objectSlot = 0;   // 对象 UBO 槽位
+    uint32_t firstIndex = 0;   // 流式绘制：索引流中的起点
+    uint32_t indexCount = 0;   // 流式绘制：索引数
+    uint32_t instanceCount = 0; // 实例化绘制：实例数
+    LodPass lodPass = LodPass::Main;
+    Kind kind = MeshLodDraw;
+};
+
+// 执行统计 (每帧由 execute 累加)
+struct RenderQueueStats {
+    size_t packets = 0;          // 执行的绘制包数
+    size_t programChanges = 0;   // 程序切换次数
+    size_t materialChanges = 0;  // 材质 (纹理) 切换次数
+    size_t geometryChanges = 0;  // VAO 切换次数
+    size_t objectChanges = 0;    // 对象 UBO 槽位切换次数
+};
+
+// 渲染队列
+// 各 Pass 先提交绘制包，每帧基数排序一次后按 Pass 依次执行；相同状态的绘制相邻，只在状态变化时切换
+// 程序编号在队列的生命周期内保持稳定，容器保留容量，稳定状态下不分配内存
+class RenderQueue {
+public:
+    static const uint32_t kMaxPasses = 16;
+
+    // 清空上一帧的绘制包 (保留容量)
+    void clear();
+
+    // 提交按 LOD 完整绘制的网格 (modelMatrix 用于计算包围球深度)
+    void submitMesh(const RenderView& view, Shader& shader, Mesh& mesh, uint32_t objectSlot, const glm::mat4& modelMatrix);
+    // 提交网格在索引流中的一段 (逐簇剔除的结果，索引流须在执行前上传)
+    void submitStream(const RenderView& view, Shader& shader, Mesh& mesh, uint32_t objectSlot, const glm::mat4& modelMatrix,
+                      uint32_t firstIndex, uint32_t indexCount);
+    // 提交实例化绘制的一组立方体 (实例属性已配置在立方体的 VAO 上，center/radius 为全部实例的世界空间包围球)
+    void submitCubes(const RenderView& view, Shader& shader, Cube& cube, uint32_t instanceCount,
+                     const glm::vec3& center, float radius);
+
+    // 按排序键基数排序 (LSD，每次 8 位，所有键相同的字节跳过)
+    void sort();
+    // 执行某个 Pass 的绘制包 (须先 sort)，objects 用于绑定对象槽位
+    // 每个 Pass 的 Uniform 状态 (采样器单元、阴影面等) 由调用方在执行前设置
+    void execute(uint32_t pass, const ObjectUniformBuffer& objects);
+
+    size_t size() const { return packets_.size(); }
+    const RenderQueueStats& stats() const { return stats_; }
+    void resetStats() { stats_ = RenderQueueStats{}; }
+
+    // 组合排序键；depth01 为归一化深度 [0, 1]
+    static uint64_t makeKey(uint32_t pass, uint32_t program, uint32_t material, uint32_t geometry, float depth01);
+
+private:
+    // 排序项：键与绘制包下标
+    struct SortItem {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    std::vector<DrawPacket> packets_;
+    std::vector<SortItem> order_;    // 排序结果
+    std::vector<SortItem> scratch_;  // 基数排序的交替缓冲
+    std::vector<const Shader*> programs_; // 程序编号表
+    size_t passBegin_[kMaxPasses + 1] = {}; // 排序后各 Pass 在 order_ 中的起点
+    RenderQueueStats stats_;
+
+    uint32_t programId(const Shader* shader);
+    void push(const RenderView& view, DrawPacket& packet, uint32_t material, uint32_t geometry, float distance);
+};
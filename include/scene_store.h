@@ -0,0 +1,118 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "glm.hpp"
+
+// 立方体参数 (UI 编辑的值，经 SceneStore::set 写入场景)
+struct CubeConfig {
+    float length = 1.0f;
+    float width = 1.0f;
+    float height = 1.0f;
+    glm::vec3 pos = glm::vec3(0.0f, 0.0f, 0.0f);
+    float scale = 1.0f;
+    glm::vec3 color = glm::vec3(1.0f, 1.0f, 1.0f);
+    glm::vec3 rot = glm::vec3(0.0f, 0.0f, 0.0f);
+    bool visible = true;
+};
+
+// 实体句柄：下标 + 代数
+// 实体删除后下标可被新实体复用，代数随之增加，旧句柄不再有效
+struct EntityHandle {
+    uint32_t index = ~0u;
+    uint32_t generation = 0;
+
+    bool operator==(const EntityHandle& o) const { return index == o.index && generation == o.generation; }
+    bool operator!=(const EntityHandle& o) const { return !(*this == o); }
+};
+
+// 实体变化记录 (每个下标每帧至多一条，记录变化前的状态)
+struct SceneChange {
+    uint32_t index;        // 实体下标 (实体可能已被删除，或下标已被新实体复用)
+    bool wasVisible;       // 变化前是否可见
+    glm::vec3 oldCenter;   // 变化前的世界空间包围球 (wasVisible 时有效)
+    float oldRadius;
+};
+
+// 场景存储 (实体/组件，SoA)
+// - 变换 (位置、欧拉角、缩放、长宽高)、缓存的世界矩阵、包围盒/包围球、材质 (颜色) 各自连续存放
+// - 组件按稠密下标存放，可见实体排在前 visibleCount() 个，渲染、剔除与阴影只遍历这一段
+// - 外部以句柄访问实体；句柄下标到稠密下标的映射在删除或可见性变化 (交换位置) 时更新
+// - 参数变化时只记录变化，update 中才重算世界矩阵与包围体 (欧拉角到矩阵的转换只在变化时进行)
+class SceneStore {
+public:
+    static constexpr uint32_t kNull = ~0u;
+
+    EntityHandle create(const CubeConfig& cfg);
+    // 删除实体 (句柄失效时忽略)
+    void destroy(EntityHandle h);
+    bool alive(EntityHandle h) const {
+        return h.index < dense_.size() && dense_[h.index] != kNull && generation_[h.index] == h.generation;
+    }
+
+    // 读取实体参数，句柄失效时返回 false
+    bool get(EntityHandle h, CubeConfig& out) const;
+    // 写入实体参数 (句柄失效时忽略)，与当前值相同时不记录变化
+    void set(EntityHandle h, const CubeConfig& cfg);
+
+    // 重算变化实体的世界矩阵与包围体
+    void update();
+    // 上次 clearChanges 以来的变化 (update 之后读取)
+    const std::vector<SceneChange>& changes() const { return changes_; }
+    void clearChanges();
+
+    size_t size() const { return entity_.size(); }
+    size_t visibleCount() const { return visibleCount_; }
+    // 稠密下标 → 句柄
+    EntityHandle handleAt(size_t d) const { return { entity_[d], generation_[entity_[d]] }; }
+    // 实体下标 → 稠密下标 (实体不存在时为 kNull)
+    uint32_t denseIndex(uint32_t index) const { return index < dense_.size() ? dense_[index] : kNull; }
+    // 实体下标 → 当前句柄 (实体不存在时返回无效句柄)
+    EntityHandle handle(uint32_t index) const {
+        return denseIndex(index) == kNull ? EntityHandle{} : EntityHandle{ index, generation_[index] };
+    }
+    // 实体下标的上界 (其中已删除的下标没有实体)
+    uint32_t indexCount() const { return uint32_t(dense_.size()); }
+    // 从实体下标 index 起按 forward 方向找最近的存活实体，该方向没有时反向查找 (没有实体时返回无效句柄)
+    EntityHandle nearest(uint32_t index, bool forward) const;
+
+    // 按稠密下标读取组件 (update 之后有效)
+    const glm::mat4& world(size_t d) const { return world_[d]; }
+    const glm::vec3& color(size_t d) const { return color_[d]; }
+    const glm::vec3& boundsCenter(size_t d) const { return center_[d]; }   // 世界空间包围盒与包围球的中心
+    const glm::vec3& boundsExtent(size_t d) const { return extent_[d]; }   // 世界空间包围盒的半边长
+    float boundsRadius(size_t d) const { return radius_[d]; }               // 世界空间包围球半径
+
+private:
+    // 变换组件
+    std::vector<glm::vec3> position_;
+    std::vector<glm::vec3> rotation_;  // 欧拉角 (度)，按 X、Y、Z 的顺序旋转
+    std::vector<float> scale_;
+    std::vector<glm::vec3> size_;      // 长宽高
+    // 缓存的世界矩阵与包围体
+    std::vector<glm::mat4> world_;
+    std::vector<glm::vec3> center_;
+    std::vector<glm::vec3> extent_;
+    std::vector<float> radius_;
+    // 材质
+    std::vector<glm::vec3> color_;
+    // 稠密下标 → 实体下标
+    std::vector<uint32_t> entity_;
+    size_t visibleCount_ = 0;
+
+    // 按实体下标
+    std::vector<uint32_t> dense_;      // 稠密下标 (已删除为 kNull)
+    std::vector<uint32_t> generation_;
+    std::vector<uint8_t> changed_;     // 本轮是否已有变化记录
+    std::vector<uint32_t> freeIndices_;
+
+    std::vector<SceneChange> changes_;
+
+    // 记录变化前的状态 (每个下标每轮只记录第一次)
+    void recordChange(uint32_t index);
+    // 交换两个稠密位置的全部组件并更新映射
+    void swapSlots(size_t a, size_t b);
+    // 把稠密位置 d 的实体移入或移出可见段
+    void setVisible(size_t d, bool visible);
+    void computeWorld(size_t d);
+};
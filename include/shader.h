@@ -1,7 +1,39 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <vector>
 #include <glad/glad.h>
 #include "glm.hpp"
+#include "hash.h"
+
+class ProgramBinaryCache;
+
+// 编译期哈希的 Uniform 名
+// 通常声明为 constexpr 常量，设置 Uniform 时按哈希在程序的反射表中查找，不构造字符串
+struct UniformName {
+    uint64_t hash;
+    const char* text;
+    constexpr explicit UniformName(const char* name) : hash(fnv1a64_str(name)), text(name) {}
+};
+
+// 类型化的 Uniform 句柄 (程序反射表中的下标)
+// 由 Shader::handle 在程序链接后解析；程序不含该 Uniform 或类型不符时无效，设置无效句柄为空操作
+// 程序重新编译后句柄失效，需重新获取
+template <typename T>
+class UniformHandle {
+public:
+    bool valid() const { return index_ >= 0; }
+private:
+    int index_ = -1;
+    friend class Shader;
+};
+
+// Uniform 设置计数 (所有程序累计，只在 GL 线程上修改)
+struct UniformCounters {
+    uint64_t lookups = 0;    // glGetUniformLocation 调用次数 (链接时的反射也计入)
+    uint64_t uploads = 0;    // 实际执行的 glUniform* 次数
+    uint64_t redundant = 0;  // 与上次值相同而跳过的设置次数
+};
 
 // 着色器管理类
 // 负责编译、链接 GLSL 着色器程序，并提供设置 Uniform 变量的接口
@@ -15,14 +47,37 @@ public:
     // 从源码字符串编译着色器
     // vert: 顶点着色器源码
     // frag: 片元着色器源码
-    bool compileFromSource(const std::string& vert, const std::string& frag);
+    // cache: 程序二进制缓存 (可为空)，命中时跳过编译与链接，未命中时编译后写入
+    // geom: 几何着色器源码 (可为空)
+    bool compileFromSource(const std::string& vert, const std::string& frag, ProgramBinaryCache* cache = nullptr,
+                           const std::string& geom = std::string());
     
-    // 从文件路径加载并编译着色器
+    // 从文件路径加载并编译着色器 (源文件经 preprocessFile 处理)
     // vertPath: 顶点着色器文件路径
     // fragPath: 片元着色器文件路径
-    bool compileFromFiles(const std::string& vertPath, const std::string& fragPath);
+    // defines: 注入各阶段的宏定义文本 ("#define NAME VALUE" 行)，用于编译特化变体
+    // geomPath: 几何着色器文件路径 (可为空)
+    bool compileFromFiles(const std::string& vertPath, const std::string& fragPath, ProgramBinaryCache* cache = nullptr,
+                          const std::string& defines = std::string(), const std::string& geomPath = std::string());
+
+    // 最近一次成功编译是否直接来自程序二进制缓存
+    bool fromBinary() const;
+
+    // 提交编译但不等待结果：两个阶段与链接一次性交给驱动，不查询任何状态
+    // 命中程序二进制缓存时立即就绪；文件读取失败时返回 false (错误见 error())
+    bool submitFromSource(const std::string& vert, const std::string& frag, ProgramBinaryCache* cache = nullptr,
+                          const std::string& geom = std::string());
+    bool submitFromFiles(const std::string& vertPath, const std::string& fragPath, ProgramBinaryCache* cache = nullptr,
+                         const std::string& defines = std::string(), const std::string& geomPath = std::string());
+    // 轮询已提交的编译，返回 true 表示已结束 (成功时替换当前程序，失败时见 error())
+    // parallel: 驱动支持 KHR_parallel_shader_compile，先查询完成状态，未完成时立即返回 false 而不阻塞
+    bool poll(bool parallel);
+    // 是否有已提交但尚未结束的编译
+    bool pending() const;
+    // 是否已有可用的程序
+    bool ready() const;
     
-    // 激活当前着色器程序 (glUseProgram)
+    // 激活当前着色器程序 (经 GLState 缓存，已激活时省略 glUseProgram)
     void use() const;
     
     // 获取 Program ID
@@ -31,10 +86,31 @@ public:
     // 获取编译/链接错误信息
     const std::string& error() const;
     
-    // 获取 Uniform 变量的位置 Location
+    // 获取 Uniform 变量的位置 Location (直接查询驱动，计入 lookups)
     GLint uniform(const char* name) const;
+
+    // 按名字获取类型化句柄 (在链接时建立的反射表中二分查找，不访问驱动)
+    template <typename T>
+    UniformHandle<T> handle(const UniformName& name) const {
+        UniformHandle<T> h;
+        h.index_ = findUniform(name.hash, kindOf(static_cast<const T*>(nullptr)));
+        return h;
+    }
+
+    // 通过句柄设置 Uniform (程序须已激活)：与影子副本中的上次值比较，相同时跳过上传
+    void set(UniformHandle<bool> h, bool value) const;
+    void set(UniformHandle<int> h, int value) const;
+    void set(UniformHandle<float> h, float value) const;
+    void set(UniformHandle<glm::vec3> h, const glm::vec3& value) const;
+    void set(UniformHandle<glm::mat4> h, const glm::mat4& value) const;
+    // 按编译期哈希名设置 (查找 + 设置，无堆分配)
+    template <typename T>
+    void set(const UniformName& name, const T& value) const { set(handle<T>(name), value); }
+
+    // 全局 Uniform 计数
+    static const UniformCounters& counters();
     
-    // 设置 Uniform 变量
+    // 设置 Uniform 变量 (运行时对名字求哈希后走反射表，与句柄共用影子副本)
     void setBool(const std::string &name, bool value) const;
     void setInt(const std::string &name, int value) const;
     void setFloat(const std::string &name, float value) const;
@@ -44,9 +120,57 @@ public:
 private:
     GLuint program_;        // 着色器程序 ID
     std::string error_;     // 错误信息缓存
-    
-    // 辅助函数：读取文件内容
+    bool fromBinary_;       // 程序是否由二进制缓存创建
+
+    // 已提交、尚未完成的编译
+    GLuint pendingProgram_;
+    GLuint pendingVert_;
+    GLuint pendingFrag_;
+    GLuint pendingGeom_;          // 没有几何着色器时为 0
+    ProgramBinaryCache* pendingCache_;
+    std::string pendingVertSrc_;  // 写入二进制缓存时作为键
+    std::string pendingFragSrc_;
+    std::string pendingGeomSrc_;
+
+    // Uniform 值的类别 (决定可接受的 GL 类型与影子副本大小)
+    enum class UniformKind { Bool, Int, Float, Vec3, Mat4 };
+    // 反射表项：链接时建立，按名字哈希排序
+    struct UniformSlot {
+        uint64_t hash = 0;
+        GLint location = -1;
+        GLenum type = 0;
+        bool hasValue = false;   // 影子副本是否有效
+        float value[16] = {};    // 最近一次上传的值 (按位比较)
+    };
+    mutable std::vector<UniformSlot> uniforms_; // 影子副本随设置更新，设置接口保持 const
+
+    static UniformKind kindOf(const bool*) { return UniformKind::Bool; }
+    static UniformKind kindOf(const int*) { return UniformKind::Int; }
+    static UniformKind kindOf(const float*) { return UniformKind::Float; }
+    static UniformKind kindOf(const glm::vec3*) { return UniformKind::Vec3; }
+    static UniformKind kindOf(const glm::mat4*) { return UniformKind::Mat4; }
+
+public:
+    // 辅助函数：读取文件内容 (去除 UTF-8 BOM)
     static bool readFile(const std::string& path, std::string& out);
-    // 辅助函数：编译单个着色器阶段 (Vertex/Fragment)
-    static GLuint compileStage(GLenum type, const std::string& src, std::string& outError);
+    // 预处理着色器源文件
+    // 展开 #include "file" (相对于包含者所在目录，同一文件只展开一次)，在 #version 行之后插入 defines；
+    // 插入 #line 使编译错误的行号对应原文件 (源串号 0 为主文件，包含文件按展开顺序从 1 编号)
+    static bool preprocessFile(const std::string& path, const std::string& defines, std::string& out, std::string& error);
+
+private:
+    // 辅助函数：提交单个着色器阶段 (Vertex/Geometry/Fragment) 的编译，不查询状态
+    static GLuint compileStage(GLenum type, const std::string& src);
+    // 辅助函数：读取阶段的编译错误，编译成功时返回 false
+    static bool stageError(GLuint shader, std::string& outError);
+    // 释放未完成编译的对象
+    void releasePending();
+    // 把程序中的 FrameData / ObjectData 块绑定到共享的绑定点
+    void bindUniformBlocks();
+    // 建立反射表：枚举程序的活动 Uniform (不含块成员)，记录位置与类型
+    void reflectUniforms();
+    // 按哈希查找并检查类型，找不到或类型不符时返回 -1
+    int findUniform(uint64_t hash, UniformKind kind) const;
+    // 与影子副本比较并更新，返回是否需要上传
+    bool changed(int index, const void* data, size_t bytes) const;
 };
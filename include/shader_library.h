@@ -0,0 +1,59 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <string>
+#include "shader.h"
+
+class ProgramBinaryCache;
+
+// 着色器程序库
+// 所有程序在启动时一次性提交编译，驱动可在后台并行完成；渲染循环每帧轮询结果而不阻塞，
+// 尚未就绪的程序由一个极简的后备程序代替 (纯色、无光照)，就绪后自动切换
+// 驱动支持 KHR_parallel_shader_compile 时通过 GL_COMPLETION_STATUS_KHR 查询完成状态；
+// 否则每次 update 只结束一个程序，把同步等待分散到多帧
+class ShaderLibrary {
+public:
+    // cache: 程序二进制缓存 (可为空)
+    explicit ShaderLibrary(ProgramBinaryCache* cache = nullptr);
+
+    ShaderLibrary(const ShaderLibrary&) = delete;
+    ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+    // 提交一个程序的编译，返回的引用在库的生命周期内有效
+    // defines: 注入的宏定义 (见 Shader::compileFromFiles)；可在渲染循环中随时添加 (如按需编译的变体)
+    // geomPath: 几何着色器文件路径 (可为空)
+    Shader& add(const std::string& vertPath, const std::string& fragPath, const std::string& defines = std::string(),
+                const std::string& geomPath = std::string());
+
+    // 每帧调用：轮询已提交的编译，返回本次结束的程序数
+    size_t update();
+    // 阻塞直至所有程序结束
+    void finish();
+
+    // 程序已就绪时返回它本身，否则返回后备程序
+    Shader& resolve(Shader& shader);
+    // 所有程序是否已结束 (成功或失败)
+    bool done() const { return pending_ == 0; }
+    // 第一个编译或链接失败的程序 (错误见 Shader::error())，没有时返回空
+    const Shader* failed() const;
+
+    // 驱动是否支持 KHR_parallel_shader_compile
+    bool parallel() const { return parallel_; }
+    // 从第一次提交到全部结束的耗时 (毫秒，未结束时为 0)
+    double doneMs() const { return doneMs_; }
+    size_t count() const { return shaders_.size(); }
+
+private:
+    ProgramBinaryCache* cache_;
+    std::deque<Shader> shaders_;   // deque 保证 add 返回的引用稳定
+    Shader fallback_;
+    bool parallel_;
+    size_t pending_;
+    double doneMs_;
+    std::chrono::steady_clock::time_point start_;
+    bool started_;
+
+    // 查询驱动扩展列表
+    static bool hasExtension(const char* name);
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "shader.h"
+
+class ShaderLibrary;
+
+// 场景着色器的特化选项
+// 每种组合编译为独立的程序，片元着色器中不再按 Uniform 逐片段分支，PCF 循环次数为编译期常量
+struct ShaderPermutation {
+    bool textured = true;  // HAS_TEXTURE: 采样漫反射纹理，否则以 objectColor 为基础色
+    bool outline = true;   // OUTLINE: 背面顶点沿法线挤出并输出黑色描边
+    int pcfSamples = 20;   // PCF_SAMPLES: 阴影采样数，取 kPcfSampleCounts 中不超过该值的最大一档
+
+    static constexpr int kPcfSampleCounts[4] = { 1, 4, 8, 20 };
+
+    // 按位打包的变体键 (只包含规范化后的取值)
+    uint32_t key() const;
+    // 注入源码的宏定义文本
+    std::string defines() const;
+    // 规范化后的 PCF 档位下标
+    int pcfLevel() const;
+};
+
+// 着色器变体集合
+// 同一对源文件按不同的特化选项编译出的程序；变体在首次请求时经 ShaderLibrary 提交编译 (不阻塞)，
+// 之后按键缓存复用。查找为线性扫描，变体数很少，稳定状态下不分配内存
+class ShaderVariants {
+public:
+    ShaderVariants(ShaderLibrary& library, std::string vertPath, std::string fragPath);
+
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    // 获取变体程序 (首次请求时提交编译)，编译完成前 ready() 为 false
+    Shader& request(const ShaderPermutation& permutation);
+    // 获取可用于绘制的程序：变体已就绪时返回它；否则返回纹理与描边选项相同、只有 PCF 档位不同的已就绪变体
+    // (避免切换采样数时闪烁)，没有时返回库的后备程序
+    Shader& resolve(const ShaderPermutation& permutation);
+    // 已请求的变体数
+    size_t count() const { return variants_.size(); }
+
+private:
+    ShaderLibrary& library_;
+    std::string vertPath_;
+    std::string fragPath_;
+    std::vector<std::pair<uint32_t, Shader*>> variants_; // 变体键 -> 程序 (程序由库持有)
+};
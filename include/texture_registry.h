@@ -0,0 +1,41 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "mesh.h"
+#include "texture_streamer.h"
+
+// 纹理注册表
+// 以 "来源 + 采样参数" 为键 (来源为 <模型路径>|*N 形式的内嵌纹理或图像文件路径)，
+// 在所有模型与网格之间共享同一个纹理对象；注册表只持有弱引用，最后一个 Mesh 释放后纹理即被删除
+// 只能在 GL 线程上使用
+class TextureRegistry {
+public:
+    explicit TextureRegistry(TextureStreamer& streamer);
+
+    TextureRegistry(const TextureRegistry&) = delete;
+    TextureRegistry& operator=(const TextureRegistry&) = delete;
+
+    // 生成注册表键
+    static std::string makeKey(const std::string& source, const SamplerDesc& sampler);
+
+    // 查找仍然存活的纹理，不存在时返回空
+    std::shared_ptr<GLTexture> find(const std::string& key);
+
+    // 创建并登记纹理，解码与上传交给 TextureStreamer (调用方应先 find)
+    std::shared_ptr<GLTexture> loadEncoded(const std::string& key, std::vector<unsigned char> encoded,
+                                           const SamplerDesc& sampler,
+                                           TextureStreamer::DecodedCallback onDecoded = nullptr);
+    std::shared_ptr<GLTexture> loadPixels(const std::string& key, int width, int height, const unsigned char* pixels,
+                                          std::shared_ptr<const void> owner, const SamplerDesc& sampler);
+
+    // 清理已释放的条目，返回存活纹理数量
+    size_t collect();
+
+    TextureStreamer& streamer() { return streamer_; }
+
+private:
+    TextureStreamer& streamer_;
+    std::unordered_map<std::string, std::weak_ptr<GLTexture>> entries_; // 键 -> 共享纹理
+};
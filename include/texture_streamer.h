@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include "mesh.h"
+
+class ThreadPool;
+
+// 纹理流式加载器
+// 压缩图像在线程池上解码；像素数据经由 PBO 环形缓冲分帧上传，每帧拷贝量受字节预算限制
+// 纹理对象在请求时立即创建并填充 1x1 占位纹素，完整图像驻留前网格照常使用占位纹理绘制
+class TextureStreamer {
+public:
+    // 解码完成回调，在工作线程上调用 (解码失败时参数为空)
+    using DecodedCallback = std::function<void(std::shared_ptr<const ImageData>)>;
+
+    // pool: 解码使用的线程池
+    // bytesPerFrame: 每帧最多写入 PBO 的字节数
+    // ringSize: PBO 环形缓冲数量
+    explicit TextureStreamer(ThreadPool& pool, size_t bytesPerFrame = 4u << 20, int ringSize = 3);
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // 请求解码压缩图像 (png/jpg 等) 并异步上传，立即返回占位纹理
+    std::shared_ptr<GLTexture> loadEncoded(std::vector<unsigned char> encoded, const SamplerDesc& sampler,
+                                           DecodedCallback onDecoded = nullptr);
+    // 请求异步上传已解码的 RGBA8 像素，立即返回占位纹理
+    // owner: 保证 pixels 在上传完成前有效 (如缓存文件映射)
+    std::shared_ptr<GLTexture> loadPixels(int width, int height, const unsigned char* pixels,
+                                          std::shared_ptr<const void> owner, const SamplerDesc& sampler);
+
+    // 每帧在 GL 线程调用：在预算内把解码完成的像素写入 PBO，并提交完整图像
+    void update();
+    // 阻塞直至所有请求驻留 (不受每帧预算限制)
+    void finish();
+
+    // 同步解码压缩图像为 RGBA8，可在任意线程调用
+    static bool decode(const unsigned char* data, size_t size, ImageData& out);
+
+    void setBytesPerFrame(size_t bytes);
+    size_t bytesPerFrame() const { return bytesPerFrame_; }
+    // 尚未驻留的纹理数量
+    size_t pendingCount() const { return pending_; }
+    // 累计经 PBO 上传的字节数
+    uint64_t uploadedBytes() const { return uploadedBytes_; }
+
+private:
+    // 单个上传请求 (只在 GL 线程上持有，纹理对象不会在工作线程上析构)
+    struct Upload {
+        std::shared_ptr<GLTexture> texture;
+        SamplerDesc sampler;
+        int width = 0;
+        int height = 0;
+        const unsigned char* pixels = nullptr;  // 为空表示解码失败，保留占位纹理
+        std::shared_ptr<const void> owner;      // 像素数据所有者
+        size_t staged = 0;                      // 已写入 PBO 的字节数
+        int pbo = -1;                           // 占用的 PBO 槽位
+    };
+    // 工作线程的解码结果
+    struct Decoded {
+        uint64_t ticket = 0;
+        std::shared_ptr<ImageData> image; // 解码失败时为空
+    };
+    // 工作线程与 GL 线程共享的就绪队列
+    struct ReadyQueue {
+        std::mutex mutex;
+        std::deque<Decoded> decoded;
+    };
+
+    ThreadPool& pool_;
+    std::shared_ptr<ReadyQueue> ready_;                // 解码完成、等待上传的请求
+    std::unordered_map<uint64_t, Upload> decoding_;   // 正在解码的请求 (按票据索引)
+    std::deque<Upload> queue_;                        // GL 线程上的上传队列
+    uint64_t nextTicket_;
+    std::vector<GLuint> pbos_;          // PBO 环
+    std::vector<size_t> pboSizes_;      // 各 PBO 当前容量
+    std::vector<GLsync> fences_;        // 各 PBO 最近一次提交的栅栏
+    int nextPbo_;
+    size_t bytesPerFrame_;
+    size_t pending_;
+    uint64_t uploadedBytes_;
+
+    // 创建带 1x1 占位纹素的纹理对象
+    std::shared_ptr<GLTexture> createPlaceholder(const SamplerDesc& sampler);
+    // 获取下一个空闲 PBO 槽位，GPU 仍在读取时返回 -1
+    int acquirePbo(size_t size);
+    // 处理上传队列，budget 为本次可写入的字节数
+    void pump(size_t budget);
+    // 从 PBO 提交完整图像并生成 mipmap
+    void commit(Upload& u);
+};
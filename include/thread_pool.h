@@ -0,0 +1,43 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作线程池
+// 用于模型转换、纹理解码等可并行的 CPU 工作，任务中禁止调用 OpenGL
+class ThreadPool {
+public:
+    // threadCount: 工作线程数，0 表示使用硬件并发数
+    explicit ThreadPool(unsigned threadCount = 0);
+    // 析构时执行完队列中剩余任务后退出
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 工作线程数量
+    unsigned threadCount() const { return static_cast<unsigned>(workers_.size()); }
+
+    // 提交异步任务
+    void submit(std::function<void()> task);
+
+    // 并行执行 fn(i), i ∈ [0, count)
+    // 调用线程同样参与执行 (总并发度为 threadCount())，返回时所有迭代均已完成
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+    // 进程共享的默认线程池
+    static ThreadPool& shared();
+
+private:
+    std::vector<std::thread> workers_;           // 工作线程
+    std::deque<std::function<void()>> tasks_;    // 任务队列
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_;
+
+    void workerLoop();
+};
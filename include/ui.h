@@ -1,23 +1,17 @@
 #pragma once
 #include "cube.h"
+#include "mesh.h"
+#include "cluster_culling.h"
+#include "frustum_cull.h"
+#include "bvh.h"
+#include "occlusion.h"
+#include "scene_store.h"
 #include <vector>
 #include "glm.hpp"
 #include "gtc/matrix_transform.hpp"
 
 struct GLFWwindow;
 
-// 场景中单个立方体的配置信息
-struct CubeConfig {
-    float length = 1.0f;
-    float width = 1.0f;
-    float height = 1.0f;
-    glm::vec3 pos = glm::vec3(0.0f, 0.0f, 0.0f);
-    float scale = 1.0f;
-    glm::vec3 color = glm::vec3(1.0f, 1.0f, 1.0f);
-    glm::vec3 rot = glm::vec3(0.0f, 0.0f, 0.0f);
-    bool visible = true;
-};
-
 // UI 状态结构体
 // 包含所有通过 UI 控制的参数和场景状态
 struct UIState {
@@ -65,9 +59,89 @@ struct UIState {
     glm::vec3 cube_color = glm::vec3(1.0f, 1.0f, 1.0f);
     glm::vec3 cube_rot = glm::vec3(0.0f, 0.0f, 0.0f);
     
-    // 场景中所有立方体的列表
-    std::vector<CubeConfig> cubes;
-    int selected_cube = -1; // 当前选中的立方体索引
+    // 场景中的立方体 (实体/组件存储，UI 经句柄读写)
+    SceneStore scene;
+    EntityHandle selected_cube; // 当前选中的立方体
+
+    // LOD 参数 (由 main 转换为 LodSettings)
+    bool lod_enabled = true;
+    float lod_error_px = 1.0f;     // 允许的屏幕空间误差 (像素)
+    float lod_shadow_bias = 4.0f;  // 阴影 Pass 误差倍数
+    float lod_hysteresis = 0.2f;   // 切换滞回比例
+
+    // LOD 统计 (每帧由 main 填写)
+    int lod_levels = 0;                           // 模型中最多的 LOD 级别数
+    size_t lod_level_tris[kMaxLodLevels] = {};    // 各级别三角形总数
+    size_t lod_main_meshes[kMaxLodLevels] = {};   // 主 Pass 各级别选中的网格数
+    size_t lod_shadow_meshes[kMaxLodLevels] = {}; // 阴影 Pass 各级别选中的网格数
+    size_t lod_main_tris = 0;                     // 主 Pass 绘制的三角形数
+    size_t lod_shadow_tris = 0;                   // 阴影 Pass 绘制的三角形数 (6 个面合计)
+    size_t lod_full_tris = 0;                     // 不使用 LOD 时单次绘制的三角形数
+    float frame_ms_lod_on = 0.0f;                 // 开启 LOD 时的平滑帧时间
+    float frame_ms_lod_off = 0.0f;                // 关闭 LOD 时的平滑帧时间
+
+    // 阴影参数
+    int shadow_pcf_samples = 20;   // PCF 采样数 (1 / 4 / 8 / 20，每档对应一个着色器变体)
+    bool shadow_layered = false;   // 分层渲染：几何着色器一次提交 6 个面 (否则逐面提交)
+
+    // 阴影 Pass 耗时 (每帧由 main 填写，下标 0 为逐面、1 为分层，各自平滑)
+    bool shadow_layered_active = false; // 本帧实际使用的模式 (分层程序就绪前回退到逐面)
+    float shadow_cpu_ms[2] = {};        // CPU：提交与剔除
+    float shadow_gpu_ms[2] = {};        // GPU：GL_TIME_ELAPSED 查询
+    int shadow_faces_rendered = 0;      // 本帧重新渲染的面数 (阴影缓存)
+    int shadow_faces_skipped = 0;       // 本帧沿用缓存的面数
+    uint64_t shadow_version = 0;        // 阴影状态版本
+    size_t shadow_casters[6] = {};      // 各面提交的投射体数 (未渲染的面为 0；分层渲染时全部计入第 0 项)
+    size_t shadow_caster_candidates = 0; // 不做逐面剔除时每个面的投射体数
+
+    // 逐簇剔除参数
+    bool cluster_culling = true;
+    bool cluster_backface_main = false;   // 主 Pass 剔除背面簇 (描边依赖背面三角形，默认关闭)
+    bool cluster_backface_shadow = true;  // 阴影 Pass 剔除背面簇 (对封闭网格不影响阴影)
+
+    // 逐簇剔除统计 (每帧由 main 填写，阴影为 6 个面合计)
+    size_t cluster_count = 0;             // 模型的簇总数
+    ClusterCullStats cluster_main;
+    ClusterCullStats cluster_shadow;
+
+    // 主 Pass 视锥剔除 (网格与立方体的包围盒，每帧由 main 填写)
+    bool frustum_culling = true;
+    FrustumCullStats frustum_meshes;
+    FrustumCullStats frustum_cubes;
+    float frustum_cull_ms = 0.0f;         // 变换、测试与可见立方体挑选的 CPU 耗时
+    BvhStats bvh;                         // 立方体层次包围盒
+    size_t bvh_query_nodes = 0;           // 视锥查询访问的节点数
+
+    // 主 Pass 遮挡剔除 (开启视锥剔除时在其之后进行，否则测试全部网格与可见立方体；每帧由 main 填写)
+    bool occlusion_culling = true;
+    bool occlusion_debug = false;         // 显示遮挡缓冲区
+    OcclusionRasterStats occlusion_raster;
+    size_t occlusion_tested = 0;          // 参与测试的网格与立方体数 (开启视锥剔除时为通过视锥剔除的)
+    size_t occlusion_meshes = 0;          // 被遮挡的网格数
+    size_t occlusion_cubes = 0;           // 被遮挡的立方体数
+    float occlusion_ms = 0.0f;            // 光栅化与测试的 CPU 耗时
+    unsigned int occlusion_texture = 0;   // 调试视图的纹理 (由 main 创建与更新)
+    int occlusion_size[2] = {};           // 遮挡缓冲区尺寸
+
+    // 模型加载进度与耗时 (每帧由 main 填写，从开始加载模型算起)
+    size_t load_meshes = 0;          // 已发布的网格数
+    size_t load_total = 0;           // 网格总数 (导入完成前为 0)
+    float load_first_frame_ms = 0.0f; // 首帧呈现时间
+    float load_first_mesh_ms = 0.0f;  // 首个网格可见时间
+    float load_all_ms = 0.0f;         // 网格与纹理全部驻留时间 (未完成时为 0)
+
+    // 渲染部分 (阴影与主 Pass) 的每帧计数 (每帧由 main 填写)
+    uint64_t frame_allocs = 0;            // 堆分配次数
+    uint64_t frame_uniform_lookups = 0;   // Uniform 位置查询次数
+    uint64_t frame_uniform_uploads = 0;   // 实际上传的 Uniform 数
+    uint64_t frame_uniform_redundant = 0; // 因值未变化而跳过的设置数
+    uint64_t frame_gl_issued = 0;         // 经 GLState 实际执行的状态调用数
+    uint64_t frame_gl_elided = 0;         // 与缓存相同而省略的状态调用数
+    size_t queue_packets = 0;             // 渲染队列执行的绘制包数
+    size_t queue_program_changes = 0;     // 程序切换次数
+    size_t queue_material_changes = 0;    // 材质切换次数
+    size_t queue_geometry_changes = 0;    // VAO 切换次数
+    size_t frame_instance_bytes = 0;      // 上传的立方体实例数据字节数
 
     // 鼠标输入状态
     double last_x = 0.0;
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include "glm.hpp"
+
+// Uniform 块绑定点 (着色器链接后由 Shader 按块名绑定)
+const GLuint kFrameBlockBinding = 0;   // FrameData：每帧数据，所有程序共享
+const GLuint kObjectBlockBinding = 1;  // ObjectData：每个对象的数据
+
+// 每帧数据 (std140，与着色器中的 FrameData 块逐字节对应)
+// vec3 后紧跟 float 时占用同一个 16 字节槽
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 shadowMatrices[6]; // 阴影立方体贴图 6 个面的 projection * view
+    glm::vec3 viewPos;
+    float farPlane = 1.0f;       // 阴影投影远平面 (深度归一化)
+    glm::vec3 lightPos;
+    float outlineWidth = 0.0f;   // 描边宽度
+    glm::vec3 lightColor;
+    float reserved = 0.0f;
+};
+static_assert(sizeof(FrameUniforms) == 560, "FrameUniforms must match the std140 FrameData block");
+
+// 每个对象的数据 (std140，与着色器中的 ObjectData 块对应)
+// 法线矩阵在 CPU 上随模型矩阵更新，以 mat4 存储 (std140 的 mat3 每列同样占 16 字节)
+struct ObjectUniforms {
+    glm::mat4 model;
+    glm::mat4 normalMatrix;
+    glm::vec3 objectColor;
+    float reserved = 0.0f;
+};
+static_assert(sizeof(ObjectUniforms) == 144, "ObjectUniforms must match the std140 ObjectData block");
+
+// 每帧 Uniform 缓冲区
+// 常驻绑定到 kFrameBlockBinding；内容与上次上传相同时跳过上传
+class FrameUniformBuffer {
+public:
+    FrameUniformBuffer();
+    ~FrameUniformBuffer();
+
+    FrameUniformBuffer(const FrameUniformBuffer&) = delete;
+    FrameUniformBuffer& operator=(const FrameUniformBuffer&) = delete;
+
+    // 上传本帧数据，返回是否实际上传
+    bool update(const FrameUniforms& data);
+
+private:
+    GLuint ubo_;
+    FrameUniforms last_;   // 最近一次上传的内容
+    bool valid_;           // last_ 是否有效
+};
+
+// 对象 Uniform 缓冲区
+// 每个对象占一个按 GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT 对齐的槽位，CPU 端保留副本；
+// set 只在数据变化时标记脏槽位并重算法线矩阵，flush 以一次 glBufferSubData 上传脏区间，
+// 绘制前用 bind 把槽位绑定到 kObjectBlockBinding
+class ObjectUniformBuffer {
+public:
+    explicit ObjectUniformBuffer(size_t capacity = 64);
+    ~ObjectUniformBuffer();
+
+    ObjectUniformBuffer(const ObjectUniformBuffer&) = delete;
+    ObjectUniformBuffer& operator=(const ObjectUniformBuffer&) = delete;
+
+    // 设置槽位数量 (超过容量时扩容，所有槽位重新上传)
+    void resize(size_t count);
+    size_t size() const { return objects_.size(); }
+
+    // 更新对象数据，与当前内容相同时不做任何事
+    void set(size_t slot, const glm::mat4& model, const glm::vec3& color = glm::vec3(1.0f));
+    // 上传脏槽位，返回上传的字节数
+    size_t flush();
+    // 把槽位绑定到 kObjectBlockBinding
+    void bind(size_t slot) const;
+
+    // 累计上传的字节数
+    uint64_t uploadedBytes() const { return uploadedBytes_; }
+
+private:
+    GLuint ubo_;
+    size_t stride_;        // 槽位步长 (对齐后)
+    size_t capacity_;      // 缓冲区可容纳的槽位数
+    std::vector<ObjectUniforms> objects_;
+    size_t dirtyBegin_;    // 脏区间 [dirtyBegin_, dirtyEnd_)
+    size_t dirtyEnd_;
+    std::vector<unsigned char> staging_; // 上传暂存 (按步长排布)
+    uint64_t uploadedBytes_;
+
+    void markDirty(size_t slot);
+};
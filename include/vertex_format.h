@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "glm.hpp"
+#include "shader.h"
+
+struct Vertex;
+struct VertexCube;
+
+// 顶点格式
+enum class VertexFormat {
+    Float32, // 全精度 float (Vertex 32 字节 / VertexCube 36 字节)
+    Packed,  // 量化压缩 (16 字节)
+};
+
+// 位置反量化变换：pos = unorm16 * scale + offset
+struct PositionQuantization {
+    glm::vec3 scale = glm::vec3(1.0f);
+    glm::vec3 offset = glm::vec3(0.0f);
+};
+
+// 压缩网格顶点 (16 字节)
+// 位置: 3 x unorm16 (按网格包围盒量化)；法线: 2 x snorm16 八面体编码；纹理坐标: 2 x half
+struct PackedVertex {
+    uint16_t Position[3];
+    uint16_t Padding;      // 保持法线 4 字节对齐
+    int16_t Normal[2];
+    uint16_t TexCoords[2];
+};
+
+// 压缩立方体顶点 (16 字节)
+// 位置与法线编码同 PackedVertex；颜色: 4 x unorm8
+struct PackedVertexCube {
+    uint16_t Position[3];
+    uint16_t Padding;
+    int16_t Normal[2];
+    uint8_t Color[4];
+};
+
+// 根据包围盒计算位置量化参数 (退化轴保持 scale 非零)
+PositionQuantization computeQuantization(const glm::vec3& minPos, const glm::vec3& maxPos);
+
+// 法线八面体编码为 2 x snorm16 (输入无需归一化)
+void octEncode(const glm::vec3& n, int16_t out[2]);
+// 八面体解码 (与着色器中的 octDecode 一致，用于校验)
+glm::vec3 octDecode(const int16_t in[2]);
+
+// 打包顶点数组，返回使用的量化参数
+PositionQuantization packVertices(const std::vector<Vertex>& in, std::vector<PackedVertex>& out);
+PositionQuantization packVertices(const std::vector<VertexCube>& in, std::vector<PackedVertexCube>& out);
+
+// 压缩格式下的索引类型：顶点数少于 65536 时使用 16 位索引
+inline bool useShortIndices(VertexFormat format, size_t vertexCount) {
+    return format == VertexFormat::Packed && vertexCount < 65536;
+}
+
+// 为当前绑定的 VAO/VBO 配置顶点属性 (location 0: 位置, 1: 法线, 2: 纹理坐标/颜色)
+void setupVertexAttributes(VertexFormat format, bool cube);
+
+// 顶点解码 Uniform (顶点着色器与深度着色器中的同名 Uniform)
+constexpr UniformName kPosScale("posScale");
+constexpr UniformName kPosOffset("posOffset");
+constexpr UniformName kOctNormals("octNormals");
+// 设置顶点解码参数 (全精度格式为恒等变换)，与上次相同时不会重新上传
+void applyDecodeUniforms(Shader& shader, const PositionQuantization& quant, VertexFormat format);
@@ -5,17 +5,36 @@
 // ---------------------------------------------------------
 
 layout(location = 0) in vec3 aPos; // 顶点位置
+#ifdef INSTANCED
+layout(location = 3) in mat4 instanceModel; // 实例模型矩阵 (立方体实例化绘制)
+#endif
 
-uniform mat4 model;            // 模型矩阵
-uniform mat4 lightSpaceMatrix; // 光空间矩阵
+uniform int shadowFace;        // 当前渲染的立方体贴图面 (0-5)
+uniform vec3 posScale = vec3(1.0);  // 压缩顶点格式的位置反量化缩放
+uniform vec3 posOffset = vec3(0.0); // 压缩顶点格式的位置反量化偏移
 
+#include "frame_data.glsl"
+#ifndef INSTANCED
+#include "object_data.glsl"
+#endif
 
+#ifndef LAYERED
 out vec4 FragPos; // 输出世界空间位置
+#endif
 
 void main() {
     // 计算世界空间位置
-    FragPos = model * vec4(aPos, 1.0);
-    
+#ifdef INSTANCED
+    vec4 worldPos = instanceModel * vec4(aPos * posScale + posOffset, 1.0);
+#else
+    vec4 worldPos = model * vec4(aPos * posScale + posOffset, 1.0);
+#endif
 
-    gl_Position = lightSpaceMatrix * FragPos;
+#ifdef LAYERED
+    // 分层渲染：输出世界空间位置，由几何着色器投影到各个面
+    gl_Position = worldPos;
+#else
+    FragPos = worldPos;
+    gl_Position = shadowMatrices[shadowFace] * worldPos;
+#endif
 }
@@ -6,8 +6,7 @@
 
 in vec4 FragPos; // 世界空间位置 (来自顶点着色器)
 
-uniform vec3 lightPos;  // 光源位置
-uniform float farPlane; // 远平面距离 (用于归一化深度)
+#include "frame_data.glsl"
 
 void main() {
     // 计算片段到光源的距离
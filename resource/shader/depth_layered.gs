@@ -0,0 +1,40 @@
+#version 330 core
+
+// ---------------------------------------------------------
+// 单次提交渲染阴影立方体贴图 6 个面的几何着色器
+// 顶点着色器输出世界空间位置；每个三角形只发射到与其相交的面 (gl_Layer 选择立方体贴图的面)
+// ---------------------------------------------------------
+
+layout(triangles) in;
+layout(triangle_strip, max_vertices = 18) out;
+
+#include "frame_data.glsl"
+
+out vec4 FragPos; // 世界空间位置 (传给片段着色器)
+
+// 三个顶点是否都在同一个裁剪平面之外 (此时三角形与该面的视锥不相交)
+bool outsideFrustum(vec4 c0, vec4 c1, vec4 c2) {
+    vec3 x = vec3(c0.x, c1.x, c2.x);
+    vec3 y = vec3(c0.y, c1.y, c2.y);
+    vec3 z = vec3(c0.z, c1.z, c2.z);
+    vec3 w = vec3(c0.w, c1.w, c2.w);
+    return all(lessThan(x, -w)) || all(greaterThan(x, w))
+        || all(lessThan(y, -w)) || all(greaterThan(y, w))
+        || all(lessThan(z, -w)) || all(greaterThan(z, w));
+}
+
+void main() {
+    for (int face = 0; face < 6; ++face) {
+        vec4 clip[3];
+        for (int i = 0; i < 3; ++i) clip[i] = shadowMatrices[face] * gl_in[i].gl_Position;
+        if (outsideFrustum(clip[0], clip[1], clip[2])) continue;
+
+        for (int i = 0; i < 3; ++i) {
+            gl_Layer = face;
+            FragPos = gl_in[i].gl_Position;
+            gl_Position = clip[i];
+            EmitVertex();
+        }
+        EndPrimitive();
+    }
+}
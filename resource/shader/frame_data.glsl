@@ -0,0 +1,11 @@
+// 每帧数据 (所有程序共享，std140 布局与 C++ 端 FrameUniforms 一致)
+layout(std140) uniform FrameData {
+    mat4 view;                // 视图矩阵
+    mat4 projection;          // 投影矩阵
+    mat4 shadowMatrices[6];   // 阴影立方体贴图各面的光空间矩阵
+    vec3 viewPos;             // 相机/观察者位置
+    float farPlane;           // 阴影投影的远平面距离
+    vec3 lightPos;            // 光源位置 (世界空间)
+    float outlineWidth;       // 描边宽度
+    vec3 lightColor;          // 光源颜色
+};
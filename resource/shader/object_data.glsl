@@ -0,0 +1,6 @@
+// 每个对象的数据 (法线矩阵在 CPU 上随模型矩阵更新)
+layout(std140) uniform ObjectData {
+    mat4 model;               // 模型矩阵
+    mat4 normalMatrix;        // 法线矩阵 (左上 3x3 有效)
+    vec3 objectColor;         // 物体基础颜色
+};
@@ -1,12 +1,27 @@
 #version 330 core
 
+// ---------------------------------------------------------
+// 变体宏 (由 ShaderVariants 注入，此处为缺省值)
+// HAS_TEXTURE: 1 采样漫反射纹理，0 使用 objectColor 作为基础色
+// OUTLINE:     1 背面挤出的片段输出黑色描边，0 不处理描边
+// PCF_SAMPLES: 阴影采样数 (见 shadow_pcf.glsl)
+// ---------------------------------------------------------
+#ifndef HAS_TEXTURE
+#define HAS_TEXTURE 1
+#endif
+#ifndef OUTLINE
+#define OUTLINE 1
+#endif
+
 // ---------------------------------------------------------
 // 输入变量 (来自顶点着色器)
 // ---------------------------------------------------------
 in vec3 FragPos;      // 片段在世界空间中的位置
 in vec3 Normal;       // 片段的世界空间法线
 in vec2 TexCoords;    // 纹理坐标
+#if OUTLINE
 in float vIsOutline;  // 描边标记 (1.0 表示是描边片段)
+#endif
 
 // ---------------------------------------------------------
 // 输出变量
@@ -16,35 +31,42 @@ out vec4 FragColor;   // 最终输出颜色
 // ---------------------------------------------------------
 // Uniform 变量
 // ---------------------------------------------------------
+#if HAS_TEXTURE
 uniform sampler2D texture1;    // 漫反射纹理
-uniform vec3 lightPos;         // 光源位置 (世界空间)
-uniform vec3 lightColor;       // 光源颜色
+#endif
 uniform samplerCube shadowMap; // 立方体阴影贴图 (用于点光源阴影)
-uniform float farPlane;        // 阴影投影的远平面距离 (用于深度归一化)
+
+#include "frame_data.glsl"
+#include "object_data.glsl"
+#include "shadow_pcf.glsl"
 
 void main() {
     // ---------------------------------------------------------
     // 1. 描边处理
     // ---------------------------------------------------------
+#if OUTLINE
     if (vIsOutline > 0.5) {
         // 如果是描边片段，直接输出纯黑色
         FragColor = vec4(0.0, 0.0, 0.0, 1.0);
         return;
     }
+#endif
 
     // ---------------------------------------------------------
     // 2. 基础数据准备
     // ---------------------------------------------------------
+#if HAS_TEXTURE
     vec4 texColor = texture(texture1, TexCoords);
+#else
+    vec4 texColor = vec4(objectColor, 1.0);
+#endif
     vec3 norm = normalize(Normal);
-    vec3 lightDir = lightPos - FragPos;
-    float distanceToLight = length(lightDir);
-    vec3 L = lightDir / distanceToLight; // 指向光源的单位向量
+    vec3 L = normalize(lightPos - FragPos); // 指向光源的单位向量
     
     // ---------------------------------------------------------
     // 3. 漫反射计算 (Lambertian)
     // ---------------------------------------------------------
-    float diff = max(dot(norm, L), 0.0); // 注意：这里使用了 -norm
+    float diff = max(dot(norm, L), 0.0);
 
     // ---------------------------------------------------------
     // 4. 环境光计算
@@ -52,39 +74,9 @@ void main() {
     vec3 ambient = 0.5 * lightColor * texColor.rgb;
 
     // ---------------------------------------------------------
-    // 5. 阴影计算 (PCF - Percentage Closer Filtering)
+    // 5. 阴影计算 (PCF)
     // ---------------------------------------------------------
-    float shadow = 0.0;
-    float bias = 0.05;       // 阴影偏移，防止阴影失真 (Shadow Acne)
-    int samples = 20;        // 采样次数
-    float viewDistance = length(lightPos - FragPos);
-    float diskRadius = 0.01; // 采样半径
-    vec3 fragToLight = FragPos - lightPos;
-    float currentDepth = length(fragToLight);
-    vec3 normFragToLight = normalize(fragToLight);
-    
-    // 采样偏移方向数组 (用于在球面上随机采样以柔化阴影边缘)
-    vec3 sampleOffsetDirections[20] = vec3[]
-    (
-       vec3( 1,  1,  1), vec3( 1, -1,  1), vec3(-1, -1,  1), vec3(-1,  1,  1), 
-       vec3( 1,  1, -1), vec3( 1, -1, -1), vec3(-1, -1, -1), vec3(-1,  1, -1),
-       vec3( 1,  1,  0), vec3( 1, -1,  0), vec3(-1, -1,  0), vec3(-1,  1,  0),
-       vec3( 1,  0,  1), vec3(-1,  0,  1), vec3( 1,  0, -1), vec3(-1,  0, -1),
-       vec3( 0,  1,  1), vec3( 0, -1,  1), vec3( 0, -1, -1), vec3( 0,  1, -1)
-    );
-
-    // 执行 PCF 采样
-    for(int i = 0; i < samples; ++i)
-    {
-        // 从阴影贴图中获取最近深度值
-        float closestDepth = texture(shadowMap, normFragToLight + sampleOffsetDirections[i] * diskRadius).r;
-        closestDepth *= farPlane; // 反归一化 [0,1] -> [0, farPlane]
-        
-        // 比较当前深度与最近深度
-        if(currentDepth - bias > closestDepth)
-            shadow += 1.0;
-    }
-    shadow /= float(samples); // 计算平均阴影值 [0, 1]
+    float shadow = shadowFactor(FragPos);
 
     // ---------------------------------------------------------
     // 6. 最终颜色合成
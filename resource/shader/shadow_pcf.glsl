@@ -0,0 +1,55 @@
+// ---------------------------------------------------------
+// 点光源立方体阴影 (PCF - Percentage Closer Filtering)
+// 需先包含 frame_data.glsl 并声明 samplerCube shadowMap
+// PCF_SAMPLES: 采样次数 (1 / 4 / 8 / 20)，由变体宏在编译期确定，循环可被完全展开
+// ---------------------------------------------------------
+#ifndef PCF_SAMPLES
+#define PCF_SAMPLES 20
+#endif
+
+const float kShadowBias = 0.05;    // 阴影偏移，防止阴影失真 (Shadow Acne)
+const float kDiskRadius = 0.01;    // 采样半径
+
+#if PCF_SAMPLES == 4
+// 正四面体的 4 个顶点方向
+const vec3 kSampleOffsets[4] = vec3[](
+   vec3( 1,  1,  1), vec3( 1, -1, -1), vec3(-1,  1, -1), vec3(-1, -1,  1)
+);
+#elif PCF_SAMPLES == 8
+// 立方体的 8 个角
+const vec3 kSampleOffsets[8] = vec3[](
+   vec3( 1,  1,  1), vec3( 1, -1,  1), vec3(-1, -1,  1), vec3(-1,  1,  1),
+   vec3( 1,  1, -1), vec3( 1, -1, -1), vec3(-1, -1, -1), vec3(-1,  1, -1)
+);
+#elif PCF_SAMPLES == 20
+// 立方体的 8 个角与 12 条棱的中点 (在球面上分散采样以柔化阴影边缘)
+const vec3 kSampleOffsets[20] = vec3[](
+   vec3( 1,  1,  1), vec3( 1, -1,  1), vec3(-1, -1,  1), vec3(-1,  1,  1),
+   vec3( 1,  1, -1), vec3( 1, -1, -1), vec3(-1, -1, -1), vec3(-1,  1, -1),
+   vec3( 1,  1,  0), vec3( 1, -1,  0), vec3(-1, -1,  0), vec3(-1,  1,  0),
+   vec3( 1,  0,  1), vec3(-1,  0,  1), vec3( 1,  0, -1), vec3(-1,  0, -1),
+   vec3( 0,  1,  1), vec3( 0, -1,  1), vec3( 0, -1, -1), vec3( 0,  1, -1)
+);
+#elif PCF_SAMPLES != 1
+#error PCF_SAMPLES must be 1, 4, 8 or 20
+#endif
+
+// 返回阴影系数 [0, 1] (1 表示完全处于阴影中)
+float shadowFactor(vec3 fragPos) {
+    vec3 fragToLight = fragPos - lightPos;
+    float currentDepth = length(fragToLight);
+    vec3 dir = fragToLight / currentDepth;
+#if PCF_SAMPLES == 1
+    float closestDepth = texture(shadowMap, dir).r * farPlane; // 反归一化 [0,1] -> [0, farPlane]
+    return currentDepth - kShadowBias > closestDepth ? 1.0 : 0.0;
+#else
+    float shadow = 0.0;
+    for (int i = 0; i < PCF_SAMPLES; ++i) {
+        // 从阴影贴图中获取最近深度值并与当前深度比较
+        float closestDepth = texture(shadowMap, dir + kSampleOffsets[i] * kDiskRadius).r * farPlane;
+        if (currentDepth - kShadowBias > closestDepth)
+            shadow += 1.0;
+    }
+    return shadow / float(PCF_SAMPLES); // 平均阴影值
+#endif
+}
@@ -1,29 +1,36 @@
 #version 330 core
+// 变体宏 OUTLINE: 1 背面顶点沿法线挤出作为描边，0 不挤出 (与片元着色器一致)
+#ifndef OUTLINE
+#define OUTLINE 1
+#endif
+
 // 顶点属性输入
 layout(location = 0) in vec3 aPos;       // 顶点位置
 layout(location = 1) in vec3 aNormal;    // 顶点法线
 layout(location = 2) in vec2 aTexCoords; // 纹理坐标
 
-// 全局 uniform 变量
-uniform mat4 model;         // 模型矩阵
-uniform mat4 view;          // 视图矩阵
-uniform mat4 projection;    // 投影矩阵
-uniform float outlineWidth; // 描边宽度 (通常在 0.02-0.05 之间)
-uniform vec3 viewPos;       // 相机/观察者位置
+#include "frame_data.glsl"
+#include "object_data.glsl"
+#include "vertex_decode.glsl"
 
 // 输出到片元着色器的变量
 out vec3 FragPos;   // 世界空间中的片元位置
 out vec3 Normal;    // 世界空间中的法线
 out vec2 TexCoords; // 纹理坐标
+#if OUTLINE
 out float vIsOutline; // 标记当前片元是否属于描边
+#endif
 
 void main() {
     // 1. 计算世界空间位置和法线
-    vec4 worldPos = model * vec4(aPos, 1.0);
-    // 法线矩阵：模型矩阵逆转置的左上 3x3 部分，用于正确变换非均匀缩放下的法线
-    mat3 normalMatrix = transpose(inverse(mat3(model)));
-    vec3 worldNormal = normalize(normalMatrix * aNormal);
+    vec3 localPos = aPos * posScale + posOffset;
+    vec3 localNormal = octNormals ? octDecode(aNormal.xy) : aNormal;
+    vec4 worldPos = model * vec4(localPos, 1.0);
+    // 法线矩阵：模型矩阵逆转置的左上 3x3 部分 (CPU 预计算)，用于正确变换非均匀缩放下的法线
+    vec3 worldNormal = normalize(mat3(normalMatrix) * localNormal);
     
+    vec4 finalPos = worldPos;
+#if OUTLINE
     // 2. 计算视线方向（世界空间）
     vec3 viewDir = normalize(viewPos - worldPos.xyz);
     
@@ -31,7 +38,6 @@ void main() {
     // 计算视线与法线的点积
     float ndotv = dot(worldNormal, viewDir);
     
-    vec4 finalPos = worldPos;
     vIsOutline = 0.0;
     
     // 如果法线朝向观察者
@@ -41,6 +47,7 @@ void main() {
         finalPos.xyz += worldNormal * outlineWidth;
         vIsOutline = 1.0;
     }
+#endif
     
     // 传递数据给片元着色器
     FragPos = finalPos.xyz;
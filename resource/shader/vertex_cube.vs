@@ -5,37 +5,42 @@
 // ---------------------------------------------------------
 layout(location = 0) in vec3 aPos;    // 顶点位置
 layout(location = 1) in vec3 aNormal; // 顶点法线
-layout(location = 2) in vec3 color;   // 顶点颜色
+layout(location = 2) in vec3 color;   // 顶点颜色 (未使用，颜色来自实例)
+
+// 实例属性 (每个立方体一份，见 CubeInstanceBuffer)
+layout(location = 3) in mat4 instanceModel;   // 模型矩阵
+layout(location = 7) in mat3 instanceNormal;  // 法线矩阵 (CPU 预计算)
+layout(location = 10) in vec3 instanceColor;  // 立方体颜色
 
 // ---------------------------------------------------------
 // Uniform 变量
 // ---------------------------------------------------------
-uniform mat4 model;      // 模型矩阵：局部 -> 世界
-uniform mat4 view;       // 视图矩阵：世界 -> 观察
-uniform mat4 projection; // 投影矩阵：观察 -> 裁剪
+#include "frame_data.glsl"
+#include "vertex_decode.glsl"
 
 // ---------------------------------------------------------
 // 输出变量 (传递给片段着色器)
 // ---------------------------------------------------------
 out vec3 FragPos;   // 片段的世界空间位置
 out vec3 Normal;    // 片段的世界空间法线
-out vec3 CubeColor; // 传递的颜色
+out vec3 CubeColor; // 实例颜色
 
 void main() {
     // 1. 计算世界空间位置
-    vec4 worldPos = model * vec4(aPos, 1.0);
+    vec3 localPos = aPos * posScale + posOffset;
+    vec3 localNormal = octNormals ? octDecode(aNormal.xy) : aNormal;
+    vec4 worldPos = instanceModel * vec4(localPos, 1.0);
     
-    // 2. 计算法线矩阵并变换法线
-    // 法线矩阵是模型矩阵左上角 3x3 部分的逆转置矩阵
+    // 2. 变换法线
+    // 法线矩阵是模型矩阵左上角 3x3 部分的逆转置矩阵 (CPU 预计算)
     // 用于正确处理非均匀缩放下的法线变换
-    mat3 normalMatrix = transpose(inverse(mat3(model)));
-    vec3 worldNormal = normalize(normalMatrix * aNormal);
+    vec3 worldNormal = normalize(instanceNormal * localNormal);
     
     // 3. 传递数据给片段着色器
     vec4 finalPos = worldPos;
     FragPos = finalPos.xyz;
     Normal = worldNormal;
-    CubeColor = color;
+    CubeColor = instanceColor;
     
     // 4. 计算最终裁剪空间坐标
     gl_Position = projection * view * finalPos;
@@ -0,0 +1,12 @@
+// 压缩顶点格式解码 (全精度格式时保持默认值即可)
+uniform vec3 posScale = vec3(1.0);  // 位置反量化缩放
+uniform vec3 posOffset = vec3(0.0); // 位置反量化偏移
+uniform bool octNormals = false;    // 法线是否为八面体编码 (2 x snorm16)
+
+// 八面体法线解码
+vec3 octDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
@@ -0,0 +1,445 @@
+#include "bvh.h"
+#include "frustum_cull.h"
+#include <algorithm>
+
+namespace {
+
+// 分桶 SAH 的桶数
+const int kSahBins = 16;
+
+double surfaceArea(const glm::vec3& lo, const glm::vec3& hi)
+{
+    const glm::vec3 d = glm::max(hi - lo, glm::vec3(0.0f));
+    return 2.0 * (double(d.x) * d.y + double(d.y) * d.z + double(d.z) * d.x);
+}
+
+// 重建时的对象
+struct BuildItem {
+    glm::vec3 lo, hi, centroid;
+    uint32_t object;
+};
+
+// 重建任务：为 items[begin, end) 创建节点，挂到 parent 的 slot 号子节点
+struct BuildTask {
+    uint32_t parent;
+    uint32_t slot;
+    uint32_t begin, end;
+};
+
+} // namespace
+
+bool aabb_sphere_overlap(const glm::vec3& lo, const glm::vec3& hi, const glm::vec3& center, float radius)
+{
+    const glm::vec3 d = center - glm::clamp(center, lo, hi);
+    return glm::dot(d, d) <= radius * radius;
+}
+
+bool aabb_ray_overlap(const glm::vec3& lo, const glm::vec3& hi, const glm::vec3& origin, const glm::vec3& invDir, float maxT,
+                      float* enterT)
+{
+    const glm::vec3 t1 = (lo - origin) * invDir;
+    const glm::vec3 t2 = (hi - origin) * invDir;
+    const glm::vec3 tNear = glm::min(t1, t2), tFar = glm::max(t1, t2);
+    const float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    const float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxT));
+    if (enter > exit) return false;
+    if (enterT) *enterT = enter;
+    return true;
+}
+
+uint32_t Bvh::allocNode()
+{
+    if (!freeNodes_.empty()) {
+        const uint32_t node = freeNodes_.back();
+        freeNodes_.pop_back();
+        nodes_[node] = Node{};
+        return node;
+    }
+    nodes_.push_back(Node{});
+    return uint32_t(nodes_.size() - 1);
+}
+
+void Bvh::freeNode(uint32_t node)
+{
+    if (!nodes_[node].leaf()) internalArea_ -= surfaceArea(nodes_[node].lo, nodes_[node].hi);
+    nodes_[node] = Node{};
+    freeNodes_.push_back(node);
+}
+
+void Bvh::setBounds(uint32_t node, const glm::vec3& lo, const glm::vec3& hi)
+{
+    Node& n = nodes_[node];
+    if (!n.leaf()) internalArea_ += surfaceArea(lo, hi) - surfaceArea(n.lo, n.hi);
+    n.lo = lo;
+    n.hi = hi;
+}
+
+bool Bvh::refitNode(uint32_t node)
+{
+    const Node& a = nodes_[nodes_[node].child[0]];
+    const Node& b = nodes_[nodes_[node].child[1]];
+    const glm::vec3 lo = glm::min(a.lo, b.lo), hi = glm::max(a.hi, b.hi);
+    if (lo == nodes_[node].lo && hi == nodes_[node].hi) return false;
+    setBounds(node, lo, hi);
+    return true;
+}
+
+double Bvh::sahCost() const
+{
+    if (root_ == kNull || nodes_[root_].leaf()) return 0.0;
+    const double rootArea = surfaceArea(nodes_[root_].lo, nodes_[root_].hi);
+    return rootArea > 0.0 ? internalArea_ / rootArea : 0.0;
+}
+
+// 更新对象
+// 新对象的叶子在 maintain 时插入；已有对象只更新叶子包围盒，祖先节点在 maintain 时重新拟合
+void Bvh::set(uint32_t object, const glm::vec3& lo, const glm::vec3& hi)
+{
+    if (object >= objectLeaf_.size()) objectLeaf_.resize(object + 1, kNull);
+    uint32_t leaf = objectLeaf_[object];
+    if (leaf == kNull) {
+        leaf = allocNode();
+        nodes_[leaf].object = object;
+        nodes_[leaf].lo = lo;
+        nodes_[leaf].hi = hi;
+        objectLeaf_[object] = leaf;
+        ++objectCount_;
+        ++updatesSinceBuild_;
+        pendingLeaves_.push_back(leaf);
+        return;
+    }
+    Node& n = nodes_[leaf];
+    if (n.lo == lo && n.hi == hi) return;
+    n.lo = lo;
+    n.hi = hi;
+    dirtyLeaves_.push_back(leaf);
+    ++updatesSinceBuild_;
+}
+
+void Bvh::remove(uint32_t object)
+{
+    if (!contains(object)) return;
+    const uint32_t leaf = objectLeaf_[object];
+    if (inTree(leaf)) removeLeaf(leaf);
+    freeNode(leaf);
+    objectLeaf_[object] = kNull;
+    --objectCount_;
+    ++updatesSinceBuild_;
+}
+
+void Bvh::clear()
+{
+    nodes_.clear();
+    freeNodes_.clear();
+    objectLeaf_.clear();
+    dirtyLeaves_.clear();
+    pendingLeaves_.clear();
+    root_ = kNull;
+    objectCount_ = 0;
+    updatesSinceBuild_ = 0;
+    internalArea_ = 0.0;
+    builtCost_ = 0.0;
+}
+
+// 插入叶子
+// 从根向下选择兄弟节点：停在当前节点的代价 (新父节点的面积) 低于进入任一子节点的代价时停止，
+// 进入子节点的代价包括祖先因包住新叶子而增加的面积
+void Bvh::insertLeaf(uint32_t leaf)
+{
+    if (root_ == kNull) {
+        root_ = leaf;
+        nodes_[leaf].parent = kNull;
+        return;
+    }
+    const glm::vec3 lo = nodes_[leaf].lo, hi = nodes_[leaf].hi;
+    uint32_t index = root_;
+    while (!nodes_[index].leaf()) {
+        const Node& n = nodes_[index];
+        const double area = surfaceArea(n.lo, n.hi);
+        const double combined = surfaceArea(glm::min(n.lo, lo), glm::max(n.hi, hi));
+        const double cost = 2.0 * combined;
+        const double inherit = 2.0 * (combined - area);
+        double childCost[2];
+        for (int c = 0; c < 2; ++c) {
+            const Node& child = nodes_[n.child[c]];
+            const double enlarged = surfaceArea(glm::min(child.lo, lo), glm::max(child.hi, hi));
+            childCost[c] = (child.leaf() ? enlarged : enlarged - surfaceArea(child.lo, child.hi)) + inherit;
+        }
+        if (cost < childCost[0] && cost < childCost[1]) break;
+        index = childCost[0] <= childCost[1] ? n.child[0] : n.child[1];
+    }
+
+    const uint32_t sibling = index;
+    const uint32_t oldParent = nodes_[sibling].parent;
+    const uint32_t parent = allocNode();
+    nodes_[parent].parent = oldParent;
+    nodes_[parent].child[0] = sibling;
+    nodes_[parent].child[1] = leaf;
+    setBounds(parent, glm::min(nodes_[sibling].lo, lo), glm::max(nodes_[sibling].hi, hi));
+    nodes_[sibling].parent = parent;
+    nodes_[leaf].parent = parent;
+    if (oldParent == kNull) {
+        root_ = parent;
+    } else {
+        Node& op = nodes_[oldParent];
+        op.child[op.child[0] == sibling ? 0 : 1] = parent;
+    }
+    for (uint32_t n = oldParent; n != kNull; n = nodes_[n].parent) refitNode(n);
+}
+
+// 移除叶子：兄弟节点替代父节点，父节点释放
+void Bvh::removeLeaf(uint32_t leaf)
+{
+    if (leaf == root_) {
+        root_ = kNull;
+        return;
+    }
+    const uint32_t parent = nodes_[leaf].parent;
+    const uint32_t grand = nodes_[parent].parent;
+    const uint32_t sibling = nodes_[parent].child[nodes_[parent].child[0] == leaf ? 1 : 0];
+    nodes_[sibling].parent = grand;
+    if (grand == kNull) {
+        root_ = sibling;
+    } else {
+        Node& g = nodes_[grand];
+        g.child[g.child[0] == parent ? 0 : 1] = sibling;
+    }
+    freeNode(parent);
+    for (uint32_t n = grand; n != kNull; n = nodes_[n].parent) {
+        if (!refitNode(n)) break;
+    }
+}
+
+// 维护
+// 1. 变化的叶子沿父节点向上重新拟合，祖先包围盒不变时提前结束
+// 2. 新叶子超过对象数的 1/4 时直接重建 (如首次填充)，否则逐个插入
+//    (等待插入期间被移除又被复用的节点可能在列表中出现多次，已在树中的跳过)
+// 3. SAH 代价相对重建时增长超过 kRebuildRatio 倍，或累计更新数超过对象数时整体重建
+void Bvh::maintain()
+{
+    for (uint32_t leaf : dirtyLeaves_) {
+        for (uint32_t n = nodes_[leaf].parent; n != kNull; n = nodes_[n].parent) {
+            if (!refitNode(n)) break;
+        }
+        ++refits_;
+    }
+    dirtyLeaves_.clear();
+    if (pendingLeaves_.size() * 4 > objectCount_) {
+        rebuild();
+        return;
+    }
+    for (uint32_t leaf : pendingLeaves_) {
+        if (nodes_[leaf].leaf() && !inTree(leaf)) insertLeaf(leaf);
+    }
+    pendingLeaves_.clear();
+    if (objectCount_ < 2) return;
+    if (updatesSinceBuild_ > objectCount_ || sahCost() > builtCost_ * kRebuildRatio) rebuild();
+}
+
+// 分桶 SAH 重建
+// 每个节点沿质心范围最大的轴分为 kSahBins 个桶，选择 "左面积 × 左数量 + 右面积 × 右数量" 最小的划分；
+// 质心重合或划分退化时按中位数对半分。使用显式任务栈，不受树深度限制
+void Bvh::rebuild()
+{
+    std::vector<BuildItem> items;
+    items.reserve(objectCount_);
+    for (uint32_t object = 0; object < objectLeaf_.size(); ++object) {
+        const uint32_t leaf = objectLeaf_[object];
+        if (leaf == kNull) continue;
+        const Node& n = nodes_[leaf];
+        items.push_back(BuildItem{ n.lo, n.hi, (n.lo + n.hi) * 0.5f, object });
+    }
+    nodes_.clear();
+    freeNodes_.clear();
+    dirtyLeaves_.clear();
+    pendingLeaves_.clear();
+    root_ = kNull;
+    internalArea_ = 0.0;
+    updatesSinceBuild_ = 0;
+    ++rebuilds_;
+    if (items.empty()) {
+        builtCost_ = 0.0;
+        return;
+    }
+    nodes_.reserve(items.size() * 2);
+
+    std::vector<BuildTask> tasks;
+    tasks.push_back(BuildTask{ kNull, 0, 0, uint32_t(items.size()) });
+    while (!tasks.empty()) {
+        const BuildTask t = tasks.back();
+        tasks.pop_back();
+        const uint32_t node = allocNode();
+        nodes_[node].parent = t.parent;
+        if (t.parent == kNull) root_ = node;
+        else nodes_[t.parent].child[t.slot] = node;
+
+        if (t.end - t.begin == 1) {
+            const BuildItem& item = items[t.begin];
+            nodes_[node].object = item.object;
+            nodes_[node].lo = item.lo;
+            nodes_[node].hi = item.hi;
+            objectLeaf_[item.object] = node;
+            continue;
+        }
+
+        glm::vec3 lo = items[t.begin].lo, hi = items[t.begin].hi;
+        glm::vec3 cmin = items[t.begin].centroid, cmax = cmin;
+        for (uint32_t i = t.begin + 1; i < t.end; ++i) {
+            lo = glm::min(lo, items[i].lo);
+            hi = glm::max(hi, items[i].hi);
+            cmin = glm::min(cmin, items[i].centroid);
+            cmax = glm::max(cmax, items[i].centroid);
+        }
+        setBounds(node, lo, hi);
+
+        const glm::vec3 extent = cmax - cmin;
+        const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+        uint32_t mid = t.begin;
+        if (extent[axis] > 0.0f) {
+            const float scale = kSahBins / extent[axis];
+            auto binOf = [&](const BuildItem& item) {
+                return std::min(kSahBins - 1, int((item.centroid[axis] - cmin[axis]) * scale));
+            };
+            uint32_t count[kSahBins] = {};
+            glm::vec3 binLo[kSahBins], binHi[kSahBins];
+            for (uint32_t i = t.begin; i < t.end; ++i) {
+                const int b = binOf(items[i]);
+                binLo[b] = count[b] ? glm::min(binLo[b], items[i].lo) : items[i].lo;
+                binHi[b] = count[b] ? glm::max(binHi[b], items[i].hi) : items[i].hi;
+                ++count[b];
+            }
+            // 从右向左累计右侧的面积与数量，再从左向右求每个划分的代价
+            double rightArea[kSahBins] = {};
+            uint32_t rightCount[kSahBins] = {};
+            glm::vec3 accLo(0.0f), accHi(0.0f);
+            uint32_t acc = 0;
+            for (int b = kSahBins - 1; b > 0; --b) {
+                if (count[b]) {
+                    accLo = acc ? glm::min(accLo, binLo[b]) : binLo[b];
+                    accHi = acc ? glm::max(accHi, binHi[b]) : binHi[b];
+                    acc += count[b];
+                }
+                rightArea[b] = acc ? surfaceArea(accLo, accHi) : 0.0;
+                rightCount[b] = acc;
+            }
+            int best = -1;
+            double bestCost = 0.0;
+            acc = 0;
+            for (int b = 0; b < kSahBins - 1; ++b) {
+                if (count[b]) {
+                    accLo = acc ? glm::min(accLo, binLo[b]) : binLo[b];
+                    accHi = acc ? glm::max(accHi, binHi[b]) : binHi[b];
+                    acc += count[b];
+                }
+                if (acc == 0 || rightCount[b + 1] == 0) continue;
+                const double cost = surfaceArea(accLo, accHi) * acc + rightArea[b + 1] * rightCount[b + 1];
+                if (best < 0 || cost < bestCost) {
+                    best = b;
+                    bestCost = cost;
+                }
+            }
+            if (best >= 0) {
+                mid = uint32_t(std::partition(items.begin() + t.begin, items.begin() + t.end,
+                                              [&](const BuildItem& item) { return binOf(item) <= best; }) - items.begin());
+            }
+        }
+        if (mid == t.begin || mid == t.end) {
+            mid = t.begin + (t.end - t.begin) / 2;
+            std::nth_element(items.begin() + t.begin, items.begin() + mid, items.begin() + t.end,
+                             [axis](const BuildItem& a, const BuildItem& b) { return a.centroid[axis] < b.centroid[axis]; });
+        }
+        tasks.push_back(BuildTask{ node, 0, t.begin, mid });
+        tasks.push_back(BuildTask{ node, 1, mid, t.end });
+    }
+    builtCost_ = sahCost();
+}
+
+// 视锥查询
+// 栈中记录每个节点仍需测试的平面；节点对某个平面完全位于内侧时，其子树不再测试该平面
+size_t Bvh::queryFrustum(const Frustum& frustum, std::vector<uint32_t>& out) const
+{
+    if (root_ == kNull) return 0;
+    size_t visited = 0;
+    stack_.clear();
+    stack_.push_back(uint64_t(root_) | (uint64_t(0x3F) << 32));
+    while (!stack_.empty()) {
+        const uint64_t entry = stack_.back();
+        stack_.pop_back();
+        const Node& n = nodes_[uint32_t(entry)];
+        uint32_t mask = uint32_t(entry >> 32);
+        ++visited;
+        if (mask) {
+            const glm::vec3 c = (n.lo + n.hi) * 0.5f, e = (n.hi - n.lo) * 0.5f;
+            bool outside = false;
+            for (int p = 0; p < 6; ++p) {
+                if (!(mask & (1u << p))) continue;
+                const glm::vec4& plane = frustum.planes[p];
+                if (aabb_plane_reach(plane, c, e) < 0.0f) { outside = true; break; }
+                const float r = std::abs(plane.x) * e.x + std::abs(plane.y) * e.y + std::abs(plane.z) * e.z;
+                if (glm::dot(glm::vec3(plane), c) + plane.w - r >= 0.0f) mask &= ~(1u << p);
+            }
+            if (outside) continue;
+        }
+        if (n.leaf()) {
+            out.push_back(n.object);
+            continue;
+        }
+        stack_.push_back(uint64_t(n.child[0]) | (uint64_t(mask) << 32));
+        stack_.push_back(uint64_t(n.child[1]) | (uint64_t(mask) << 32));
+    }
+    return visited;
+}
+
+size_t Bvh::querySphere(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const
+{
+    if (root_ == kNull) return 0;
+    size_t visited = 0;
+    stack_.clear();
+    stack_.push_back(root_);
+    while (!stack_.empty()) {
+        const Node& n = nodes_[uint32_t(stack_.back())];
+        stack_.pop_back();
+        ++visited;
+        if (!aabb_sphere_overlap(n.lo, n.hi, center, radius)) continue;
+        if (n.leaf()) {
+            out.push_back(n.object);
+            continue;
+        }
+        stack_.push_back(n.child[0]);
+        stack_.push_back(n.child[1]);
+    }
+    return visited;
+}
+
+size_t Bvh::queryRay(const glm::vec3& origin, const glm::vec3& dir, float maxT, std::vector<uint32_t>& out) const
+{
+    if (root_ == kNull) return 0;
+    const glm::vec3 invDir = 1.0f / dir;
+    size_t visited = 0;
+    stack_.clear();
+    stack_.push_back(root_);
+    while (!stack_.empty()) {
+        const Node& n = nodes_[uint32_t(stack_.back())];
+        stack_.pop_back();
+        ++visited;
+        if (!aabb_ray_overlap(n.lo, n.hi, origin, invDir, maxT)) continue;
+        if (n.leaf()) {
+            out.push_back(n.object);
+            continue;
+        }
+        stack_.push_back(n.child[0]);
+        stack_.push_back(n.child[1]);
+    }
+    return visited;
+}
+
+BvhStats Bvh::stats() const
+{
+    BvhStats s;
+    s.objects = objectCount_;
+    s.nodes = nodes_.size() - freeNodes_.size();
+    s.rebuilds = rebuilds_;
+    s.refits = refits_;
+    s.sahRatio = builtCost_ > 0.0 ? float(sahCost() / builtCost_) : 1.0f;
+    return s;
+}
@@ -0,0 +1,58 @@
+#include "cluster_culling.h"
+#include <cmath>
+
+// 提取视锥平面
+// GLM 矩阵按列存储，clip 的第 i 行为 (clip[0][i], clip[1][i], clip[2][i], clip[3][i])
+// OpenGL 裁剪空间满足 -w <= x, y, z <= w，各平面为第 4 行加减对应行
+Frustum Frustum::fromMatrix(const glm::mat4& clip)
+{
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; ++i) rows[i] = glm::vec4(clip[0][i], clip[1][i], clip[2][i], clip[3][i]);
+
+    Frustum f;
+    f.planes[0] = rows[3] + rows[0];
+    f.planes[1] = rows[3] - rows[0];
+    f.planes[2] = rows[3] + rows[1];
+    f.planes[3] = rows[3] - rows[1];
+    f.planes[4] = rows[3] + rows[2];
+    f.planes[5] = rows[3] - rows[2];
+    for (glm::vec4& p : f.planes) {
+        float len = glm::length(glm::vec3(p));
+        if (len > 0.0f) p /= len;
+    }
+    return f;
+}
+
+bool Frustum::intersectsSphere(const glm::vec3& center, float radius) const
+{
+    for (const glm::vec4& p : planes) {
+        if (glm::dot(glm::vec3(p), center) + p.w < -radius) return false;
+    }
+    return true;
+}
+
+// 背面判断：视点到簇中心的方向与锥轴夹角足够小 (考虑包围球半径) 时，簇内所有三角形均背向视点
+bool cluster_backfacing(const Meshlet& m, const glm::vec3& eye)
+{
+    glm::vec3 d = m.center - eye;
+    return glm::dot(d, m.coneAxis) >= m.coneCutoff * glm::length(d) + m.radius;
+}
+
+void cluster_cull_mesh(const std::vector<Meshlet>& meshlets, const unsigned int* indices, const Frustum& frustum,
+                       const glm::vec3& eye, bool backface, std::vector<uint32_t>& out, ClusterCullStats& stats)
+{
+    for (const Meshlet& m : meshlets) {
+        ++stats.clusters;
+        if (!frustum.intersectsSphere(m.center, m.radius)) {
+            ++stats.frustumCulled;
+            continue;
+        }
+        if (backface && cluster_backfacing(m, eye)) {
+            ++stats.backfaceCulled;
+            continue;
+        }
+        const unsigned int* src = indices + m.indexOffset;
+        out.insert(out.end(), src, src + size_t(m.triangleCount) * 3);
+        stats.triangles += m.triangleCount;
+    }
+}
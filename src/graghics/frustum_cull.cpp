@@ -0,0 +1,149 @@
+#include "frustum_cull.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define FRUSTUM_CULL_SSE 1
+#endif
+
+namespace {
+
+// 并行剔除时每个任务处理的包围盒数 (4 的倍数)
+const size_t kCullChunk = 4096;
+
+// 标量测试 [begin, end)
+size_t cullScalar(const Frustum& f, const AabbSoA& b, uint8_t* visible, size_t begin, size_t end)
+{
+    size_t count = 0;
+    for (size_t i = begin; i < end; ++i) {
+        bool inside = true;
+        const glm::vec3 c(b.cx[i], b.cy[i], b.cz[i]), e(b.ex[i], b.ey[i], b.ez[i]);
+        for (const glm::vec4& p : f.planes) {
+            if (aabb_plane_reach(p, c, e) < 0.0f) { inside = false; break; }
+        }
+        visible[i] = inside ? 1 : 0;
+        count += inside;
+    }
+    return count;
+}
+
+#ifdef FRUSTUM_CULL_SSE
+// SSE 测试 [begin, end)，begin 为 4 的倍数；存储已补齐，末尾不足 4 个时只写回有效项
+// 每个平面：d = n · c + w + |n| · e，4 个包围盒全部在某个平面外侧时提前结束
+size_t cullSse(const Frustum& f, const AabbSoA& b, uint8_t* visible, size_t begin, size_t end)
+{
+    __m128 nx[6], ny[6], nz[6], nw[6], ax[6], ay[6], az[6];
+    for (int p = 0; p < 6; ++p) {
+        const glm::vec4& pl = f.planes[p];
+        nx[p] = _mm_set1_ps(pl.x);
+        ny[p] = _mm_set1_ps(pl.y);
+        nz[p] = _mm_set1_ps(pl.z);
+        nw[p] = _mm_set1_ps(pl.w);
+        ax[p] = _mm_set1_ps(std::abs(pl.x));
+        ay[p] = _mm_set1_ps(std::abs(pl.y));
+        az[p] = _mm_set1_ps(std::abs(pl.z));
+    }
+    const __m128 zero = _mm_setzero_ps();
+    size_t count = 0;
+    for (size_t i = begin; i < end; i += 4) {
+        const __m128 cx = _mm_loadu_ps(&b.cx[i]), cy = _mm_loadu_ps(&b.cy[i]), cz = _mm_loadu_ps(&b.cz[i]);
+        const __m128 ex = _mm_loadu_ps(&b.ex[i]), ey = _mm_loadu_ps(&b.ey[i]), ez = _mm_loadu_ps(&b.ez[i]);
+        int mask = 0xF;
+        for (int p = 0; p < 6 && mask; ++p) {
+            __m128 d = _mm_add_ps(_mm_mul_ps(nx[p], cx), nw[p]);
+            d = _mm_add_ps(d, _mm_mul_ps(ny[p], cy));
+            d = _mm_add_ps(d, _mm_mul_ps(nz[p], cz));
+            d = _mm_add_ps(d, _mm_mul_ps(ax[p], ex));
+            d = _mm_add_ps(d, _mm_mul_ps(ay[p], ey));
+            d = _mm_add_ps(d, _mm_mul_ps(az[p], ez));
+            mask &= _mm_movemask_ps(_mm_cmpge_ps(d, zero));
+        }
+        const size_t n = std::min<size_t>(4, end - i);
+        for (size_t k = 0; k < n; ++k) {
+            const uint8_t v = uint8_t((mask >> k) & 1);
+            visible[i + k] = v;
+            count += v;
+        }
+    }
+    return count;
+}
+#endif
+
+size_t cullRange(const Frustum& f, const AabbSoA& b, uint8_t* visible, size_t begin, size_t end)
+{
+#ifdef FRUSTUM_CULL_SSE
+    return cullSse(f, b, visible, begin, end);
+#else
+    return cullScalar(f, b, visible, begin, end);
+#endif
+}
+
+} // namespace
+
+void AabbSoA::resize(size_t count)
+{
+    const size_t padded = (count + 3) & ~size_t(3);
+    cx.resize(padded, 0.0f);
+    cy.resize(padded, 0.0f);
+    cz.resize(padded, 0.0f);
+    ex.resize(padded, 0.0f);
+    ey.resize(padded, 0.0f);
+    ez.resize(padded, 0.0f);
+    count_ = count;
+}
+
+void AabbSoA::set(size_t index, const glm::vec3& center, const glm::vec3& extent)
+{
+    cx[index] = center.x;
+    cy[index] = center.y;
+    cz[index] = center.z;
+    ex[index] = extent.x;
+    ey[index] = extent.y;
+    ez[index] = extent.z;
+}
+
+// 批量变换：逐分量的乘加，编译器可自动向量化
+void aabb_transform_all(const glm::mat4& m, const AabbSoA& in, AabbSoA& out)
+{
+    out.resize(in.size());
+    const size_t n = in.cx.size();
+    const glm::vec3 c0(m[0]), c1(m[1]), c2(m[2]), t(m[3]);
+    const glm::vec3 a0 = glm::abs(c0), a1 = glm::abs(c1), a2 = glm::abs(c2);
+    for (size_t i = 0; i < n; ++i) {
+        const float x = in.cx[i], y = in.cy[i], z = in.cz[i];
+        const float ex = in.ex[i], ey = in.ey[i], ez = in.ez[i];
+        out.cx[i] = c0.x * x + c1.x * y + c2.x * z + t.x;
+        out.cy[i] = c0.y * x + c1.y * y + c2.y * z + t.y;
+        out.cz[i] = c0.z * x + c1.z * y + c2.z * z + t.z;
+        out.ex[i] = a0.x * ex + a1.x * ey + a2.x * ez;
+        out.ey[i] = a0.y * ex + a1.y * ey + a2.y * ez;
+        out.ez[i] = a0.z * ex + a1.z * ey + a2.z * ez;
+    }
+}
+
+size_t frustum_cull_aabbs(const Frustum& frustum, const AabbSoA& boxes, std::vector<uint8_t>& visible, ThreadPool* pool)
+{
+    const size_t n = boxes.size();
+    visible.resize(n);
+    if (n == 0) return 0;
+    if (!pool || n < kParallelCullMin || pool->threadCount() == 0) return cullRange(frustum, boxes, visible.data(), 0, n);
+
+    // 分块并行，各块写入互不重叠的区间
+    std::atomic<size_t> count{0};
+    const size_t chunks = (n + kCullChunk - 1) / kCullChunk;
+    pool->parallelFor(chunks, [&](size_t c) {
+        const size_t begin = c * kCullChunk;
+        const size_t end = std::min(n, begin + kCullChunk);
+        count += cullRange(frustum, boxes, visible.data(), begin, end);
+    });
+    return count;
+}
+
+size_t frustum_cull_aabbs_scalar(const Frustum& frustum, const AabbSoA& boxes, std::vector<uint8_t>& visible)
+{
+    visible.resize(boxes.size());
+    return cullScalar(frustum, boxes, visible.data(), 0, boxes.size());
+}
@@ -0,0 +1,224 @@
+#include "geometry_pool.h"
+#include "mesh.h"
+#include "cube.h"
+#include "gl_state.h"
+#include <algorithm>
+
+FreeListAllocator::FreeListAllocator(uint32_t capacity)
+    : capacity_(0)
+    , used_(0) {
+    grow(capacity);
+}
+
+bool FreeListAllocator::allocate(uint32_t size, uint32_t& outOffset) {
+    if (size == 0) return false;
+    for (auto it = free_.begin(); it != free_.end(); ++it) {
+        if (it->second < size) continue;
+        outOffset = it->first;
+        uint32_t remain = it->second - size;
+        free_.erase(it);
+        if (remain > 0) free_[outOffset + size] = remain;
+        used_ += size;
+        return true;
+    }
+    return false;
+}
+
+void FreeListAllocator::free(uint32_t offset, uint32_t size) {
+    if (size == 0) return;
+    used_ -= size;
+    auto next = free_.lower_bound(offset);
+    // 与后一个空闲块合并
+    if (next != free_.end() && offset + size == next->first) {
+        size += next->second;
+        next = free_.erase(next);
+    }
+    // 与前一个空闲块合并
+    if (next != free_.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            prev->second += size;
+            return;
+        }
+    }
+    free_[offset] = size;
+}
+
+void FreeListAllocator::grow(uint32_t newCapacity) {
+    if (newCapacity <= capacity_) return;
+    uint32_t oldCapacity = capacity_;
+    capacity_ = newCapacity;
+    used_ += newCapacity - oldCapacity; // free() 会扣回
+    free(oldCapacity, newCapacity - oldCapacity);
+}
+
+uint32_t FreeListAllocator::largestFree() const {
+    uint32_t largest = 0;
+    for (const auto& f : free_) largest = std::max(largest, f.second);
+    return largest;
+}
+
+GeometryPool::GeometryPool(VertexFormat format, bool cubeLayout, uint32_t vertexCapacity, uint32_t indexCapacity)
+    : format_(format)
+    , cubeLayout_(cubeLayout)
+    , indexType_(format == VertexFormat::Packed ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT)
+    , vao_(0), vbo_(0), ebo_(0)
+    , streamVao_(0), streamEbo_(0)
+    , streamCapacity_(0)
+    , vertexSpace_(vertexCapacity)
+    , indexSpace_(indexCapacity)
+    , allocations_(0) {
+    if (format == VertexFormat::Packed) {
+        vertexStride_ = cubeLayout ? sizeof(PackedVertexCube) : sizeof(PackedVertex);
+    } else {
+        vertexStride_ = cubeLayout ? sizeof(VertexCube) : sizeof(Vertex);
+    }
+    indexSize_ = indexType_ == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+
+    glGenVertexArrays(1, &vao_);
+    glGenVertexArrays(1, &streamVao_);
+    glGenBuffers(1, &vbo_);
+    glGenBuffers(1, &ebo_);
+    glGenBuffers(1, &streamEbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferData(GL_ARRAY_BUFFER, vertexStride_ * vertexCapacity, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo_);
+    glBufferData(GL_COPY_WRITE_BUFFER, indexSize_ * indexCapacity, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    setupVao();
+}
+
+GeometryPool::~GeometryPool() {
+    if (vao_) {
+        GLState::shared().forgetVertexArray(vao_);
+        glDeleteVertexArrays(1, &vao_);
+    }
+    if (vbo_) glDeleteBuffers(1, &vbo_);
+    if (ebo_) glDeleteBuffers(1, &ebo_);
+    if (streamVao_) {
+        GLState::shared().forgetVertexArray(streamVao_);
+        glDeleteVertexArrays(1, &streamVao_);
+    }
+    if (streamEbo_) glDeleteBuffers(1, &streamEbo_);
+}
+
+bool GeometryPool::accepts(size_t vertexCount) const {
+    return vertexCount > 0 && (indexType_ == GL_UNSIGNED_INT || vertexCount < 65536);
+}
+
+// 配置 VAO：索引缓冲区绑定属于 VAO 状态
+// 主 VAO 与流式 VAO 使用同一顶点缓冲区，只有索引缓冲区不同
+void GeometryPool::setupVao() {
+    GLState& gl = GLState::shared();
+    gl.bindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+    setupVertexAttributes(format_, cubeLayout_);
+    gl.bindVertexArray(streamVao_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, streamEbo_);
+    setupVertexAttributes(format_, cubeLayout_);
+    gl.bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// 扩容缓冲区
+// 新建缓冲区后在 GPU 端拷贝旧数据，无需回读
+void GeometryPool::growBuffer(GLuint& buffer, size_t oldBytes, size_t newBytes) {
+    GLuint grown = 0;
+    glGenBuffers(1, &grown);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(newBytes), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    if (oldBytes > 0) glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(oldBytes));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+    buffer = grown;
+}
+
+GeometryAllocation GeometryPool::add(const void* vertices, uint32_t vertexCount, const void* indices, uint32_t indexCount) {
+    GeometryAllocation alloc;
+    if (!accepts(vertexCount) || indexCount == 0) return alloc;
+
+    // 1. 分配区间，空间不足时扩容
+    bool regrown = false;
+    while (!vertexSpace_.allocate(vertexCount, alloc.vertexOffset)) {
+        uint32_t oldCap = vertexSpace_.capacity();
+        uint32_t newCap = std::max(oldCap * 2, oldCap + vertexCount);
+        growBuffer(vbo_, vertexStride_ * oldCap, vertexStride_ * newCap);
+        vertexSpace_.grow(newCap);
+        regrown = true;
+    }
+    while (!indexSpace_.allocate(indexCount, alloc.indexOffset)) {
+        uint32_t oldCap = indexSpace_.capacity();
+        uint32_t newCap = std::max(oldCap * 2, oldCap + indexCount);
+        growBuffer(ebo_, indexSize_ * oldCap, indexSize_ * newCap);
+        indexSpace_.grow(newCap);
+        regrown = true;
+    }
+    if (regrown) setupVao();
+    alloc.vertexCount = vertexCount;
+    alloc.indexCount = indexCount;
+
+    // 2. 上传数据 (索引缓冲区通过拷贝目标绑定点写入，不影响当前 VAO)
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(vertexStride_ * alloc.vertexOffset),
+                    static_cast<GLsizeiptr>(vertexStride_ * vertexCount), vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo_);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(indexSize_ * alloc.indexOffset),
+                    static_cast<GLsizeiptr>(indexSize_ * indexCount), indices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    ++allocations_;
+    return alloc;
+}
+
+void GeometryPool::remove(const GeometryAllocation& alloc) {
+    if (!alloc.valid()) return;
+    vertexSpace_.free(alloc.vertexOffset, alloc.vertexCount);
+    indexSpace_.free(alloc.indexOffset, alloc.indexCount);
+    --allocations_;
+}
+
+void GeometryPool::bind() const {
+    GLState::shared().bindVertexArray(vao_);
+}
+
+void GeometryPool::draw(const GeometryAllocation& alloc) const {
+    draw(alloc, 0, alloc.indexCount);
+}
+
+void GeometryPool::draw(const GeometryAllocation& alloc, uint32_t firstIndex, uint32_t indexCount) const {
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(indexCount), indexType_,
+                             reinterpret_cast<void*>(indexSize_ * (size_t(alloc.indexOffset) + firstIndex)),
+                             static_cast<GLint>(alloc.vertexOffset));
+}
+
+void GeometryPool::drawInstanced(const GeometryAllocation& alloc, uint32_t instanceCount) const {
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(alloc.indexCount), indexType_,
+                                      reinterpret_cast<void*>(indexSize_ * size_t(alloc.indexOffset)),
+                                      static_cast<GLsizei>(instanceCount), static_cast<GLint>(alloc.vertexOffset));
+}
+
+// 上传索引流
+// 容量不足时按倍数扩大；每次先以空指针重新指定存储 (orphan)，驱动为仍在读取旧数据的绘制保留原存储
+void GeometryPool::uploadStream(const void* indices, size_t indexCount) {
+    if (indexCount == 0) return;
+    if (indexCount > streamCapacity_) streamCapacity_ = std::max(indexCount, streamCapacity_ * 2);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, streamEbo_);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(indexSize_ * streamCapacity_), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(indexSize_ * indexCount), indices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void GeometryPool::bindStream() const {
+    GLState::shared().bindVertexArray(streamVao_);
+}
+
+void GeometryPool::drawStream(uint32_t firstIndex, uint32_t indexCount, uint32_t vertexOffset) const {
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(indexCount), indexType_,
+                             reinterpret_cast<void*>(indexSize_ * size_t(firstIndex)),
+                             static_cast<GLint>(vertexOffset));
+}
@@ -0,0 +1,167 @@
+#include "gl_state.h"
+
+GLState& GLState::shared() {
+    static GLState state;
+    return state;
+}
+
+GLState::GLState() {
+    invalidate();
+}
+
+void GLState::invalidate() {
+    program_ = vao_ = activeUnit_ = framebuffer_ = 0;
+    for (GLint& v : viewport_) v = 0;
+    programKnown_ = vaoKnown_ = activeUnitKnown_ = framebufferKnown_ = viewportKnown_ = false;
+    depthTest_ = cullFace_ = Flag::Unknown;
+    cullMode_ = 0;
+    for (TextureUnit& u : units_) u = TextureUnit{ 0, 0, false };
+    for (UniformRange& r : uniformRanges_) r = UniformRange{ 0, 0, 0, false };
+}
+
+bool GLState::change(bool same) {
+    if (same) {
+        ++counters_.elided;
+        return false;
+    }
+    ++counters_.issued;
+    return true;
+}
+
+void GLState::useProgram(GLuint program) {
+    if (!change(programKnown_ && program_ == program)) return;
+    glUseProgram(program);
+    program_ = program;
+    programKnown_ = true;
+}
+
+void GLState::bindVertexArray(GLuint vao) {
+    if (!change(vaoKnown_ && vao_ == vao)) return;
+    glBindVertexArray(vao);
+    vao_ = vao;
+    vaoKnown_ = true;
+}
+
+void GLState::activeTexture(GLuint unit) {
+    if (!change(activeUnitKnown_ && activeUnit_ == unit)) return;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    activeUnit_ = unit;
+    activeUnitKnown_ = true;
+}
+
+// 纹理单元绑定
+// 2D 与立方体贴图目标分别跟踪；未跟踪的目标或单元直接执行
+void GLState::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+    const bool tracked = unit < GLuint(kMaxTextureUnits) && (target == GL_TEXTURE_2D || target == GL_TEXTURE_CUBE_MAP);
+    if (tracked) {
+        TextureUnit& u = units_[unit];
+        GLuint& cached = target == GL_TEXTURE_2D ? u.texture2D : u.textureCube;
+        if (u.known && cached == texture) {
+            ++counters_.elided;
+            return;
+        }
+        activeTexture(unit);
+        ++counters_.issued;
+        glBindTexture(target, texture);
+        if (!u.known) {
+            // 首次跟踪该单元：另一个目标的绑定仍未知，记为无效名字以保证下次执行
+            u.texture2D = u.textureCube = ~0u;
+            u.known = true;
+        }
+        cached = texture;
+        return;
+    }
+    activeTexture(unit);
+    ++counters_.issued;
+    glBindTexture(target, texture);
+}
+
+void GLState::bindTexture(GLenum target, GLuint texture) {
+    if (activeUnitKnown_) {
+        bindTexture(activeUnit_, target, texture);
+        return;
+    }
+    // 当前单元未知：执行后无法确定影响了哪个单元，纹理绑定全部失效
+    ++counters_.issued;
+    glBindTexture(target, texture);
+    for (TextureUnit& u : units_) u.known = false;
+}
+
+void GLState::bindFramebuffer(GLuint framebuffer) {
+    if (!change(framebufferKnown_ && framebuffer_ == framebuffer)) return;
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    framebuffer_ = framebuffer;
+    framebufferKnown_ = true;
+}
+
+void GLState::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    const bool same = viewportKnown_ && viewport_[0] == x && viewport_[1] == y
+                   && viewport_[2] == width && viewport_[3] == height;
+    if (!change(same)) return;
+    glViewport(x, y, width, height);
+    viewport_[0] = x;
+    viewport_[1] = y;
+    viewport_[2] = width;
+    viewport_[3] = height;
+    viewportKnown_ = true;
+}
+
+void GLState::setFlag(Flag& cached, GLenum cap, bool enabled) {
+    const Flag wanted = enabled ? Flag::On : Flag::Off;
+    if (!change(cached == wanted)) return;
+    if (enabled) glEnable(cap);
+    else glDisable(cap);
+    cached = wanted;
+}
+
+void GLState::setDepthTest(bool enabled) {
+    setFlag(depthTest_, GL_DEPTH_TEST, enabled);
+}
+
+void GLState::setCullFace(bool enabled) {
+    setFlag(cullFace_, GL_CULL_FACE, enabled);
+}
+
+void GLState::cullFace(GLenum mode) {
+    if (!change(cullMode_ == mode)) return;
+    glCullFace(mode);
+    cullMode_ = mode;
+}
+
+void GLState::bindUniformRange(GLuint binding, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    if (binding < GLuint(kMaxUniformBindings)) {
+        UniformRange& r = uniformRanges_[binding];
+        if (!change(r.known && r.buffer == buffer && r.offset == offset && r.size == size)) return;
+        r = UniformRange{ buffer, offset, size, true };
+    } else {
+        ++counters_.issued;
+    }
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, size);
+}
+
+void GLState::forgetProgram(GLuint program) {
+    if (program != 0 && program_ == program) programKnown_ = false;
+}
+
+void GLState::forgetVertexArray(GLuint vao) {
+    if (vao != 0 && vao_ == vao) vao_ = 0;
+}
+
+void GLState::forgetTexture(GLuint texture) {
+    if (texture == 0) return;
+    for (TextureUnit& u : units_) {
+        if (u.texture2D == texture) u.texture2D = 0;
+        if (u.textureCube == texture) u.textureCube = 0;
+    }
+}
+
+void GLState::forgetFramebuffer(GLuint framebuffer) {
+    if (framebuffer != 0 && framebuffer_ == framebuffer) framebuffer_ = 0;
+}
+
+void GLState::forgetBuffer(GLuint buffer) {
+    if (buffer == 0) return;
+    for (UniformRange& r : uniformRanges_) {
+        if (r.buffer == buffer) r.known = false;
+    }
+}
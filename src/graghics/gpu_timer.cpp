@@ -0,0 +1,59 @@
+#include "gpu_timer.h"
+
+GpuTimer::GpuTimer() : readyCount_(0), next_(0), active_(false), lastMs_(0.0) {
+    glGenQueries(kQueries, queries_);
+    for (bool& i : issued_) i = false;
+    for (int& t : tags_) t = 0;
+}
+
+GpuTimer::~GpuTimer() {
+    glDeleteQueries(kQueries, queries_);
+}
+
+// 开始计时
+// 环形队列中的下一个查询仍未返回结果时跳过本次计时，不阻塞
+void GpuTimer::begin(int tag) {
+    collect();
+    if (active_ || issued_[next_]) return;
+    glBeginQuery(GL_TIME_ELAPSED, queries_[next_]);
+    tags_[next_] = tag;
+    active_ = true;
+}
+
+bool GpuTimer::popResult(Result& out) {
+    collect();
+    if (readyCount_ == 0) return false;
+    out = ready_[0];
+    for (int i = 1; i < readyCount_; ++i) ready_[i - 1] = ready_[i];
+    --readyCount_;
+    return true;
+}
+
+void GpuTimer::end() {
+    if (!active_) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    issued_[next_] = true;
+    next_ = (next_ + 1) % kQueries;
+    active_ = false;
+}
+
+// 按提交顺序读取结果，遇到尚未可用的查询即停止
+void GpuTimer::collect() {
+    for (int n = 0; n < kQueries; ++n) {
+        const int i = (next_ + n) % kQueries;
+        if (!issued_[i]) continue;
+        GLint available = 0;
+        glGetQueryObjectiv(queries_[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries_[i], GL_QUERY_RESULT, &ns);
+        lastMs_ = double(ns) / 1.0e6;
+        issued_[i] = false;
+        // 结果未被取出时丢弃最旧的
+        if (readyCount_ == kQueries) {
+            for (int k = 1; k < kQueries; ++k) ready_[k - 1] = ready_[k];
+            --readyCount_;
+        }
+        ready_[readyCount_++] = Result{ lastMs_, tags_[i] };
+    }
+}
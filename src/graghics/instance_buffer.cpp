@@ -0,0 +1,140 @@
+#include "instance_buffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 合并上传时允许跨越的未变化实例数 (少量冗余字节换更少的上传调用)
+const size_t kMergeGap = 4;
+
+} // namespace
+
+CubeInstanceBuffer::CubeInstanceBuffer(size_t capacity)
+    : vbo_(0)
+    , capacity_(std::max<size_t>(capacity, 1))
+    , lastUploads_(0)
+    , uploadedBytes_(0) {
+    glGenBuffers(1, &vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(CubeInstance) * capacity_), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+CubeInstanceBuffer::~CubeInstanceBuffer() {
+    if (vbo_) glDeleteBuffers(1, &vbo_);
+}
+
+// 调整实例数量
+// 新实例初始化为隐藏 (全零矩阵)；扩容时在原缓冲区名字上重新分配存储，全部实例标记为脏
+void CubeInstanceBuffer::resize(size_t count) {
+    const size_t old = instances_.size();
+    CubeInstance hidden;
+    std::memset(&hidden, 0, sizeof(hidden));
+    instances_.resize(count, hidden);
+    dirtyFlags_.resize(count, 0);
+    if (count > capacity_) {
+        while (capacity_ < count) capacity_ *= 2;
+        glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(CubeInstance) * capacity_), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        for (size_t i = 0; i < count; ++i) markDirty(i);
+    } else if (count > old) {
+        for (size_t i = old; i < count; ++i) markDirty(i);
+    }
+    // 移除越界的脏下标
+    if (count < old) {
+        dirty_.erase(std::remove_if(dirty_.begin(), dirty_.end(), [count](uint32_t i) { return i >= count; }), dirty_.end());
+    }
+}
+
+void CubeInstanceBuffer::markDirty(size_t index) {
+    if (dirtyFlags_[index]) return;
+    dirtyFlags_[index] = 1;
+    dirty_.push_back(static_cast<uint32_t>(index));
+}
+
+// 更新实例数据
+// 法线矩阵只在模型矩阵变化时重算
+void CubeInstanceBuffer::set(size_t index, const glm::mat4& model, const glm::vec3& color) {
+    if (index >= instances_.size()) resize(index + 1);
+    CubeInstance& inst = instances_[index];
+    const bool modelChanged = inst.model != model;
+    if (!modelChanged && inst.color == color) return;
+    if (modelChanged) {
+        inst.model = model;
+        const glm::mat3 normal = glm::transpose(glm::inverse(glm::mat3(model)));
+        for (int c = 0; c < 3; ++c) inst.normalMatrix[c] = normal[c];
+    }
+    inst.color = color;
+    markDirty(index);
+}
+
+void CubeInstanceBuffer::set(size_t index, const CubeInstance& instance) {
+    if (index >= instances_.size()) resize(index + 1);
+    if (std::memcmp(&instances_[index], &instance, sizeof(CubeInstance)) == 0) return;
+    instances_[index] = instance;
+    markDirty(index);
+}
+
+void CubeInstanceBuffer::hide(size_t index) {
+    if (index >= instances_.size()) resize(index + 1);
+    CubeInstance& inst = instances_[index];
+    if (inst.model == glm::mat4(0.0f)) return;
+    inst.model = glm::mat4(0.0f);
+    markDirty(index);
+}
+
+// 上传脏实例
+// 排序后合并相邻 (间隔不超过 kMergeGap) 的实例为一个区间，每个区间一次 glBufferSubData
+size_t CubeInstanceBuffer::flush() {
+    lastUploads_ = 0;
+    if (dirty_.empty()) return 0;
+    std::sort(dirty_.begin(), dirty_.end());
+    size_t bytes = 0;
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    size_t i = 0;
+    while (i < dirty_.size()) {
+        const size_t begin = dirty_[i];
+        size_t end = begin + 1;
+        dirtyFlags_[begin] = 0;
+        ++i;
+        while (i < dirty_.size() && dirty_[i] <= end + kMergeGap) {
+            end = size_t(dirty_[i]) + 1;
+            dirtyFlags_[dirty_[i]] = 0;
+            ++i;
+        }
+        const size_t size = sizeof(CubeInstance) * (end - begin);
+        glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(sizeof(CubeInstance) * begin),
+                        static_cast<GLsizeiptr>(size), &instances_[begin]);
+        bytes += size;
+        ++lastUploads_;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    dirty_.clear();
+    uploadedBytes_ += bytes;
+    return bytes;
+}
+
+// 实例属性
+// mat4 占 4 个 location，mat3 占 3 个，逐实例前进 (divisor 1)
+void CubeInstanceBuffer::setupAttributes() const {
+    const GLsizei stride = sizeof(CubeInstance);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    GLuint loc = kInstanceAttribBase;
+    for (int c = 0; c < 4; ++c, ++loc) {
+        glEnableVertexAttribArray(loc);
+        glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, stride,
+                              (void*)(offsetof(CubeInstance, model) + sizeof(glm::vec4) * c));
+        glVertexAttribDivisor(loc, 1);
+    }
+    for (int c = 0; c < 3; ++c, ++loc) {
+        glEnableVertexAttribArray(loc);
+        glVertexAttribPointer(loc, 3, GL_FLOAT, GL_FALSE, stride,
+                              (void*)(offsetof(CubeInstance, normalMatrix) + sizeof(glm::vec3) * c));
+        glVertexAttribDivisor(loc, 1);
+    }
+    glEnableVertexAttribArray(loc);
+    glVertexAttribPointer(loc, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(CubeInstance, color));
+    glVertexAttribDivisor(loc, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -1,4 +1,6 @@
 #include "light.h"
+#include "gl_state.h"
+#include "hash.h"
 #include "gtc/matrix_transform.hpp"
 
 // 构造函数：初始化光源参数
@@ -9,23 +11,79 @@ Light::Light()
     , depthCubemap_(0)
     , shadowSize_(0)
     , nearPlane_(1.0f)
-    , farPlane_(25.0f) {
+    , farPlane_(25.0f)
+    , attachedFace_(-1)
+    , casterRevision_(0)
+    , dirtyFaces_(0x3F) {
+    updateFaceMatrices();
 }
 
 // 析构函数：清理 OpenGL 资源
 Light::~Light() {
     if (depthCubemap_) {
+        GLState::shared().forgetTexture(depthCubemap_);
         glDeleteTextures(1, &depthCubemap_);
     }
     if (depthMapFBO_) {
+        GLState::shared().forgetFramebuffer(depthMapFBO_);
         glDeleteFramebuffers(1, &depthMapFBO_);
     }
 }
 
 // 设置点光源位置和颜色
+// 颜色不影响阴影；位置变化时全部面失效
 void Light::setPoint(const glm::vec3& pos, const glm::vec3& color) {
-    position_ = pos;
     color_ = color;
+    if (pos == position_) return;
+    position_ = pos;
+    updateFaceMatrices();
+    dirtyFaces_ = 0x3F;
+}
+
+// 生成立方体贴图 6 个面的视图矩阵 (面顺序与 GL_TEXTURE_CUBE_MAP_POSITIVE_X + i 一致)
+void Light::updateFaceMatrices() {
+    const glm::mat4 proj = glm::perspective(glm::radians(90.0f), 1.0f, nearPlane_, farPlane_);
+    const glm::vec3& p = position_;
+    faceMatrices_[0] = proj * glm::lookAt(p, p + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+    faceMatrices_[1] = proj * glm::lookAt(p, p + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+    faceMatrices_[2] = proj * glm::lookAt(p, p + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    faceMatrices_[3] = proj * glm::lookAt(p, p + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+    faceMatrices_[4] = proj * glm::lookAt(p, p + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+    faceMatrices_[5] = proj * glm::lookAt(p, p + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+    for (int face = 0; face < 6; ++face) faceFrusta_[face] = Frustum::fromMatrix(faceMatrices_[face]);
+}
+
+// 投射体影响的面
+// 先按距离排除阴影范围外的投射体 (面视锥的远平面只限制沿面轴方向的深度，角落处的范围更大)，再逐面测试视锥
+uint8_t Light::casterFaces(const glm::vec3& center, float radius) const {
+    if (glm::length(center - position_) - radius > farPlane_) return 0;
+    uint8_t faces = 0;
+    for (int face = 0; face < 6; ++face) {
+        if (faceFrusta_[face].intersectsSphere(center, radius)) faces |= uint8_t(1u << face);
+    }
+    return faces;
+}
+
+uint64_t Light::shadowVersion() const {
+    uint64_t h = fnv1a64(&position_, sizeof(position_));
+    h = fnv1a64(&farPlane_, sizeof(farPlane_), h);
+    return fnv1a64(&casterRevision_, sizeof(casterRevision_), h);
+}
+
+// 投射体变化
+// 包围球影响的面失效；完全位于阴影范围外的变化不影响任何面
+void Light::markCasterChanged(const glm::vec3& center, float radius) {
+    ++casterRevision_;
+    dirtyFaces_ |= casterFaces(center, radius);
+}
+
+void Light::invalidateShadow() {
+    ++casterRevision_;
+    dirtyFaces_ = 0x3F;
+}
+
+void Light::markFacesRendered(uint8_t faces) {
+    dirtyFaces_ &= uint8_t(~faces);
 }
 
 // 初始化阴影立方体贴图资源
@@ -36,13 +94,17 @@ void Light::setupShadowCube(int size, float nearPlane, float farPlane) {
     shadowSize_ = size;
     nearPlane_ = nearPlane;
     farPlane_ = farPlane;
+    updateFaceMatrices();
+    dirtyFaces_ = 0x3F; // 新建的贴图内容未定义
 
     // 如果已存在资源，先清理
     if (depthCubemap_) {
+        GLState::shared().forgetTexture(depthCubemap_);
         glDeleteTextures(1, &depthCubemap_);
         depthCubemap_ = 0;
     }
     if (depthMapFBO_) {
+        GLState::shared().forgetFramebuffer(depthMapFBO_);
         glDeleteFramebuffers(1, &depthMapFBO_);
         depthMapFBO_ = 0;
     }
@@ -51,8 +113,9 @@ void Light::setupShadowCube(int size, float nearPlane, float farPlane) {
     glGenFramebuffers(1, &depthMapFBO_);
 
     // 创建立方体贴图
+    GLState& gl = GLState::shared();
     glGenTextures(1, &depthCubemap_);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, depthCubemap_);
+    gl.bindTexture(GL_TEXTURE_CUBE_MAP, depthCubemap_);
     
     // 为立方体贴图的 6 个面分配内存（仅深度分量）
     for (int i = 0; i < 6; ++i) {
@@ -65,30 +128,37 @@ void Light::setupShadowCube(int size, float nearPlane, float farPlane) {
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    gl.bindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
     // 将立方体贴图附加到 FBO 的深度附件点
     // 注意：这里我们不需要颜色附件，所以将绘制和读取缓冲区都设为 GL_NONE
-    glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO_);
+    gl.bindFramebuffer(depthMapFBO_);
     glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthCubemap_, 0);
+    attachedFace_ = -1;
     glDrawBuffer(GL_NONE);
     glReadBuffer(GL_NONE);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    gl.bindFramebuffer(0);
 }
 
 // 开始阴影深度贴图渲染 pass
-// 将渲染目标切换到阴影 FBO，并设置视口大小
+// 将渲染目标切换到阴影 FBO，并设置视口大小 (清除由调用方在 attachDepthFace 之后进行)
 void Light::beginDepthPass() {
-    glViewport(0, 0, shadowSize_, shadowSize_);
-    glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO_);
-    glClear(GL_DEPTH_BUFFER_BIT);
+    GLState::shared().viewport(0, 0, shadowSize_, shadowSize_);
+    GLState::shared().bindFramebuffer(depthMapFBO_);
+}
+
+void Light::attachDepthFace(int face) {
+    if (face == attachedFace_) return;
+    if (face < 0) glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthCubemap_, 0);
+    else glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, depthCubemap_, 0);
+    attachedFace_ = face;
 }
 
 // 结束阴影深度贴图渲染 pass
 // 恢复默认帧缓冲
 void Light::endDepthPass() {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::shared().bindFramebuffer(0);
 }
 
 // 获取深度立方体贴图 ID
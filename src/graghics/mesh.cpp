@@ -1,19 +1,43 @@
 #include "mesh.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
+// 纹理对象析构：释放 OpenGL 纹理
+GLTexture::~GLTexture() {
+    if (id) {
+        GLState::shared().forgetTexture(id);
+        glDeleteTextures(1, &id);
+    }
+}
+
 // 构造函数：初始化网格数据并配置 OpenGL 资源
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures,
+           VertexFormat format, GeometryPool *pool, std::vector<MeshLod> lods, std::vector<Meshlet> meshlets)
+    : VAO(0), VBO(0), EBO(0)
+    , pool(pool)
+    , format(format)
+    , indexType(GL_UNSIGNED_INT)
 {
-    this->vertices = vertices;
-    this->indices = indices;
-    this->textures = textures;
+    this->vertices = std::move(vertices);
+    this->indices = std::move(indices);
+    this->textures = std::move(textures);
+    this->lods = std::move(lods);
+    this->meshlets = std::move(meshlets);
+    // 没有 LOD 表时整个索引数组即为原始级别
+    if (this->lods.empty()) this->lods.push_back(MeshLod{ 0, static_cast<uint32_t>(this->indices.size()), 0.0f, 0 });
 
     setupMesh();
 }
 
 // 析构函数：释放 OpenGL 缓冲区
 Mesh::~Mesh() {
-    if (VAO) glDeleteVertexArrays(1, &VAO);
+    if (pool) pool->remove(alloc);
+    if (VAO) {
+        GLState::shared().forgetVertexArray(VAO);
+        glDeleteVertexArrays(1, &VAO);
+    }
     if (VBO) glDeleteBuffers(1, &VBO);
     if (EBO) glDeleteBuffers(1, &EBO);
 }
@@ -23,21 +47,39 @@ Mesh::Mesh(Mesh&& other) noexcept
     : vertices(std::move(other.vertices))
     , indices(std::move(other.indices))
     , textures(std::move(other.textures))
+    , lods(std::move(other.lods))
+    , meshlets(std::move(other.meshlets))
     , VAO(other.VAO)
     , VBO(other.VBO)
     , EBO(other.EBO)
+    , pool(other.pool)
+    , alloc(other.alloc)
+    , format(other.format)
+    , indexType(other.indexType)
+    , quant(other.quant)
+    , vboBytes(other.vboBytes)
+    , eboBytes(other.eboBytes)
+    , center(other.center)
+    , radius(other.radius)
+    , extent(other.extent)
 {
+    for (int p = 0; p < kLodPassCount; ++p) lodLevel[p] = other.lodLevel[p];
     // 将原对象的 ID 置零，防止析构时误删
     other.VAO = 0;
     other.VBO = 0;
     other.EBO = 0;
+    other.pool = nullptr;
 }
 
 // 移动赋值运算符
 Mesh& Mesh::operator=(Mesh&& other) noexcept {
     if (this != &other) {
         // 先释放当前对象的资源
-        if (VAO) glDeleteVertexArrays(1, &VAO);
+        if (pool) pool->remove(alloc);
+        if (VAO) {
+            GLState::shared().forgetVertexArray(VAO);
+            glDeleteVertexArrays(1, &VAO);
+        }
         if (VBO) glDeleteBuffers(1, &VBO);
         if (EBO) glDeleteBuffers(1, &EBO);
 
@@ -45,69 +87,154 @@ Mesh& Mesh::operator=(Mesh&& other) noexcept {
         vertices = std::move(other.vertices);
         indices = std::move(other.indices);
         textures = std::move(other.textures);
+        lods = std::move(other.lods);
+        meshlets = std::move(other.meshlets);
         VAO = other.VAO;
         VBO = other.VBO;
         EBO = other.EBO;
+        pool = other.pool;
+        alloc = other.alloc;
+        format = other.format;
+        indexType = other.indexType;
+        quant = other.quant;
+        vboBytes = other.vboBytes;
+        eboBytes = other.eboBytes;
+        for (int p = 0; p < kLodPassCount; ++p) lodLevel[p] = other.lodLevel[p];
+        center = other.center;
+        radius = other.radius;
+        extent = other.extent;
 
         // 置空原对象
         other.VAO = 0;
         other.VBO = 0;
         other.EBO = 0;
+        other.pool = nullptr;
     }
     return *this;
 }
 
 // 配置 OpenGL 缓冲区 (VAO, VBO, EBO)
+// Packed 格式在上传前压缩顶点与索引，CPU 端保留全精度数据
+// 指定几何池时子分配到池的共享缓冲区中，不再创建独立的 VAO
 void Mesh::setupMesh()
 {
+    // 0. 包围盒与包围球 (包围盒中心 + 最远顶点距离)，用于视锥剔除与 LOD 选择
+    if (!vertices.empty()) {
+        glm::vec3 minPos = vertices[0].Position, maxPos = minPos;
+        for (const Vertex& v : vertices) {
+            minPos = glm::min(minPos, v.Position);
+            maxPos = glm::max(maxPos, v.Position);
+        }
+        center = (minPos + maxPos) * 0.5f;
+        extent = (maxPos - minPos) * 0.5f;
+        float r2 = 0.0f;
+        for (const Vertex& v : vertices) r2 = std::max(r2, glm::dot(v.Position - center, v.Position - center));
+        radius = std::sqrt(r2);
+    }
+
+    // 1. 准备 GPU 端顶点数据
+    std::vector<PackedVertex> packed;
+    const void* vertexData = vertices.data();
+    if (format == VertexFormat::Packed) {
+        quant = packVertices(vertices, packed);
+        vertexData = packed.data();
+        vboBytes = packed.size() * sizeof(PackedVertex);
+    } else {
+        vboBytes = vertices.size() * sizeof(Vertex);
+    }
+
+    // 2. 准备索引数据 (几何池中的索引相对基准顶点，16 位索引只受本网格顶点数限制)
+    if (pool && (pool->format() != format || !pool->accepts(vertices.size()))) pool = nullptr;
+    bool shortIndices = pool ? pool->indexType() == GL_UNSIGNED_SHORT : useShortIndices(format, vertices.size());
+    std::vector<unsigned short> shortData;
+    const void* indexData = indices.data();
+    if (shortIndices) {
+        shortData.assign(indices.begin(), indices.end());
+        indexData = shortData.data();
+        indexType = GL_UNSIGNED_SHORT;
+        eboBytes = shortData.size() * sizeof(unsigned short);
+    } else {
+        indexType = GL_UNSIGNED_INT;
+        eboBytes = indices.size() * sizeof(unsigned int);
+    }
+
+    // 3. 子分配到几何池
+    if (pool) {
+        alloc = pool->add(vertexData, static_cast<uint32_t>(vertices.size()), indexData, static_cast<uint32_t>(indices.size()));
+        if (alloc.valid()) return;
+        pool = nullptr;
+    }
+
+    // 4. 独立缓冲区
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
 
-    glBindVertexArray(VAO);
+    GLState::shared().bindVertexArray(VAO);
+    // 上传顶点数据
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vboBytes, vertexData, GL_STATIC_DRAW);
+    // 上传索引数据
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, eboBytes, indexData, GL_STATIC_DRAW);
 
-    // 上传顶点数据
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);  
+    // 顶点位置 (Location 0)、法线 (Location 1)、纹理坐标 (Location 2)
+    setupVertexAttributes(format, false);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    // 上传索引数据
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), 
-                 &indices[0], GL_STATIC_DRAW);
-
-    // 顶点位置 (Location 0)
-    glEnableVertexAttribArray(0);   
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    // 顶点法线 (Location 1)
-    glEnableVertexAttribArray(1);   
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-    // 顶点纹理坐标 (Location 2)
-    glEnableVertexAttribArray(2);   
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
-
-    glBindVertexArray(0);
+    GLState::shared().bindVertexArray(0);
 }  
 
-// 绘制网格
-void Mesh::Draw(Shader &shader) 
+// 绘制网格 (VAO 保持绑定，由状态缓存省略下一次相同的绑定)
+void Mesh::Draw(Shader &shader, LodPass pass) 
 {   
-    bool hasTex = false;
+    bindGeometry();
+    DrawBound(shader, pass);
+}
+
+GLuint Mesh::vertexArray() const
+{
+    return pool ? pool->vertexArray() : VAO;
+}
+
+void Mesh::bindGeometry() const
+{
+    if (pool) pool->bind();
+    else GLState::shared().bindVertexArray(VAO);
+}
+
+// 设置材质与顶点解码参数
+// 有无纹理由调用方选择的着色器变体区分 (无纹理变体以对象 UBO 中的 objectColor 为基础色)
+void Mesh::applyMaterial(Shader &shader)
+{
     // 如果有纹理，绑定第一张纹理
     if (!textures.empty()) {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, textures[0].id);
-        hasTex = true;
+        GLState::shared().bindTexture(0, GL_TEXTURE_2D, textures[0].id);
     } 
 
-    // 设置 Shader 中的 hasTexture 和 objectColor
-    // 如果没有纹理，使用白色作为基础色
-    shader.setInt("hasTexture", hasTex ? 1 : 0);
-    if (!hasTex) {
-        shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-    }
+    applyDecodeUniforms(shader, quant, format);
+}
+
+// 在已绑定 VAO 的前提下绘制
+void Mesh::DrawBound(Shader &shader, LodPass pass)
+{
+    applyMaterial(shader);
+
+    // 绘制调用 (只绘制选中 LOD 的索引范围)
+    const MeshLod& l = lods[lodLevel[static_cast<int>(pass)]];
+    if (pool) pool->draw(alloc, l.indexOffset, l.indexCount);
+    else glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(l.indexCount), indexType,
+                        reinterpret_cast<void*>(size_t(l.indexOffset) * (indexType == GL_UNSIGNED_SHORT ? 2 : 4)));
+}
 
-    // 绘制调用
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, nullptr);
-    glBindVertexArray(0);
+// 绘制索引流中的一段 (几何池网格才有流式绘制)
+void Mesh::DrawStream(Shader &shader, uint32_t firstIndex, uint32_t indexCount)
+{
+    if (!pool || indexCount == 0) return;
+    applyMaterial(shader);
+    pool->drawStream(firstIndex, indexCount, alloc.vertexOffset);
+}
+
+void Mesh::setLod(LodPass pass, int level)
+{
+    lodLevel[static_cast<int>(pass)] = std::max(0, std::min(level, lodCount() - 1));
 }
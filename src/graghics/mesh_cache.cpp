@@ -0,0 +1,266 @@
+#include "mesh_cache.h"
+#include "hash.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+const char kMagic[8] = { 'A', 'S', 'D', 'M', 'C', 'A', 'C', 'H' };
+const uint64_t kAlign = 16;
+
+// 文件头
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t importFlags;
+    uint64_t sourceHash;
+    uint32_t meshCount;
+    uint32_t imageCount;
+    uint32_t vertexSize;  // sizeof(Vertex)，防止结构体布局变化后误读
+    uint32_t reserved;
+};
+
+// 图像记录
+struct ImageRecord {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t sampler[4];   // wrapS, wrapT, minFilter, magFilter
+    uint64_t sourceOffset; // 来源字符串 (不含结尾 0)
+    uint32_t sourceSize;
+    uint32_t reserved;
+};
+
+// 网格记录
+struct MeshRecord {
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    int32_t image;
+    uint32_t lodCount;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t lodOffset;
+    uint32_t meshletCount;
+    uint32_t reserved;
+    uint64_t meshletOffset;
+};
+
+uint64_t alignUp(uint64_t v) {
+    return (v + kAlign - 1) & ~(kAlign - 1);
+}
+
+// 检查 [offset, offset + size) 是否位于文件范围内
+bool inRange(uint64_t offset, uint64_t size, uint64_t fileSize) {
+    return offset <= fileSize && size <= fileSize - offset;
+}
+
+} // namespace
+
+std::string MeshCache::pathFor(const std::string& sourcePath) {
+    return sourcePath + ".meshcache";
+}
+
+bool MeshCache::hashFile(const std::string& path, uint64_t& outHash) {
+    MappedFile f;
+    if (!f.open(path)) return false;
+    outHash = fnv1a64(f.data(), f.size());
+    return true;
+}
+
+bool MeshCache::write(const std::string& cachePath, uint64_t sourceHash, uint32_t importFlags,
+                      const std::vector<MeshData>& meshes, const std::vector<ImageCacheInput>& images) {
+    CacheHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.importFlags = importFlags;
+    header.sourceHash = sourceHash;
+    header.meshCount = static_cast<uint32_t>(meshes.size());
+    header.imageCount = static_cast<uint32_t>(images.size());
+    header.vertexSize = sizeof(Vertex);
+
+    // 1. 计算各数据块偏移
+    uint64_t offset = sizeof(CacheHeader) + sizeof(ImageRecord) * images.size() + sizeof(MeshRecord) * meshes.size();
+    std::vector<ImageRecord> imageRecords(images.size());
+    for (size_t i = 0; i < images.size(); ++i) {
+        ImageRecord& r = imageRecords[i];
+        const ImageCacheInput& in = images[i];
+        r = ImageRecord{};
+        r.width = static_cast<uint32_t>(in.image->width);
+        r.height = static_cast<uint32_t>(in.image->height);
+        r.sampler[0] = in.sampler.wrapS;
+        r.sampler[1] = in.sampler.wrapT;
+        r.sampler[2] = in.sampler.minFilter;
+        r.sampler[3] = in.sampler.magFilter;
+        r.sourceOffset = offset;
+        r.sourceSize = static_cast<uint32_t>(in.source.size());
+        offset += r.sourceSize;
+        offset = alignUp(offset);
+        r.offset = offset;
+        r.size = in.image->pixels.size();
+        offset += r.size;
+    }
+    std::vector<MeshRecord> meshRecords(meshes.size());
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        MeshRecord& r = meshRecords[i];
+        r = MeshRecord{};
+        r.vertexCount = static_cast<uint32_t>(meshes[i].vertices.size());
+        r.indexCount = static_cast<uint32_t>(meshes[i].indices.size());
+        r.image = meshes[i].image;
+        offset = alignUp(offset);
+        r.vertexOffset = offset;
+        offset += sizeof(Vertex) * uint64_t(r.vertexCount);
+        offset = alignUp(offset);
+        r.indexOffset = offset;
+        offset += sizeof(unsigned int) * uint64_t(r.indexCount);
+        r.lodCount = static_cast<uint32_t>(meshes[i].lods.size());
+        offset = alignUp(offset);
+        r.lodOffset = offset;
+        offset += sizeof(MeshLod) * uint64_t(r.lodCount);
+        r.meshletCount = static_cast<uint32_t>(meshes[i].meshlets.size());
+        offset = alignUp(offset);
+        r.meshletOffset = offset;
+        offset += sizeof(Meshlet) * uint64_t(r.meshletCount);
+    }
+
+    // 2. 顺序写入临时文件
+    const std::string tmpPath = cachePath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        uint64_t written = 0;
+        auto put = [&](const void* data, uint64_t size) {
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            written += size;
+        };
+        auto padTo = [&](uint64_t target) {
+            static const char zeros[kAlign] = {};
+            if (target > written) put(zeros, target - written);
+        };
+        put(&header, sizeof(header));
+        if (!imageRecords.empty()) put(imageRecords.data(), sizeof(ImageRecord) * imageRecords.size());
+        if (!meshRecords.empty()) put(meshRecords.data(), sizeof(MeshRecord) * meshRecords.size());
+        for (size_t i = 0; i < images.size(); ++i) {
+            const std::vector<unsigned char>& pixels = images[i].image->pixels;
+            padTo(imageRecords[i].sourceOffset);
+            if (!images[i].source.empty()) put(images[i].source.data(), images[i].source.size());
+            padTo(imageRecords[i].offset);
+            if (!pixels.empty()) put(pixels.data(), pixels.size());
+        }
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            padTo(meshRecords[i].vertexOffset);
+            if (!meshes[i].vertices.empty()) put(meshes[i].vertices.data(), sizeof(Vertex) * meshes[i].vertices.size());
+            padTo(meshRecords[i].indexOffset);
+            if (!meshes[i].indices.empty()) put(meshes[i].indices.data(), sizeof(unsigned int) * meshes[i].indices.size());
+            padTo(meshRecords[i].lodOffset);
+            if (!meshes[i].lods.empty()) put(meshes[i].lods.data(), sizeof(MeshLod) * meshes[i].lods.size());
+            padTo(meshRecords[i].meshletOffset);
+            if (!meshes[i].meshlets.empty()) put(meshes[i].meshlets.data(), sizeof(Meshlet) * meshes[i].meshlets.size());
+        }
+        if (!out) {
+            out.close();
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+
+    // 3. 替换旧缓存 (Windows 下 rename 不会覆盖已存在文件)
+    std::remove(cachePath.c_str());
+    if (std::rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+MeshCache::MeshCache() {}
+
+bool MeshCache::open(const std::string& cachePath, uint64_t sourceHash, uint32_t importFlags) {
+    meshes_.clear();
+    images_.clear();
+    if (!file_.open(cachePath)) return false;
+
+    const unsigned char* base = file_.data();
+    const uint64_t fileSize = file_.size();
+
+    // 1. 校验文件头
+    if (fileSize < sizeof(CacheHeader)) { file_.close(); return false; }
+    CacheHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0
+        || header.version != kVersion
+        || header.importFlags != importFlags
+        || header.sourceHash != sourceHash
+        || header.vertexSize != sizeof(Vertex)) {
+        file_.close();
+        return false;
+    }
+
+    // 2. 解析记录表，所有偏移都需落在文件范围内
+    uint64_t tableSize = sizeof(ImageRecord) * uint64_t(header.imageCount) + sizeof(MeshRecord) * uint64_t(header.meshCount);
+    if (!inRange(sizeof(CacheHeader), tableSize, fileSize)) { file_.close(); return false; }
+
+    const unsigned char* cursor = base + sizeof(CacheHeader);
+    images_.resize(header.imageCount);
+    for (uint32_t i = 0; i < header.imageCount; ++i, cursor += sizeof(ImageRecord)) {
+        ImageRecord r;
+        std::memcpy(&r, cursor, sizeof(r));
+        if (r.size != uint64_t(r.width) * r.height * 4 || !inRange(r.offset, r.size, fileSize)
+            || !inRange(r.sourceOffset, r.sourceSize, fileSize)) {
+            file_.close();
+            images_.clear();
+            return false;
+        }
+        images_[i].width = static_cast<int>(r.width);
+        images_[i].height = static_cast<int>(r.height);
+        images_[i].pixels = base + r.offset;
+        images_[i].source.assign(reinterpret_cast<const char*>(base + r.sourceOffset), r.sourceSize);
+        images_[i].sampler.wrapS = r.sampler[0];
+        images_[i].sampler.wrapT = r.sampler[1];
+        images_[i].sampler.minFilter = r.sampler[2];
+        images_[i].sampler.magFilter = r.sampler[3];
+    }
+
+    meshes_.resize(header.meshCount);
+    for (uint32_t i = 0; i < header.meshCount; ++i, cursor += sizeof(MeshRecord)) {
+        MeshRecord r;
+        std::memcpy(&r, cursor, sizeof(r));
+        bool valid = inRange(r.vertexOffset, sizeof(Vertex) * uint64_t(r.vertexCount), fileSize)
+                  && inRange(r.indexOffset, sizeof(unsigned int) * uint64_t(r.indexCount), fileSize)
+                  && inRange(r.lodOffset, sizeof(MeshLod) * uint64_t(r.lodCount), fileSize)
+                  && inRange(r.meshletOffset, sizeof(Meshlet) * uint64_t(r.meshletCount), fileSize)
+                  && r.image >= -1 && r.image < int32_t(header.imageCount);
+        // LOD 范围必须位于索引数组内
+        const MeshLod* lods = reinterpret_cast<const MeshLod*>(base + r.lodOffset);
+        for (uint32_t l = 0; valid && l < r.lodCount; ++l) {
+            valid = lods[l].indexOffset <= r.indexCount && lods[l].indexCount <= r.indexCount - lods[l].indexOffset;
+        }
+        // 簇范围同样必须位于索引数组内
+        const Meshlet* meshlets = reinterpret_cast<const Meshlet*>(base + r.meshletOffset);
+        for (uint32_t m = 0; valid && m < r.meshletCount; ++m) {
+            valid = meshlets[m].indexOffset <= r.indexCount
+                 && uint64_t(meshlets[m].triangleCount) * 3 <= r.indexCount - meshlets[m].indexOffset;
+        }
+        // 索引值必须小于顶点数 (文件头完好但内容损坏时，越界索引会使 CPU 端的处理越界访问)
+        const unsigned int* indices = reinterpret_cast<const unsigned int*>(base + r.indexOffset);
+        for (uint32_t k = 0; valid && k < r.indexCount; ++k) valid = indices[k] < r.vertexCount;
+        if (!valid) {
+            file_.close();
+            images_.clear();
+            meshes_.clear();
+            return false;
+        }
+        MeshCacheEntry& e = meshes_[i];
+        e.vertices = reinterpret_cast<const Vertex*>(base + r.vertexOffset);
+        e.vertexCount = r.vertexCount;
+        e.indices = indices;
+        e.indexCount = r.indexCount;
+        e.lods = r.lodCount ? lods : nullptr;
+        e.lodCount = r.lodCount;
+        e.meshlets = r.meshletCount ? meshlets : nullptr;
+        e.meshletCount = r.meshletCount;
+        e.image = r.image;
+    }
+    return true;
+}
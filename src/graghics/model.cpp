@@ -1,198 +1,1018 @@
 #include "model.h"
+#include "mesh_cache.h"
+#include "render_queue.h"
+#include "light.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+#include "texture_registry.h"
 #include "glad/glad.h"
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstring>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+// Assimp 导入标志，同时作为缓存失效条件之一
+// aiProcess_Triangulate: 将非三角形面（如四边形）转换为三角形
+// aiProcess_FlipUVs: 翻转纹理坐标的 y 轴（OpenGL 的纹理坐标原点在左下角，而大部分图像格式在左上角）
+// aiProcess_SortByPType: 按图元类型拆分网格，线段与点图元单独成网格 (收集网格时跳过)
+const unsigned int kImportFlags = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_SortByPType;
+
+// 生成网格纹理列表 (网格持有共享引用)
+std::vector<Texture> makeTextures(const std::shared_ptr<GLTexture> &handle)
+{
+    std::vector<Texture> out;
+    Texture t{};
+    t.type = "texture_diffuse";
+    t.id = handle ? handle->id : 0;
+    t.handle = handle;
+    if (t.id != 0) {
+        out.push_back(t);
+    }
+    return out;
+}
+
+// 注册表中的纹理来源：内嵌纹理以模型路径限定，外部文件使用完整路径
+std::string textureSource(const std::string &path, const std::string &source)
+{
+    if (!source.empty() && source[0] == '*') return path + "|" + source;
+    std::string::size_type slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? source : path.substr(0, slash + 1) + source;
+}
+
+// Assimp 环绕模式转换为 OpenGL 参数
+GLenum wrapMode(aiTextureMapMode mode)
+{
+    switch (mode) {
+    case aiTextureMapMode_Clamp:  return GL_CLAMP_TO_EDGE;
+    case aiTextureMapMode_Mirror: return GL_MIRRORED_REPEAT;
+    case aiTextureMapMode_Decal:  return GL_CLAMP_TO_BORDER;
+    default:                      return GL_REPEAT;
+    }
+}
+
+// 含完整 mipmap 链的 RGBA8 纹理显存占用估算
+uint64_t textureBytes(const GLTexture &tex)
+{
+    return uint64_t(tex.width) * uint64_t(tex.height) * 4 * 4 / 3;
+}
+
+// 模型所在目录 (用于解析外部纹理文件)
+std::string modelDirectory(const std::string &path)
+{
+    std::string::size_type slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash);
+}
+
+// 顶点包围盒
+template <typename T, typename PositionOf>
+std::pair<glm::vec3, glm::vec3> meshBounds(const T *vertices, size_t count, PositionOf positionOf)
+{
+    if (count == 0) return { glm::vec3(0.0f), glm::vec3(0.0f) };
+    glm::vec3 minPos = positionOf(vertices[0]), maxPos = minPos;
+    for (size_t i = 1; i < count; ++i) {
+        glm::vec3 p = positionOf(vertices[i]);
+        minPos = glm::min(minPos, p);
+        maxPos = glm::max(maxPos, p);
+    }
+    return { minPos, maxPos };
+}
+
+// 从缓存视图复制出 CPU 端网格数据
+MeshData cacheMeshData(const MeshCacheEntry &e)
+{
+    MeshData out;
+    out.vertices.assign(e.vertices, e.vertices + e.vertexCount);
+    out.indices.assign(e.indices, e.indices + e.indexCount);
+    out.lods.assign(e.lods, e.lods + e.lodCount);
+    out.meshlets.assign(e.meshlets, e.meshlets + e.meshletCount);
+    out.image = e.image;
+    return out;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace
+
+// 冷启动缓存写入任务
+// 网格数据在创建 GL 资源前保留一份；纹理解码完成后逐个回填，最后一张完成时在工作线程上写盘
+struct Model::CacheWriteJob {
+    std::string path;
+    uint64_t sourceHash = 0;
+    std::vector<MeshData> meshes;
+    std::vector<ImageCacheInput> inputs;                  // 纹理来源与采样参数
+    std::vector<std::shared_ptr<const ImageData>> images; // 解码结果
+    std::atomic<size_t> remaining{0};
+
+    void write()
+    {
+        // 解码失败的图像不写入缓存，对应网格按无纹理处理
+        std::vector<int> remap(images.size(), -1);
+        std::vector<ImageCacheInput> valid;
+        for (size_t i = 0; i < images.size(); ++i) {
+            if (!images[i]) continue;
+            remap[i] = static_cast<int>(valid.size());
+            valid.push_back(inputs[i]);
+            valid.back().image = images[i].get();
+        }
+        for (auto& m : meshes) {
+            if (m.image >= 0) m.image = remap[m.image];
+        }
+        if (!MeshCache::write(path, sourceHash, kImportFlags, meshes, valid)) {
+            std::cout << "WARNING::MESH_CACHE::failed to write " << path << std::endl;
+        }
+    }
+};
+
+// 异步加载状态
+// 完成队列由工作线程与 GL 线程共享 (受 mutex 保护)，其余字段只在 GL 线程上访问
+struct Model::AsyncLoad {
+    // 完成队列中的一项
+    struct Item {
+        enum Kind { Textures, MeshReady, Done, Failed } kind = Done;
+        // Textures: 纹理列表 (总是第一个入队)
+        std::vector<ModelImage> images;      // Assimp 路径：去重后的压缩纹理
+        std::vector<size_t> imageRefs;       // 各纹理被引用的网格数
+        std::shared_ptr<MeshCache> cache;    // 命中缓存时的缓存映射
+        size_t meshTotal = 0;                // 网格总数
+        bool hashed = false;                 // 源文件是否可读 (决定是否写缓存)
+        uint64_t sourceHash = 0;
+        // MeshReady: 转换完成的网格
+        MeshData mesh;
+        MeshOptimizeStats optimize;
+        // Failed: 错误信息
+        std::string error;
+    };
+
+    std::mutex mutex;
+    std::deque<Item> items;
+
+    std::string path;
+    TextureRegistry *textures = nullptr;
+    std::vector<std::shared_ptr<GLTexture>> handles; // 纹理句柄 (按模型内编号)
+    std::shared_ptr<CacheWriteJob> job;               // 冷启动时的缓存写入任务
+    std::chrono::steady_clock::time_point start;
+    size_t meshTotal = 0;
+    bool finished = false;
+
+    void push(Item item)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.push_back(std::move(item));
+    }
+};
 
 // 绘制模型
 // 遍历模型中包含的所有网格并逐个绘制
-void Model::Draw(Shader &shader)
+// 使用几何池时所有网格共享一个 VAO，只在几何来源变化时重新绑定
+void Model::Draw(Shader &shader, LodPass pass)
 {
+    Draw(shader, shader, pass);
+}
+
+void Model::Draw(Shader &textured, Shader &untextured, LodPass pass)
+{
+    const GeometryPool *bound = nullptr;
+    const Shader *active = nullptr;
     for(unsigned int i = 0; i < meshes.size(); i++)
-        meshes[i].Draw(shader);
+    {
+        Shader &shader = meshes[i].hasTexture() ? textured : untextured;
+        if (&shader != active) {
+            shader.use();
+            active = &shader;
+        }
+        const GeometryPool *pool = meshes[i].geometryPool();
+        if (!pool || pool != bound) {
+            meshes[i].bindGeometry();
+            bound = pool;
+        }
+        meshes[i].DrawBound(shader, pass);
+    }
+}
+
+// 世界空间包围球
+// 先求各网格包围球的包围盒，再以盒中心为球心取最远的球面距离
+bool Model::worldBounds(const glm::mat4 &modelMatrix, glm::vec3 &center, float &radius) const
+{
+    if (meshes.empty()) return false;
+    glm::vec3 lo(0.0f), hi(0.0f);
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        glm::vec3 c;
+        float r;
+        meshes[i].worldSphere(modelMatrix, c, r);
+        lo = i ? glm::min(lo, c - r) : c - r;
+        hi = i ? glm::max(hi, c + r) : c + r;
+    }
+    center = (lo + hi) * 0.5f;
+    radius = 0.0f;
+    for (const Mesh &mesh : meshes) {
+        glm::vec3 c;
+        float r;
+        mesh.worldSphere(modelMatrix, c, r);
+        radius = std::max(radius, glm::length(c - center) + r);
+    }
+    return true;
+}
+
+// 选择 LOD
+// 1. 包围球变换到世界空间，以球面到视点的最近距离估算投影：像素误差 = error * scale * projScale / 距离
+// 2. 各级别误差单调递增，取误差不超过阈值的最粗级别
+// 3. 滞回：当前级别位于 "严格阈值" 与 "宽松阈值" 选出的级别之间时保持不变
+LodPassStats Model::selectLods(const glm::mat4 &modelMatrix, const glm::vec3 &eye, float projScale,
+                               const LodSettings &settings, LodPass pass)
+{
+    LodPassStats out;
+    const float scale = maxAxisScale(modelMatrix);
+    const float bias = pass == LodPass::Shadow ? settings.shadowBias : settings.mainBias;
+    const float threshold = settings.errorPixels * bias;
+
+    for (auto& mesh : meshes) {
+        out.fullTriangles += mesh.lods[0].indexCount / 3;
+        int level = 0;
+        if (settings.enabled && mesh.lodCount() > 1) {
+            glm::vec3 center;
+            float radius;
+            mesh.worldSphere(modelMatrix, center, radius);
+            float dist = glm::length(center - eye) - radius;
+            float pixelsPerUnit = projScale * scale / std::max(dist, 1e-3f);
+            auto select = [&](float limit) {
+                int l = 0;
+                while (l + 1 < mesh.lodCount() && mesh.lods[l + 1].error * pixelsPerUnit <= limit) ++l;
+                return l;
+            };
+            int coarse = select(threshold * (1.0f - settings.hysteresis));
+            int fine = select(threshold * (1.0f + settings.hysteresis));
+            level = mesh.lod(pass);
+            if (level < coarse) level = coarse;
+            else if (level > fine) level = fine;
+        }
+        const int previous = mesh.lod(pass);
+        mesh.setLod(pass, level);
+        level = mesh.lod(pass);
+        if (level != previous) ++out.changed;
+        out.meshesPerLevel[std::min(level, kMaxLodLevels - 1)]++;
+        out.triangles += mesh.lods[level].indexCount / 3;
+    }
+    return out;
+}
+
+// 逐簇剔除
+// 1. 视点与视锥平面变换到模型空间，簇数据无需逐个变换
+// 2. 网格包围球在视锥外时整体剔除；只有原始级别的池内网格逐簇测试 (LOD 级别较粗时三角形已很少)
+// 3. 存活簇的索引依次追加到本帧的索引流，所有 Pass 剔除完后由 uploadClusterStream 一次性上传
+ClusterCullStats Model::cullClusters(const glm::mat4 &modelMatrix, const glm::mat4 &viewProj, const glm::vec3 &eye,
+                                     bool backface, LodPass pass)
+{
+    ClusterCullStats out;
+    const Frustum frustum = Frustum::fromMatrix(viewProj * modelMatrix);
+    const glm::vec3 localEye = glm::vec3(glm::inverse(modelMatrix) * glm::vec4(eye, 1.0f));
+
+    clusterDraws.assign(meshes.size(), ClusterDraw{});
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const Mesh &mesh = meshes[i];
+        ClusterDraw &draw = clusterDraws[i];
+        const MeshLod &lod = mesh.lods[mesh.lod(pass)];
+        ++out.meshes;
+        out.fullTriangles += lod.indexCount / 3;
+        if (!frustum.intersectsSphere(mesh.boundsCenter(), mesh.boundsRadius())) {
+            draw.mode = ClusterDraw::Culled;
+            ++out.meshesCulled;
+            continue;
+        }
+        GeometryPool *pool = mesh.geometryPool();
+        if (mesh.lod(pass) != 0 || mesh.meshlets.empty() || !pool || (streamPool && pool != streamPool)) {
+            draw.mode = ClusterDraw::Full;
+            out.triangles += lod.indexCount / 3;
+            continue;
+        }
+
+        streamPool = pool;
+        draw.mode = ClusterDraw::Stream;
+        draw.firstIndex = static_cast<uint32_t>(streamIndices.size());
+        cluster_cull_mesh(mesh.meshlets, mesh.indices.data(), frustum, localEye, backface, streamIndices, out);
+        draw.indexCount = static_cast<uint32_t>(streamIndices.size()) - draw.firstIndex;
+    }
+    return out;
+}
+
+void Model::resetClusterStream()
+{
+    streamIndices.clear();
+    streamPool = nullptr;
+}
+
+void Model::uploadClusterStream()
+{
+    if (!streamPool || streamIndices.empty()) return;
+    if (streamPool->indexType() == GL_UNSIGNED_SHORT) {
+        streamShort.assign(streamIndices.begin(), streamIndices.end());
+        streamPool->uploadStream(streamShort.data(), streamShort.size());
+    } else {
+        streamPool->uploadStream(streamIndices.data(), streamIndices.size());
+    }
+}
+
+// 按剔除结果绘制
+// 索引流中的网格共用池的流式 VAO，其余网格与 Draw 相同
+void Model::DrawClusters(Shader &shader, LodPass pass)
+{
+    DrawClusters(shader, shader, pass);
+}
+
+void Model::DrawClusters(Shader &textured, Shader &untextured, LodPass pass)
+{
+    if (clusterDraws.size() != meshes.size()) {
+        Draw(textured, untextured, pass);
+        return;
+    }
+    const GeometryPool *bound = nullptr;
+    bool boundStream = false;
+    const Shader *active = nullptr;
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        const ClusterDraw &draw = clusterDraws[i];
+        if (draw.mode == ClusterDraw::Culled) continue;
+        if (draw.mode == ClusterDraw::Stream && draw.indexCount == 0) continue;
+        Shader &shader = meshes[i].hasTexture() ? textured : untextured;
+        if (&shader != active) {
+            shader.use();
+            active = &shader;
+        }
+        const GeometryPool *pool = meshes[i].geometryPool();
+        if (draw.mode == ClusterDraw::Stream) {
+            if (pool != bound || !boundStream) {
+                streamPool->bindStream();
+                bound = pool;
+                boundStream = true;
+            }
+            meshes[i].DrawStream(shader, draw.firstIndex, draw.indexCount);
+            continue;
+        }
+        if (!pool || pool != bound || boundStream) {
+            meshes[i].bindGeometry();
+            bound = pool;
+            boundStream = false;
+        }
+        meshes[i].DrawBound(shader, pass);
+    }
+}
+
+// 提交到渲染队列
+// 与 DrawClusters 相同的分类，绘制顺序与状态切换交给队列排序
+size_t Model::submit(RenderQueue &queue, const RenderView &view, Shader &textured, Shader &untextured,
+                     uint32_t objectSlot, const glm::mat4 &modelMatrix, bool clusters, uint8_t passMask)
+{
+    const bool useDraws = clusters && clusterDraws.size() == meshes.size();
+    const bool useMasks = passMask != 0 && passMasks.size() == meshes.size();
+    size_t submitted = 0;
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        if (useMasks && !(passMasks[i] & passMask)) continue;
+        Mesh &mesh = meshes[i];
+        Shader &shader = mesh.hasTexture() ? textured : untextured;
+        if (!useDraws) {
+            queue.submitMesh(view, shader, mesh, objectSlot, modelMatrix);
+            ++submitted;
+            continue;
+        }
+        const ClusterDraw &draw = clusterDraws[i];
+        if (draw.mode == ClusterDraw::Culled) continue;
+        if (draw.mode == ClusterDraw::Stream)
+            queue.submitStream(view, shader, mesh, objectSlot, modelMatrix, draw.firstIndex, draw.indexCount);
+        else
+            queue.submitMesh(view, shader, mesh, objectSlot, modelMatrix);
+        ++submitted;
+    }
+    return submitted;
+}
+
+// 阴影投射体分类
+// 包围球变换到世界空间 (半径按最大轴缩放)，由光源给出会受影响的面
+void Model::classifyCasters(const Light &light, const glm::mat4 &modelMatrix)
+{
+    passMasks.resize(meshes.size(), 0);
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        glm::vec3 c;
+        float r;
+        meshes[i].worldSphere(modelMatrix, c, r);
+        passMasks[i] = uint8_t((passMasks[i] & kMainPassMask) | light.casterFaces(c, r));
+    }
+}
+
+// 主 Pass 视锥剔除
+// 模型空间包围盒只在网格发布时追加；每帧整体变换一次，再批量测试 (网格很多时分块并行)
+FrustumCullStats Model::cullMeshes(const glm::mat4 &modelMatrix, const Frustum *frustum)
+{
+    for (size_t i = localBounds.size(); i < meshes.size(); ++i) {
+        localBounds.resize(i + 1);
+        localBounds.set(i, meshes[i].boundsCenter(), meshes[i].boundsExtent());
+    }
+    aabb_transform_all(modelMatrix, localBounds, frameBounds);
+    FrustumCullStats out;
+    out.tested = meshes.size();
+    if (frustum) {
+        out.visible = frustum_cull_aabbs(*frustum, frameBounds, meshVisible, &ThreadPool::shared());
+    } else {
+        meshVisible.assign(meshes.size(), 1);
+        out.visible = meshes.size();
+    }
+    passMasks.resize(meshes.size(), 0);
+    for (size_t i = 0; i < meshes.size(); ++i)
+        passMasks[i] = uint8_t((passMasks[i] & ~kMainPassMask) | (meshVisible[i] ? kMainPassMask : 0));
+    return out;
+}
+
+// 遮挡体代理
+// LOD 的索引引用原始顶点，代理只保留用到的顶点位置；代理的顶点是原始顶点的子集，不会超出网格的包围盒
+void Model::buildOccluders(size_t triangleBudget, std::vector<OccluderMesh> &out) const
+{
+    out.clear();
+    std::vector<size_t> order(meshes.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) { return meshes[a].boundsRadius() > meshes[b].boundsRadius(); });
+
+    std::vector<uint32_t> remap;
+    for (size_t i : order) {
+        const Mesh &mesh = meshes[i];
+        const MeshLod *lod = nullptr;
+        for (const MeshLod &l : mesh.lods) {
+            if (l.error <= kOccluderMaxError * mesh.boundsRadius() && (!lod || l.indexCount < lod->indexCount)) lod = &l;
+        }
+        if (!lod) continue;
+        const size_t triangles = lod->indexCount / 3;
+        if (triangles == 0 || triangles > triangleBudget) continue;
+        triangleBudget -= triangles;
+
+        OccluderMesh occluder;
+        occluder.indices.reserve(lod->indexCount);
+        remap.assign(mesh.vertices.size(), ~0u);
+        for (uint32_t k = lod->indexOffset; k < lod->indexOffset + triangles * 3; ++k) {
+            const uint32_t v = mesh.indices[k];
+            if (remap[v] == ~0u) {
+                remap[v] = uint32_t(occluder.positions.size());
+                occluder.positions.push_back(mesh.vertices[v].Position);
+            }
+            occluder.indices.push_back(remap[v]);
+        }
+        out.push_back(std::move(occluder));
+    }
+}
+
+size_t Model::cullOccluded(const OcclusionBuffer &buffer)
+{
+    if (meshVisible.size() != meshes.size()) return 0;
+    const size_t occluded = buffer.cullBoxes(frameBounds, meshVisible, &ThreadPool::shared());
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        if (!meshVisible[i]) passMasks[i] &= uint8_t(~kMainPassMask);
+    }
+    return occluded;
+}
+
+// 纹理共享统计
+// 每个去重后的纹理替代了 savedCopies 份重复的解码与显存
+TextureShareStats Model::textureShareStats() const
+{
+    TextureShareStats out;
+    for (const auto& use : textureUses) {
+        out.decodesSaved += use.savedCopies;
+        if (use.texture->resident) out.bytesSaved += textureBytes(*use.texture) * use.savedCopies;
+    }
+    return out;
 }
 
 // 加载模型文件
-// 使用 Assimp 库读取模型文件，并处理可能出现的错误
-void Model::loadModel(const std::string &path)
+// 优先读取源文件旁的二进制缓存；缓存缺失或失效时使用 Assimp 导入并重建缓存
+void Model::loadModel(const std::string &path, TextureRegistry &textures)
 {
+    auto start = std::chrono::steady_clock::now();
+    stats = ModelLoadStats{};
+
+    // 1. 尝试命中缓存 (按源文件内容哈希 + 导入标志校验)
+    uint64_t sourceHash = 0;
+    bool hashed = MeshCache::hashFile(path, sourceHash);
+    const std::string cachePath = MeshCache::pathFor(path);
+    if (hashed) {
+        auto cache = std::make_shared<MeshCache>();
+        if (cache->open(cachePath, sourceHash, kImportFlags)) {
+            loadFromCache(cache, path, textures);
+            stats.fromCache = true;
+            stats.loadMs = stats.firstMeshMs = stats.allMeshesMs = elapsedMs(start);
+            return;
+        }
+    }
+
+    // 2. 缓存未命中：使用 Assimp 读取
     Assimp::Importer import;
-    // ReadFile 选项说明：
-    // aiProcess_Triangulate: 将非三角形面（如四边形）转换为三角形
-    // aiProcess_FlipUVs: 翻转纹理坐标的 y 轴（OpenGL 的纹理坐标原点在左下角，而大部分图像格式在左上角）
-    const aiScene *scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);    
+    const aiScene *scene = import.ReadFile(path, kImportFlags);
 
     // 检查场景是否加载成功
     // !scene: 场景指针为空
     // AI_SCENE_FLAGS_INCOMPLETE: 标志位显示加载不完整
     // !scene->mRootNode: 根节点为空
-    if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) 
+    if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
     {
         std::cout << "ERROR::ASSIMP::" << import.GetErrorString() << std::endl;
         return;
     }
 
-    // 从根节点开始递归处理场景图
-    processNode(scene->mRootNode, scene);
+    // 3. CPU 阶段：并行转换网格并提取压缩纹理
+    ModelData data;
+    convertScene(scene, modelDirectory(path), ThreadPool::shared(), data);
+
+    // 4. GL 阶段：创建 OpenGL 资源，纹理与缓存写入在后台完成
+    createMeshes(data, path, textures, hashed ? cachePath : std::string(), sourceHash);
+    stats.loadMs = stats.firstMeshMs = stats.allMeshesMs = elapsedMs(start);
+}
+
+// 启动异步加载
+// 构造函数只提交后台任务，网格由 update() 在 GL 线程上逐个发布
+void Model::startAsyncLoad(const std::string &path, TextureRegistry &textures)
+{
+    stats = ModelLoadStats{};
+    async = std::make_shared<AsyncLoad>();
+    async->path = path;
+    async->textures = &textures;
+    async->start = std::chrono::steady_clock::now();
+
+    std::shared_ptr<AsyncLoad> load = async;
+    const bool hasFocus = options.hasFocus;
+    const glm::vec3 focus = options.focus;
+    ThreadPool::shared().submit([load, path, hasFocus, focus] { loadAsync(load, path, hasFocus, focus); });
+}
+
+// 后台加载任务
+// 1. 命中缓存时直接从映射内存复制网格；否则用 Assimp 导入并解析、读取纹理
+// 2. 先发布纹理 (GL 线程据此创建占位纹理)，再按优先级转换并逐个发布网格：
+//    有参考点时按 "包围球半径 / 到参考点的距离" (近似屏幕尺寸) 排序，否则按包围球半径排序
+// 3. 网格在线程池上并行转换，完成一个发布一个，完成顺序大致与优先级一致
+void Model::loadAsync(const std::shared_ptr<AsyncLoad> &load, const std::string &path, bool hasFocus, const glm::vec3 &focus)
+{
+    auto priorityOrder = [&](const std::vector<std::pair<glm::vec3, glm::vec3>> &bounds) {
+        std::vector<float> priority(bounds.size());
+        for (size_t i = 0; i < bounds.size(); ++i) {
+            glm::vec3 center = (bounds[i].first + bounds[i].second) * 0.5f;
+            float radius = glm::length(bounds[i].second - bounds[i].first) * 0.5f;
+            priority[i] = hasFocus ? radius / std::max(glm::length(center - focus) - radius, radius * 0.1f + 1e-6f) : radius;
+        }
+        std::vector<size_t> order(bounds.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return priority[a] > priority[b]; });
+        return order;
+    };
+
+    AsyncLoad::Item textures;
+    textures.kind = AsyncLoad::Item::Textures;
+    textures.hashed = MeshCache::hashFile(path, textures.sourceHash);
+
+    // 1. 缓存路径
+    if (textures.hashed) {
+        auto cache = std::make_shared<MeshCache>();
+        if (cache->open(MeshCache::pathFor(path), textures.sourceHash, kImportFlags)) {
+            std::vector<std::pair<glm::vec3, glm::vec3>> bounds(cache->meshCount());
+            for (size_t i = 0; i < cache->meshCount(); ++i) {
+                const MeshCacheEntry &e = cache->mesh(i);
+                bounds[i] = meshBounds(e.vertices, e.vertexCount, [](const Vertex &v) { return v.Position; });
+            }
+            textures.cache = cache;
+            textures.meshTotal = cache->meshCount();
+            load->push(std::move(textures));
+            for (size_t i : priorityOrder(bounds)) {
+                AsyncLoad::Item item;
+                item.kind = AsyncLoad::Item::MeshReady;
+                item.mesh = cacheMeshData(cache->mesh(i));
+                load->push(std::move(item));
+            }
+            AsyncLoad::Item done;
+            done.kind = AsyncLoad::Item::Done;
+            load->push(std::move(done));
+            return;
+        }
+    }
+
+    // 2. Assimp 路径
+    Assimp::Importer import;
+    const aiScene *scene = import.ReadFile(path, kImportFlags);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+        AsyncLoad::Item failed;
+        failed.kind = AsyncLoad::Item::Failed;
+        failed.error = import.GetErrorString();
+        load->push(std::move(failed));
+        return;
+    }
+
+    ThreadPool &pool = ThreadPool::shared();
+    std::vector<const aiMesh*> order;
+    processNode(scene->mRootNode, scene, order);
+    std::vector<int> meshImage;
+    collectTextures(scene, modelDirectory(path), pool, order, meshImage, textures.images);
+    textures.imageRefs.assign(textures.images.size(), 0);
+    for (int image : meshImage) {
+        if (image >= 0) ++textures.imageRefs[image];
+    }
+    textures.meshTotal = order.size();
+    load->push(std::move(textures));
+
+    std::vector<std::pair<glm::vec3, glm::vec3>> bounds(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        bounds[i] = meshBounds(order[i]->mVertices, order[i]->mNumVertices,
+                               [](const aiVector3D &v) { return glm::vec3(v.x, v.y, v.z); });
+    }
+    const std::vector<size_t> sorted = priorityOrder(bounds);
+    pool.parallelFor(sorted.size(), [&](size_t k) {
+        const size_t i = sorted[k];
+        AsyncLoad::Item item;
+        item.kind = AsyncLoad::Item::MeshReady;
+        item.mesh = convertMesh(order[i], &item.optimize);
+        item.mesh.image = meshImage[i];
+        load->push(std::move(item));
+    });
+    AsyncLoad::Item done;
+    done.kind = AsyncLoad::Item::Done;
+    load->push(std::move(done));
+}
+
+// 发布异步加载完成的网格
+// 纹理项总是先于网格项入队，因此网格到达时其纹理句柄已经创建
+size_t Model::update(size_t maxMeshes)
+{
+    if (!async || async->finished) return 0;
+    size_t published = 0;
+    for (;;) {
+        AsyncLoad::Item item;
+        {
+            std::lock_guard<std::mutex> lock(async->mutex);
+            if (async->items.empty()) break;
+            if (async->items.front().kind == AsyncLoad::Item::MeshReady && published >= maxMeshes) break;
+            item = std::move(async->items.front());
+            async->items.pop_front();
+        }
+
+        switch (item.kind) {
+        case AsyncLoad::Item::Textures: {
+            const std::string cachePath = item.hashed ? MeshCache::pathFor(async->path) : std::string();
+            if (item.cache) {
+                async->handles = createCacheTextures(item.cache, async->path, *async->textures);
+                stats.fromCache = true;
+            } else {
+                async->job = makeCacheJob(cachePath, item.sourceHash, item.images.size());
+                async->handles = createTextures(item.images, item.imageRefs, async->path, *async->textures, async->job);
+            }
+            async->meshTotal = item.meshTotal;
+            meshes.reserve(item.meshTotal);
+            break;
+        }
+        case AsyncLoad::Item::MeshReady:
+            stats.optimize += item.optimize;
+            addMesh(std::move(item.mesh), async->handles, async->job.get());
+            if (meshes.size() == 1) stats.firstMeshMs = elapsedMs(async->start);
+            ++published;
+            break;
+        case AsyncLoad::Item::Done:
+            async->finished = true;
+            stats.loadMs = stats.allMeshesMs = elapsedMs(async->start);
+            if (async->job && --async->job->remaining == 0) async->job->write();
+            async->job.reset();
+            return published;
+        case AsyncLoad::Item::Failed:
+            std::cout << "ERROR::ASSIMP::" << item.error << std::endl;
+            async->finished = true;
+            return published;
+        }
+    }
+    return published;
+}
+
+bool Model::loading() const
+{
+    return async && !async->finished;
+}
+
+size_t Model::expectedMeshCount() const
+{
+    return async ? async->meshTotal : meshes.size();
 }
 
-// 递归处理节点
+// CPU 转换阶段
+// 1. 收集节点树引用的网格，确定最终顺序
+// 2. 解析各网格的纹理来源并去重，每张不同的纹理只读取一次压缩数据
+// 3. 每个网格在线程池上独立转换并优化
+void Model::convertScene(const aiScene *scene, const std::string &directory, ThreadPool &pool, ModelData &out)
+{
+    std::vector<const aiMesh*> order;
+    processNode(scene->mRootNode, scene, order);
+
+    std::vector<int> meshImage;
+    collectTextures(scene, directory, pool, order, meshImage, out.images);
+
+    out.meshes.resize(order.size());
+    out.optimize.assign(order.size(), MeshOptimizeStats{});
+    pool.parallelFor(order.size(), [&](size_t i) {
+        out.meshes[i] = convertMesh(order[i], &out.optimize[i]);
+        out.meshes[i].image = meshImage[i];
+    });
+}
+
+// 转换并优化单个网格 (顶点/索引按精确大小一次性分配)
+// 优化包括顶点焊接、缓存/过度绘制重排、取数重排，随后划分网格簇并生成 LOD 链
+MeshData Model::convertMesh(const aiMesh *mesh, MeshOptimizeStats *optimize)
+{
+    MeshData out = processMesh(mesh);
+    mesh_optimize(out, optimize);
+    mesh_build_meshlets(out);
+    mesh_generate_lods(out, kMaxLodLevels);
+    return out;
+}
+
+// 解析并读取纹理
+// 1. 按 "来源 + 采样参数" 去重，编号顺序与网格首次引用顺序一致
+// 2. 在线程池上并行读取压缩数据，读取失败的纹理从列表中移除，对应网格按无纹理处理
+void Model::collectTextures(const aiScene *scene, const std::string &directory, ThreadPool &pool,
+                            const std::vector<const aiMesh*> &order, std::vector<int> &meshImage, std::vector<ModelImage> &images)
+{
+    images.clear();
+    meshImage.assign(order.size(), -1);
+    std::unordered_map<std::string, int> unique;
+    for (size_t i = 0; i < order.size(); ++i) {
+        const aiMesh *mesh = order[i];
+        ModelImage ref;
+        if (mesh->mMaterialIndex >= scene->mNumMaterials
+            || !loadMaterialTexture(scene->mMaterials[mesh->mMaterialIndex], scene, ref)) continue;
+        auto ins = unique.emplace(TextureRegistry::makeKey(ref.source, ref.sampler), static_cast<int>(images.size()));
+        if (ins.second) images.push_back(std::move(ref));
+        meshImage[i] = ins.first->second;
+    }
+
+    std::vector<char> ok(images.size(), 0);
+    pool.parallelFor(images.size(), [&](size_t i) {
+        ok[i] = readImage(scene, directory, images[i]) ? 1 : 0;
+    });
+
+    std::vector<int> remap(images.size(), -1);
+    size_t kept = 0;
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (!ok[i]) continue;
+        remap[i] = static_cast<int>(kept);
+        if (kept != i) images[kept] = std::move(images[i]);
+        ++kept;
+    }
+    images.resize(kept);
+    for (int &image : meshImage) {
+        if (image >= 0) image = remap[image];
+    }
+}
+
+// GL 阶段
+// 只负责按顺序创建缓冲区；纹理优先从注册表复用，否则以占位形式立即可用，解码与上传由 TextureStreamer 异步完成
+void Model::createMeshes(ModelData &data, const std::string &path, TextureRegistry &textures,
+                         const std::string &cachePath, uint64_t sourceHash)
+{
+    std::shared_ptr<CacheWriteJob> job = makeCacheJob(cachePath, sourceHash, data.images.size());
+
+    std::vector<size_t> refs(data.images.size(), 0);
+    for (const auto& md : data.meshes) {
+        if (md.image >= 0) ++refs[md.image];
+    }
+    std::vector<std::shared_ptr<GLTexture>> handles = createTextures(data.images, refs, path, textures, job);
+    for (const auto& o : data.optimize) stats.optimize += o;
+
+    meshes.reserve(meshes.size() + data.meshes.size());
+    for (auto& md : data.meshes) addMesh(std::move(md), handles, job.get());
+
+    // 网格全部加入后释放 "网格" 计数，纹理也已全部解码时立即写入缓存
+    if (job && --job->remaining == 0) job->write();
+}
+
+// 创建缓存写入任务 (cachePath 为空时不写缓存)
+// 计数为纹理数 + 1，最后一个计数在所有网格加入后释放
+std::shared_ptr<Model::CacheWriteJob> Model::makeCacheJob(const std::string &cachePath, uint64_t sourceHash, size_t imageCount)
+{
+    if (cachePath.empty()) return nullptr;
+    auto job = std::make_shared<CacheWriteJob>();
+    job->path = cachePath;
+    job->sourceHash = sourceHash;
+    job->inputs.resize(imageCount);
+    job->images.resize(imageCount);
+    job->remaining = imageCount + 1;
+    return job;
+}
+
+// 获取或提交纹理
+// refs: 各纹理被引用的网格数，用于共享统计
+std::vector<std::shared_ptr<GLTexture>> Model::createTextures(std::vector<ModelImage> &images, const std::vector<size_t> &refs,
+                                                              const std::string &path, TextureRegistry &textures,
+                                                              const std::shared_ptr<CacheWriteJob> &job)
+{
+    std::vector<std::shared_ptr<GLTexture>> handles(images.size());
+    for (size_t i = 0; i < images.size(); ++i) {
+        ModelImage& img = images[i];
+        TextureStreamer::DecodedCallback onDecoded;
+        if (job) {
+            job->inputs[i].source = img.source;
+            job->inputs[i].sampler = img.sampler;
+            onDecoded = [job, i](std::shared_ptr<const ImageData> image) {
+                job->images[i] = std::move(image);
+                if (--job->remaining == 0) job->write();
+            };
+        }
+
+        const std::string key = TextureRegistry::makeKey(textureSource(path, img.source), img.sampler);
+        handles[i] = textures.find(key);
+        if (handles[i]) {
+            // 已由其他模型加载：GL 纹理直接复用，只为写缓存在后台解码
+            ++stats.registryHits;
+            textureUses.push_back(TextureUse{ handles[i], refs[i] });
+            if (onDecoded) {
+                auto bytes = std::make_shared<std::vector<unsigned char>>(std::move(img.encoded));
+                ThreadPool::shared().submit([bytes, onDecoded] {
+                    auto image = std::make_shared<ImageData>();
+                    if (!TextureStreamer::decode(bytes->data(), bytes->size(), *image)) image.reset();
+                    onDecoded(image);
+                });
+            }
+        } else {
+            handles[i] = textures.loadEncoded(key, std::move(img.encoded), img.sampler, std::move(onDecoded));
+            textureUses.push_back(TextureUse{ handles[i], refs[i] ? refs[i] - 1 : 0 });
+        }
+    }
+    stats.uniqueTextures += images.size();
+    return handles;
+}
+
+// 从缓存获取或提交纹理
+// 缓存中的纹理已去重，并记录了来源与采样参数，可与其他模型共享；像素直接来自映射内存
+std::vector<std::shared_ptr<GLTexture>> Model::createCacheTextures(const std::shared_ptr<MeshCache> &cache,
+                                                                   const std::string &path, TextureRegistry &textures)
+{
+    std::vector<size_t> refs(cache->imageCount(), 0);
+    for (size_t i = 0; i < cache->meshCount(); ++i) {
+        if (cache->mesh(i).image >= 0) ++refs[cache->mesh(i).image];
+    }
+
+    std::vector<std::shared_ptr<GLTexture>> handles(cache->imageCount());
+    for (size_t i = 0; i < cache->imageCount(); ++i) {
+        const ImageCacheEntry& img = cache->image(i);
+        const std::string key = TextureRegistry::makeKey(textureSource(path, img.source), img.sampler);
+        handles[i] = textures.find(key);
+        if (handles[i]) {
+            ++stats.registryHits;
+            textureUses.push_back(TextureUse{ handles[i], refs[i] });
+        } else {
+            handles[i] = textures.loadPixels(key, img.width, img.height, img.pixels, cache, img.sampler);
+            textureUses.push_back(TextureUse{ handles[i], refs[i] ? refs[i] - 1 : 0 });
+        }
+    }
+    stats.uniqueTextures += cache->imageCount();
+    return handles;
+}
+
+// 创建单个网格的 GL 资源并累计统计
+// 提供 job 时缓存写入任务保留一份 CPU 数据，Mesh 使用拷贝
+void Model::addMesh(MeshData &&md, const std::vector<std::shared_ptr<GLTexture>> &handles, CacheWriteJob *job)
+{
+    std::vector<Texture> meshTextures;
+    if (md.image >= 0 && size_t(md.image) < handles.size()) {
+        meshTextures = makeTextures(handles[md.image]);
+        ++stats.textureRefs;
+    }
+    stats.vertexCount += md.vertices.size();
+    stats.indexCount += md.indices.size();
+    if (job) {
+        meshes.emplace_back(md.vertices, md.indices, std::move(meshTextures), options.vertexFormat, options.geometryPool, md.lods, md.meshlets);
+        job->meshes.push_back(std::move(md));
+    } else {
+        meshes.emplace_back(std::move(md.vertices), std::move(md.indices), std::move(meshTextures), options.vertexFormat,
+                            options.geometryPool, std::move(md.lods), std::move(md.meshlets));
+    }
+
+    const Mesh &m = meshes.back();
+    stats.meshCount = meshes.size();
+    stats.vertexBytes += m.vertexBytes();
+    stats.indexBytes += m.indexBytes();
+    for (int l = 0; l < m.lodCount() && l < kMaxLodLevels; ++l) stats.lodTriangles[l] += m.lods[l].indexCount / 3;
+    stats.meshletCount += m.meshlets.size();
+}
+
+// 从缓存创建网格
+// 顶点/索引流与纹理像素都直接来自映射内存，无需任何解析或解码
+void Model::loadFromCache(const std::shared_ptr<MeshCache> &cache, const std::string &path, TextureRegistry &textures)
+{
+    std::vector<std::shared_ptr<GLTexture>> handles = createCacheTextures(cache, path, textures);
+    meshes.reserve(cache->meshCount());
+    for (size_t i = 0; i < cache->meshCount(); ++i) {
+        addMesh(cacheMeshData(cache->mesh(i)), handles, nullptr);
+    }
+}
+
+// 递归收集节点
 // node: 当前处理的 Assimp 节点
 // scene: Assimp 场景对象，包含所有网格和材质数据
-void Model::processNode(aiNode *node, const aiScene *scene)
+void Model::processNode(const aiNode *node, const aiScene *scene, std::vector<const aiMesh*> &order)
 {
-    // 处理当前节点引用的所有网格
+    // 节点中只存储了网格的索引，实际的网格数据在 scene->mMeshes 中
+    // 只收集三角形网格 (线段、点图元的索引数不是 3 的倍数，后续的优化与 LOD 生成都按三角形处理)
     for(unsigned int i = 0; i < node->mNumMeshes; i++)
     {
-        // 节点中只存储了网格的索引，实际的网格数据在 scene->mMeshes 中
-        aiMesh *mesh = scene->mMeshes[node->mMeshes[i]]; 
-        meshes.push_back(processMesh(mesh, scene));         
+        const aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
+        if (mesh->mPrimitiveTypes & ~unsigned(aiPrimitiveType_TRIANGLE)) continue;
+        order.push_back(mesh);
     }
     // 递归处理所有子节点
     for(unsigned int i = 0; i < node->mNumChildren; i++)
     {
-        processNode(node->mChildren[i], scene);
+        processNode(node->mChildren[i], scene, order);
     }
 }
 
-// 将 Assimp 的 mesh 数据转换为我们自定义的 Mesh 类
-Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
+// 将 Assimp 的 mesh 数据转换为 CPU 端网格数据
+// 在工作线程上执行：顶点与索引数组按精确大小预分配后直接写入
+MeshData Model::processMesh(const aiMesh *mesh)
 {
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-    std::vector<Texture> textures;
-
-    // 统计纹理坐标集的数量
-    int uvSets = 0;
-    for (unsigned int i = 0; i < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++i) {
-        if (mesh->mTextureCoords[i]) ++uvSets;
-    }
+    MeshData out;
 
-    // 遍历网格的每个顶点
-    for(unsigned int i = 0; i < mesh->mNumVertices; i++)
+    // 1. 顶点：位置、法线、第一组纹理坐标
+    // Assimp 允许一个顶点有多个纹理坐标（最多8个），我们只关心第一组（索引0）
+    const unsigned int vertexCount = mesh->mNumVertices;
+    out.vertices.resize(vertexCount);
+    const bool hasNormals = mesh->HasNormals();
+    const aiVector3D* uvs = mesh->mTextureCoords[0];
+    for(unsigned int i = 0; i < vertexCount; i++)
     {
-        Vertex vertex;
-        glm::vec3 vector;
-        
-        // 1. 处理位置
-        vector.x = mesh->mVertices[i].x;
-        vector.y = mesh->mVertices[i].y;
-        vector.z = mesh->mVertices[i].z;
-        vertex.Position = vector;
-        
-        // 2. 处理法线
-        if (mesh->HasNormals()) {
-            vector.x = mesh->mNormals[i].x;
-            vector.y = mesh->mNormals[i].y;
-            vector.z = mesh->mNormals[i].z;
-            vertex.Normal = vector;
-        } else {
-            vertex.Normal = glm::vec3(0.0f);
-        }
-
-        // 3. 处理纹理坐标
-        // Assimp 允许一个顶点有多个纹理坐标（最多8个），我们只关心第一组（索引0）
-        if(mesh->mTextureCoords[0]) 
-        {
-            glm::vec2 vec;
-            vec.x = mesh->mTextureCoords[0][i].x;
-            vec.y = mesh->mTextureCoords[0][i].y;
-            vertex.TexCoords = vec;
-        }
-        else
-        {
-            vertex.TexCoords = glm::vec2(0.0f, 0.0f);
-        }
-        
-        vertices.push_back(vertex);
+        Vertex& v = out.vertices[i];
+        v.Position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+        v.Normal = hasNormals ? glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z) : glm::vec3(0.0f);
+        v.TexCoords = uvs ? glm::vec2(uvs[i].x, uvs[i].y) : glm::vec2(0.0f);
     }
-    
-    // 处理索引（面数据）
+
+    // 2. 索引（面数据）：先统计总数再一次性分配
+    size_t indexCount = 0;
+    for(unsigned int i = 0; i < mesh->mNumFaces; i++)
+        indexCount += mesh->mFaces[i].mNumIndices;
+    out.indices.resize(indexCount);
+    unsigned int* dst = out.indices.data();
     for(unsigned int i = 0; i < mesh->mNumFaces; i++)
     {
-        aiFace face = mesh->mFaces[i];
-        // 获取面对应的所有顶点索引
-        for(unsigned int j = 0; j < face.mNumIndices; j++)
-            indices.push_back(face.mIndices[j]);
-    }
-    
-    // 处理材质
-    if(mesh->mMaterialIndex >= 0)
-    {
-        aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
-        
-        // 加载材质中的纹理（目前只处理了内嵌纹理的逻辑）
-        std::vector<Texture> colorMaps = loadMaterialTextures(material, scene);
-        
-        textures.insert(textures.end(), colorMaps.begin(), colorMaps.end());
+        const aiFace& face = mesh->mFaces[i];
+        std::memcpy(dst, face.mIndices, face.mNumIndices * sizeof(unsigned int));
+        dst += face.mNumIndices;
     }
 
-    return Mesh(vertices, indices, textures);
+    return out;
 }
 
-// 加载材质纹理
-// 目前主要处理 GLTF 等格式中的内嵌纹理
-std::vector<Texture> Model::loadMaterialTextures(aiMaterial *mat, const aiScene* scene)
+// 解析材质纹理
+// 内嵌纹理统一记为 "*N" (GLTF 中按文件名引用的内嵌纹理也会归一到索引)，外部纹理保留材质中的相对路径
+bool Model::loadMaterialTexture(const aiMaterial *mat, const aiScene* scene, ModelImage &out)
 {
-    std::vector<Texture> out;
-    aiString texPathBase;
-    aiString texPathDiff;
-    
+    aiString texPath;
+    aiTextureMapMode mapMode[3] = { aiTextureMapMode_Wrap, aiTextureMapMode_Wrap, aiTextureMapMode_Wrap };
+
     // 尝试获取基础颜色纹理（PBR 工作流）或漫反射纹理（传统工作流）
-    bool hasBase = (AI_SUCCESS == mat->GetTexture(aiTextureType_BASE_COLOR, 0, &texPathBase));
-    bool hasDiff = (AI_SUCCESS == mat->GetTexture(aiTextureType_DIFFUSE, 0, &texPathDiff));
-    
-    const char* query = nullptr;
-    if (hasBase) {
-        query = texPathBase.C_Str();
-    } else if (hasDiff) {
-        query = texPathDiff.C_Str();
-    }
-    
-    if (!query || !scene) {
-        return out;
-    }
-
-    // 检查是否为内嵌纹理（以 * 开头，或者路径指向 scene->mTextures 中的索引）
-    const aiTexture* at = scene->GetEmbeddedTexture(query);
-   
-    Texture t{};
-    t.type = "texture_diffuse";
-    GLuint tex = 0;
-    
-    if (at) {
-        // 如果是内嵌纹理
-        if (at->mHeight == 0) {
-            // 压缩格式（如 png/jpg 数据的二进制流）
-            int w=0,h=0,ch=0;
-            stbi_set_flip_vertically_on_load(false); // 加载模型纹理时通常不需要翻转
-            const unsigned char* mem = reinterpret_cast<const unsigned char*>(at->pcData);
-            unsigned char* data = stbi_load_from_memory(mem, (int)at->mWidth, &w, &h, &ch, 4);
-            if (data) {   
-                glGenTextures(1, &tex);
-                glBindTexture(GL_TEXTURE_2D, tex);
-                
-                // 设置纹理参数
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-                
-                glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-                // 上传纹理数据
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-                glGenerateMipmap(GL_TEXTURE_2D);
-                
-                glBindTexture(GL_TEXTURE_2D, 0);
-                stbi_image_free(data);
-            }
-        } 
-        // 这里的逻辑可以扩展处理未压缩的 raw 数据 (at->mHeight > 0)
-    } 
-    
-    t.id = tex;
-    if (t.id != 0) {
-        out.push_back(t);
+    bool found = AI_SUCCESS == mat->GetTexture(aiTextureType_BASE_COLOR, 0, &texPath, nullptr, nullptr, nullptr, nullptr, mapMode);
+    if (!found) {
+        found = AI_SUCCESS == mat->GetTexture(aiTextureType_DIFFUSE, 0, &texPath, nullptr, nullptr, nullptr, nullptr, mapMode);
     }
-    return out;
+    if (!found || !scene || texPath.length == 0) {
+        return false;
+    }
+
+    std::pair<const aiTexture*, int> embedded = scene->GetEmbeddedTextureAndIndex(texPath.C_Str());
+    if (embedded.first) {
+        // 这里的逻辑可以扩展处理未压缩的 raw 数据 (mHeight > 0)
+        if (embedded.first->mHeight != 0) return false;
+        out.source = "*" + std::to_string(embedded.second);
+    } else {
+        out.source = texPath.C_Str();
+    }
+    out.sampler.wrapS = wrapMode(mapMode[0]);
+    out.sampler.wrapT = wrapMode(mapMode[1]);
+    return true;
+}
+
+// 读取纹理压缩数据
+// 在工作线程上执行；解码由 TextureStreamer 在后台完成
+bool Model::readImage(const aiScene *scene, const std::string &directory, ModelImage &image)
+{
+    if (!image.source.empty() && image.source[0] == '*') {
+        // 内嵌纹理：压缩格式（如 png/jpg 数据的二进制流），拷贝出来供后台解码
+        const aiTexture* at = scene->GetEmbeddedTexture(image.source.c_str());
+        if (!at || at->mHeight != 0) return false;
+        const unsigned char* mem = reinterpret_cast<const unsigned char*>(at->pcData);
+        image.encoded.assign(mem, mem + at->mWidth);
+        return !image.encoded.empty();
+    }
+
+    MappedFile file;
+    if (!file.open(directory.empty() ? image.source : directory + "/" + image.source)) {
+        std::cout << "WARNING::MODEL::texture not found: " << image.source << std::endl;
+        return false;
+    }
+    image.encoded.assign(file.data(), file.data() + file.size());
+    return !image.encoded.empty();
 }
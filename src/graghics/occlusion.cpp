@@ -0,0 +1,294 @@
+#include "occlusion.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define OCCLUSION_SSE 1
+#endif
+
+namespace {
+
+// 并行测试时每个任务处理的包围盒数
+const size_t kTestChunk = 1024;
+// 包围盒最近深度的偏移 (NDC 深度)：与包围盒表面重合的遮挡体 (如网格自身的代理) 不会因舍入误差遮挡它
+const float kDepthBias = 1e-6f;
+
+// 裁剪空间外码：x/y 的 4 个平面与远平面 (近平面单独裁剪)
+int outcode(const glm::vec4& v)
+{
+    return (v.x < -v.w ? 1 : 0) | (v.x > v.w ? 2 : 0) | (v.y < -v.w ? 4 : 0) | (v.y > v.w ? 8 : 0) | (v.z > v.w ? 16 : 0);
+}
+
+// 到近平面 (z = -w) 的有符号距离，非负时在平面内侧
+float nearDistance(const glm::vec4& v)
+{
+    return v.z + v.w;
+}
+
+} // namespace
+
+OcclusionBuffer::OcclusionBuffer(int width, int height)
+{
+    resize(width, height);
+}
+
+void OcclusionBuffer::resize(int width, int height)
+{
+    width_ = std::max(kTileSize, (width + kTileSize - 1) / kTileSize * kTileSize);
+    height_ = std::max(kTileSize, (height + kTileSize - 1) / kTileSize * kTileSize);
+    tilesX_ = width_ / kTileSize;
+    tilesY_ = height_ / kTileSize;
+    depth_.assign(size_t(width_) * height_, 1.0f);
+    tileMax_.assign(size_t(tilesX_) * tilesY_, 1.0f);
+}
+
+void OcclusionBuffer::begin(const glm::mat4& viewProj)
+{
+    viewProj_ = viewProj;
+    occluders_.clear();
+    stats_ = OcclusionRasterStats{};
+    std::fill(depth_.begin(), depth_.end(), 1.0f);
+    std::fill(tileMax_.begin(), tileMax_.end(), 1.0f);
+}
+
+void OcclusionBuffer::addOccluder(const OccluderMesh& mesh, const glm::mat4& modelMatrix)
+{
+    occluders_.push_back({ &mesh, modelMatrix });
+    ++stats_.occluders;
+    stats_.triangles += mesh.triangleCount();
+}
+
+// 投影到屏幕并建立边函数与深度平面
+// 两面都光栅化 (代理网格不保证封闭)，顺时针的三角形交换两个顶点后统一按逆时针处理
+void OcclusionBuffer::emitTriangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2, std::vector<ScreenTri>& out) const
+{
+    glm::vec3 p[3];
+    const glm::vec4* v[3] = { &v0, &v1, &v2 };
+    for (int k = 0; k < 3; ++k) {
+        const float invW = 1.0f / v[k]->w;
+        p[k] = glm::vec3((v[k]->x * invW * 0.5f + 0.5f) * float(width_),
+                         (v[k]->y * invW * 0.5f + 0.5f) * float(height_),
+                         v[k]->z * invW * 0.5f + 0.5f);
+    }
+    float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y);
+    if (std::abs(area) < 1e-8f) return;
+    if (area < 0.0f) {
+        std::swap(p[1], p[2]);
+        area = -area;
+    }
+
+    // 覆盖的像素中心范围
+    const float minX = std::min(p[0].x, std::min(p[1].x, p[2].x)), maxX = std::max(p[0].x, std::max(p[1].x, p[2].x));
+    const float minY = std::min(p[0].y, std::min(p[1].y, p[2].y)), maxY = std::max(p[0].y, std::max(p[1].y, p[2].y));
+    ScreenTri t;
+    t.minX = std::max(0, int(std::ceil(minX - 0.5f)));
+    t.maxX = std::min(width_ - 1, int(std::floor(maxX - 0.5f)));
+    t.minY = std::max(0, int(std::ceil(minY - 0.5f)));
+    t.maxY = std::min(height_ - 1, int(std::floor(maxY - 0.5f)));
+    if (t.minX > t.maxX || t.minY > t.maxY) return;
+
+    for (int k = 0; k < 3; ++k) {
+        const glm::vec3& a = p[k];
+        const glm::vec3& b = p[(k + 1) % 3];
+        t.a[k] = a.y - b.y;
+        t.b[k] = b.x - a.x;
+        t.c[k] = a.x * b.y - a.y * b.x;
+    }
+    const float dx1 = p[1].x - p[0].x, dy1 = p[1].y - p[0].y, dz1 = p[1].z - p[0].z;
+    const float dx2 = p[2].x - p[0].x, dy2 = p[2].y - p[0].y, dz2 = p[2].z - p[0].z;
+    t.zx = (dz1 * dy2 - dy1 * dz2) / area;
+    t.zy = (dx1 * dz2 - dz1 * dx2) / area;
+    t.z0 = p[0].z - t.zx * p[0].x - t.zy * p[0].y;
+    out.push_back(t);
+}
+
+// 三角形设置
+// 全部顶点在同一个平面 (x/y/远平面) 外侧的三角形直接丢弃；跨越近平面的三角形裁剪为至多 4 边形后按扇形拆分
+void OcclusionBuffer::setupOccluder(size_t index)
+{
+    const Occluder& o = occluders_[index];
+    std::vector<ScreenTri>& out = tris_[index];
+    out.clear();
+    const glm::mat4 mvp = viewProj_ * o.modelMatrix;
+    thread_local std::vector<glm::vec4> clip;
+    const std::vector<glm::vec3>& positions = o.mesh->positions;
+    clip.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) clip[i] = mvp * glm::vec4(positions[i], 1.0f);
+
+    const std::vector<uint32_t>& indices = o.mesh->indices;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const glm::vec4 v[3] = { clip[indices[i]], clip[indices[i + 1]], clip[indices[i + 2]] };
+        if (outcode(v[0]) & outcode(v[1]) & outcode(v[2])) continue;
+        const float d[3] = { nearDistance(v[0]), nearDistance(v[1]), nearDistance(v[2]) };
+        if (d[0] >= 0.0f && d[1] >= 0.0f && d[2] >= 0.0f) {
+            emitTriangle(v[0], v[1], v[2], out);
+            continue;
+        }
+        if (d[0] < 0.0f && d[1] < 0.0f && d[2] < 0.0f) continue;
+
+        glm::vec4 poly[4];
+        int n = 0;
+        for (int k = 0; k < 3; ++k) {
+            const int next = (k + 1) % 3;
+            if (d[k] >= 0.0f) poly[n++] = v[k];
+            if ((d[k] >= 0.0f) != (d[next] >= 0.0f)) poly[n++] = v[k] + (v[next] - v[k]) * (d[k] / (d[k] - d[next]));
+        }
+        for (int k = 1; k + 1 < n; ++k) emitTriangle(poly[0], poly[k], poly[k + 1], out);
+    }
+}
+
+// 行带光栅化
+// 每行以 4 像素为一组 (起点对齐到 4) 直接求边函数与深度 (不做增量累加，避免误差)，覆盖的像素取较近的深度
+void OcclusionBuffer::rasterizeBand(int tileRow)
+{
+    const int y0 = tileRow * kTileSize;
+    const int y1 = y0 + kTileSize;
+    for (const std::vector<ScreenTri>& tris : tris_) {
+        for (const ScreenTri& t : tris) {
+            if (t.maxY < y0 || t.minY >= y1) continue;
+            const int ys = std::max(t.minY, y0), ye = std::min(t.maxY, y1 - 1);
+            const int xs = t.minX & ~3;
+            for (int y = ys; y <= ye; ++y) {
+                const float py = float(y) + 0.5f;
+                float* row = &depth_[size_t(y) * width_];
+#ifdef OCCLUSION_SSE
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 a0 = _mm_set1_ps(t.a[0]), a1 = _mm_set1_ps(t.a[1]), a2 = _mm_set1_ps(t.a[2]);
+                const __m128 r0 = _mm_set1_ps(t.b[0] * py + t.c[0]);
+                const __m128 r1 = _mm_set1_ps(t.b[1] * py + t.c[1]);
+                const __m128 r2 = _mm_set1_ps(t.b[2] * py + t.c[2]);
+                const __m128 zx = _mm_set1_ps(t.zx), zr = _mm_set1_ps(t.zy * py + t.z0);
+                const __m128 four = _mm_set1_ps(4.0f);
+                __m128 px = _mm_add_ps(_mm_set1_ps(float(xs) + 0.5f), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+                for (int x = xs; x <= t.maxX; x += 4, px = _mm_add_ps(px, four)) {
+                    __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), r0), zero);
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), r1), zero));
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), r2), zero));
+                    if (!_mm_movemask_ps(inside)) continue;
+                    const __m128 z = _mm_add_ps(_mm_mul_ps(zx, px), zr);
+                    const __m128 d = _mm_loadu_ps(row + x);
+                    const __m128 nearer = _mm_min_ps(d, z);
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, d)));
+                }
+#else
+                for (int x = xs; x <= t.maxX; ++x) {
+                    const float pxs = float(x) + 0.5f;
+                    bool inside = true;
+                    for (int k = 0; k < 3 && inside; ++k) inside = t.a[k] * pxs + (t.b[k] * py + t.c[k]) >= 0.0f;
+                    if (!inside) continue;
+                    row[x] = std::min(row[x], t.zx * pxs + (t.zy * py + t.z0));
+                }
+#endif
+            }
+        }
+    }
+
+    // 块的最大深度
+    for (int tx = 0; tx < tilesX_; ++tx) {
+        float m = 0.0f;
+        for (int y = y0; y < y1; ++y) {
+            const float* row = &depth_[size_t(y) * width_ + size_t(tx) * kTileSize];
+            for (int x = 0; x < kTileSize; ++x) m = std::max(m, row[x]);
+        }
+        tileMax_[size_t(tileRow) * tilesX_ + tx] = m;
+    }
+}
+
+void OcclusionBuffer::rasterize(ThreadPool* pool)
+{
+    tris_.resize(occluders_.size());
+    const bool parallel = pool && pool->threadCount() > 0;
+    if (parallel && occluders_.size() > 1) pool->parallelFor(occluders_.size(), [this](size_t i) { setupOccluder(i); });
+    else for (size_t i = 0; i < occluders_.size(); ++i) setupOccluder(i);
+
+    stats_.rasterized = 0;
+    for (const auto& tris : tris_) stats_.rasterized += tris.size();
+
+    // 各行带写入互不重叠的行与块
+    if (parallel) pool->parallelFor(size_t(tilesY_), [this](size_t r) { rasterizeBand(int(r)); });
+    else for (int r = 0; r < tilesY_; ++r) rasterizeBand(r);
+}
+
+bool OcclusionBuffer::occluded(const glm::vec3& center, const glm::vec3& extent) const
+{
+    glm::vec3 lo(0.0f), hi(0.0f);
+    float zNear = 1.0f;
+    for (int k = 0; k < 8; ++k) {
+        const glm::vec3 corner = center + extent * glm::vec3((k & 1) ? 1.0f : -1.0f, (k & 2) ? 1.0f : -1.0f, (k & 4) ? 1.0f : -1.0f);
+        const glm::vec4 p = viewProj_ * glm::vec4(corner, 1.0f);
+        if (p.w <= 0.0f || nearDistance(p) < 0.0f) return false;
+        const glm::vec3 ndc = glm::vec3(p) / p.w;
+        lo = k ? glm::min(lo, ndc) : ndc;
+        hi = k ? glm::max(hi, ndc) : ndc;
+        zNear = std::min(zNear, ndc.z * 0.5f + 0.5f);
+    }
+    const float sx0 = (lo.x * 0.5f + 0.5f) * float(width_), sx1 = (hi.x * 0.5f + 0.5f) * float(width_);
+    const float sy0 = (lo.y * 0.5f + 0.5f) * float(height_), sy1 = (hi.y * 0.5f + 0.5f) * float(height_);
+    if (sx1 < 0.0f || sy1 < 0.0f || sx0 >= float(width_) || sy0 >= float(height_)) return false;
+    const int x0 = std::max(0, int(std::floor(sx0)) - 1), x1 = std::min(width_ - 1, int(sx1) + 1);
+    const int y0 = std::max(0, int(std::floor(sy0)) - 1), y1 = std::min(height_ - 1, int(sy1) + 1);
+    zNear -= kDepthBias;
+
+    for (int ty = y0 / kTileSize; ty <= y1 / kTileSize; ++ty) {
+        for (int tx = x0 / kTileSize; tx <= x1 / kTileSize; ++tx) {
+            if (tileMax_[size_t(ty) * tilesX_ + tx] < zNear) continue;
+            const int px0 = std::max(x0, tx * kTileSize), px1 = std::min(x1, tx * kTileSize + kTileSize - 1);
+            const int py0 = std::max(y0, ty * kTileSize), py1 = std::min(y1, ty * kTileSize + kTileSize - 1);
+            for (int y = py0; y <= py1; ++y) {
+                const float* row = &depth_[size_t(y) * width_];
+                for (int x = px0; x <= px1; ++x) {
+                    if (row[x] >= zNear) return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+size_t OcclusionBuffer::cullBoxes(const AabbSoA& boxes, std::vector<uint8_t>& visible, ThreadPool* pool) const
+{
+    const size_t n = std::min(boxes.size(), visible.size());
+    auto testRange = [&](size_t begin, size_t end) {
+        size_t count = 0;
+        for (size_t i = begin; i < end; ++i) {
+            if (!visible[i] || boxes.ex[i] < 0.0f) continue;
+            if (occluded(glm::vec3(boxes.cx[i], boxes.cy[i], boxes.cz[i]), glm::vec3(boxes.ex[i], boxes.ey[i], boxes.ez[i]))) {
+                visible[i] = 0;
+                ++count;
+            }
+        }
+        return count;
+    };
+    if (!pool || pool->threadCount() == 0 || n <= kTestChunk) return testRange(0, n);
+
+    std::atomic<size_t> count{0};
+    const size_t chunks = (n + kTestChunk - 1) / kTestChunk;
+    pool->parallelFor(chunks, [&](size_t c) {
+        const size_t begin = c * kTestChunk;
+        count += testRange(begin, std::min(n, begin + kTestChunk));
+    });
+    return count;
+}
+
+void OcclusionBuffer::debugImage(std::vector<uint8_t>& rgba) const
+{
+    float zMin = 1.0f, zMax = 0.0f;
+    for (float z : depth_) {
+        if (z >= 1.0f) continue;
+        zMin = std::min(zMin, z);
+        zMax = std::max(zMax, z);
+    }
+    const float scale = zMax > zMin ? 1.0f / (zMax - zMin) : 0.0f;
+    rgba.resize(depth_.size() * 4);
+    for (size_t i = 0; i < depth_.size(); ++i) {
+        const float z = depth_[i];
+        const uint8_t g = z >= 1.0f ? 0 : uint8_t(255.0f - 200.0f * (z - zMin) * scale);
+        rgba[i * 4 + 0] = g;
+        rgba[i * 4 + 1] = g;
+        rgba[i * 4 + 2] = g;
+        rgba[i * 4 + 3] = 255;
+    }
+}
@@ -0,0 +1,159 @@
+#include "program_cache.h"
+#include "hash.h"
+#include "mapped_file.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+const char kMagic[8] = { 'A', 'S', 'D', 'P', 'R', 'O', 'G', 'B' };
+
+// 文件头 (其后紧跟 size 字节的程序二进制)
+struct BinaryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t format;      // glGetProgramBinary 返回的二进制格式
+    uint64_t sourceHash;  // 源码与宏定义哈希
+    uint64_t driverHash;  // 驱动字符串哈希
+    uint64_t size;
+};
+
+// 读取 GL 字符串 (上下文无效时返回空串)
+std::string glString(GLenum name)
+{
+    const GLubyte* s = glGetString(name);
+    return s ? reinterpret_cast<const char*>(s) : std::string();
+}
+
+} // namespace
+
+ProgramBinaryCache::ProgramBinaryCache(std::string directory)
+    : directory_(std::move(directory))
+    , driverHash_(0)
+    , supported_(false)
+{
+    // 驱动信息以换行分隔后整体哈希，任一字段变化都会让旧二进制失效
+    const std::string driver = glString(GL_VENDOR) + "\n" + glString(GL_RENDERER) + "\n" + glString(GL_VERSION)
+                             + "\n" + glString(GL_SHADING_LANGUAGE_VERSION);
+    driverHash_ = fnv1a64(driver.data(), driver.size());
+
+    // 函数指针只在 GL 4.1 或 ARB_get_program_binary 可用时加载
+    if (glGetProgramBinary && glProgramBinary && glProgramParameteri) {
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        supported_ = formats > 0;
+    }
+}
+
+uint64_t ProgramBinaryCache::sourceHash(const std::string& vert, const std::string& frag, const std::string& defines)
+{
+    // 各段之间混入长度，避免拼接边界不同的输入产生相同哈希
+    uint64_t h = kFnv64Offset;
+    for (const std::string* s : { &defines, &vert, &frag }) {
+        uint64_t len = s->size();
+        h = fnv1a64(&len, sizeof(len), h);
+        h = fnv1a64(s->data(), s->size(), h);
+    }
+    return h;
+}
+
+std::string ProgramBinaryCache::pathFor(uint64_t source) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(fnv1a64(&driverHash_, sizeof(driverHash_), source)));
+    return directory_ + "/" + name + ".progbin";
+}
+
+// 从缓存加载
+// 1. 校验文件头 (版本、源码哈希、驱动哈希、长度)
+// 2. glProgramBinary 后检查链接状态，驱动拒绝时删除文件，由调用方回退到源码编译
+GLuint ProgramBinaryCache::load(const std::string& vert, const std::string& frag, const std::string& defines)
+{
+    if (!supported_) return 0;
+    const uint64_t source = sourceHash(vert, frag, defines);
+    const std::string path = pathFor(source);
+
+    MappedFile f;
+    BinaryHeader header;
+    if (!f.open(path) || f.size() < sizeof(BinaryHeader)) {
+        ++stats_.misses;
+        return 0;
+    }
+    std::memcpy(&header, f.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion
+        || header.sourceHash != source || header.driverHash != driverHash_
+        || header.size != f.size() - sizeof(BinaryHeader)) {
+        ++stats_.misses;
+        return 0;
+    }
+
+    GLuint p = glCreateProgram();
+    glProgramBinary(p, header.format, f.data() + sizeof(BinaryHeader), static_cast<GLsizei>(header.size));
+    GLint ok = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        glDeleteProgram(p);
+        f.close();
+        std::remove(path.c_str());
+        ++stats_.rejected;
+        return 0;
+    }
+    ++stats_.hits;
+    return p;
+}
+
+void ProgramBinaryCache::prepare(GLuint program) const
+{
+    if (supported_) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+bool ProgramBinaryCache::store(GLuint program, const std::string& vert, const std::string& frag, const std::string& defines)
+{
+    if (!supported_) return false;
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return false;
+
+    std::vector<unsigned char> binary(static_cast<size_t>(length));
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) return false;
+
+    BinaryHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.format = format;
+    header.sourceHash = sourceHash(vert, frag, defines);
+    header.driverHash = driverHash_;
+    header.size = static_cast<uint64_t>(written);
+
+    // 先写临时文件再替换 (Windows 下 rename 不会覆盖已存在文件)
+    const std::string path = pathFor(header.sourceHash);
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(binary.data()), written);
+        if (!out) {
+            out.close();
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    std::remove(path.c_str());
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    ++stats_.stored;
+    return true;
+}
+
+void ProgramBinaryCache::remove(const std::string& vert, const std::string& frag, const std::string& defines)
+{
+    std::remove(pathFor(sourceHash(vert, frag, defines)).c_str());
+}
@@ -0,0 +1,171 @@
+#include "render_queue.h"
+#include "shader.h"
+#include "cube.h"
+#include "uniform_buffers.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const uint32_t kDepthBits = 24;
+const uint32_t kDepthMax = (1u << kDepthBits) - 1;
+
+} // namespace
+
+uint64_t RenderQueue::makeKey(uint32_t pass, uint32_t program, uint32_t material, uint32_t geometry, float depth01) {
+    const float d = std::min(std::max(depth01, 0.0f), 1.0f);
+    const uint64_t depth = static_cast<uint64_t>(d * float(kDepthMax));
+    return (uint64_t(pass & 0xF) << 60)
+         | (uint64_t(program & 0xFF) << 52)
+         | (uint64_t(material & 0xFFFF) << 36)
+         | (uint64_t(geometry & 0xFF) << 28)
+         | (depth << 4);
+}
+
+void RenderQueue::clear() {
+    packets_.clear();
+    order_.clear();
+    for (size_t& b : passBegin_) b = 0;
+}
+
+uint32_t RenderQueue::programId(const Shader* shader) {
+    for (size_t i = 0; i < programs_.size(); ++i) {
+        if (programs_[i] == shader) return static_cast<uint32_t>(i);
+    }
+    programs_.push_back(shader);
+    return static_cast<uint32_t>(programs_.size() - 1);
+}
+
+void RenderQueue::push(const RenderView& view, DrawPacket& packet, uint32_t material, uint32_t geometry, float distance) {
+    const float depth01 = view.depthRange > 0.0f ? distance / view.depthRange : 0.0f;
+    packet.key = makeKey(view.pass, programId(packet.shader), material, geometry, depth01);
+    packet.lodPass = view.lodPass;
+    packets_.push_back(packet);
+}
+
+void RenderQueue::submitMesh(const RenderView& view, Shader& shader, Mesh& mesh, uint32_t objectSlot, const glm::mat4& modelMatrix) {
+    glm::vec3 c;
+    float r = 0.0f;
+    mesh.worldSphere(modelMatrix, c, r);
+    DrawPacket p;
+    p.shader = &shader;
+    p.mesh = &mesh;
+    p.objectSlot = objectSlot;
+    p.kind = DrawPacket::MeshLodDraw;
+    push(view, p, mesh.materialId(), mesh.vertexArray(), std::max(0.0f, glm::length(c - view.eye) - r));
+}
+
+void RenderQueue::submitStream(const RenderView& view, Shader& shader, Mesh& mesh, uint32_t objectSlot, const glm::mat4& modelMatrix,
+                               uint32_t firstIndex, uint32_t indexCount) {
+    if (indexCount == 0 || !mesh.geometryPool()) return;
+    glm::vec3 c;
+    float r = 0.0f;
+    mesh.worldSphere(modelMatrix, c, r);
+    DrawPacket p;
+    p.shader = &shader;
+    p.mesh = &mesh;
+    p.objectSlot = objectSlot;
+    p.firstIndex = firstIndex;
+    p.indexCount = indexCount;
+    p.kind = DrawPacket::MeshStreamDraw;
+    push(view, p, mesh.materialId(), mesh.geometryPool()->streamVertexArray(), std::max(0.0f, glm::length(c - view.eye) - r));
+}
+
+void RenderQueue::submitCubes(const RenderView& view, Shader& shader, Cube& cube, uint32_t instanceCount,
+                              const glm::vec3& center, float radius) {
+    if (instanceCount == 0) return;
+    DrawPacket p;
+    p.shader = &shader;
+    p.cube = &cube;
+    p.instanceCount = instanceCount;
+    p.kind = DrawPacket::CubeInstancesDraw;
+    push(view, p, 0, cube.vertexArray(), std::max(0.0f, glm::length(center - view.eye) - radius));
+}
+
+// 基数排序
+// 对 (键, 下标) 做 LSD 排序，每趟 8 位；先统计全部 8 个字节的直方图，所有键在某字节相同时跳过该趟
+// 排序稳定，键相同的绘制包保持提交顺序
+void RenderQueue::sort() {
+    const size_t n = packets_.size();
+    order_.resize(n);
+    scratch_.resize(n);
+    for (size_t i = 0; i < n; ++i) order_[i] = SortItem{ packets_[i].key, static_cast<uint32_t>(i) };
+
+    size_t histogram[8][256] = {};
+    for (const SortItem& item : order_) {
+        for (int b = 0; b < 8; ++b) ++histogram[b][(item.key >> (b * 8)) & 0xFF];
+    }
+    for (int b = 0; b < 8; ++b) {
+        size_t* h = histogram[b];
+        if (n == 0 || h[(order_[0].key >> (b * 8)) & 0xFF] == n) continue;
+        size_t offset = 0;
+        for (int d = 0; d < 256; ++d) {
+            const size_t count = h[d];
+            h[d] = offset;
+            offset += count;
+        }
+        for (const SortItem& item : order_) scratch_[h[(item.key >> (b * 8)) & 0xFF]++] = item;
+        order_.swap(scratch_);
+    }
+
+    // 各 Pass 的起点 (键最高 4 位)
+    size_t i = 0;
+    for (uint32_t pass = 0; pass <= kMaxPasses; ++pass) {
+        while (i < n && (order_[i].key >> 60) < pass) ++i;
+        passBegin_[pass] = i;
+    }
+}
+
+// 执行
+// 状态只在与上一个绘制包不同时切换；纹理与 VAO 的绑定同时经由 GLState 去重
+void RenderQueue::execute(uint32_t pass, const ObjectUniformBuffer& objects) {
+    if (pass >= kMaxPasses) return;
+    const Shader* shader = nullptr;
+    uint32_t material = ~0u;
+    uint32_t geometry = ~0u;
+    uint32_t slot = ~0u;
+    for (size_t i = passBegin_[pass]; i < passBegin_[pass + 1]; ++i) {
+        DrawPacket& p = packets_[order_[i].index];
+        if (p.shader != shader) {
+            p.shader->use();
+            shader = p.shader;
+            ++stats_.programChanges;
+        }
+        if (p.objectSlot != slot) {
+            objects.bind(p.objectSlot);
+            slot = p.objectSlot;
+            ++stats_.objectChanges;
+        }
+        const uint32_t m = static_cast<uint32_t>(p.key >> 36) & 0xFFFF;
+        if (m != material) {
+            material = m;
+            ++stats_.materialChanges;
+        }
+        ++stats_.packets;
+        switch (p.kind) {
+        case DrawPacket::CubeInstancesDraw:
+            if (p.cube->vertexArray() != geometry) {
+                geometry = p.cube->vertexArray();
+                ++stats_.geometryChanges;
+            }
+            p.cube->DrawInstanced(*p.shader, p.instanceCount);
+            break;
+        case DrawPacket::MeshStreamDraw:
+            if (p.mesh->geometryPool()->streamVertexArray() != geometry) {
+                p.mesh->geometryPool()->bindStream();
+                geometry = p.mesh->geometryPool()->streamVertexArray();
+                ++stats_.geometryChanges;
+            }
+            p.mesh->DrawStream(*p.shader, p.firstIndex, p.indexCount);
+            break;
+        case DrawPacket::MeshLodDraw:
+            if (p.mesh->vertexArray() != geometry) {
+                p.mesh->bindGeometry();
+                geometry = p.mesh->vertexArray();
+                ++stats_.geometryChanges;
+            }
+            p.mesh->DrawBound(*p.shader, p.lodPass);
+            break;
+        }
+    }
+}
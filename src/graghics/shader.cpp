@@ -1,14 +1,97 @@
 #include "shader.h"
+#include "program_cache.h"
+#include "gl_state.h"
+#include "uniform_buffers.h"
 #include "glm.hpp"
 #include "gtc/type_ptr.hpp"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 
-Shader::Shader() : program_(0) {}
+// KHR_parallel_shader_compile (GLAD 未生成该扩展)
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace {
+UniformCounters gCounters; // 全局 Uniform 计数 (GL 线程)
+
+const int kMaxIncludeDepth = 16;
+
+// 删除程序前通知状态缓存 (名字可能被新程序复用)
+void deleteProgram(GLuint program) {
+    GLState::shared().forgetProgram(program);
+    glDeleteProgram(program);
+}
+
+std::string directoryOf(const std::string& path) {
+    size_t p = path.find_last_of("/\\");
+    return p == std::string::npos ? std::string() : path.substr(0, p + 1);
+}
+
+// 逐行展开 #include，included 记录已展开的文件 (下标 + 1 即源串号)
+bool expandIncludes(const std::string& path, const std::string& src, int sourceIndex, const std::string& defines,
+                    std::vector<std::string>& included, std::string& out, std::string& error, int depth) {
+    if (depth > kMaxIncludeDepth) {
+        error = "include depth exceeded in " + path;
+        return false;
+    }
+    const std::string dir = directoryOf(path);
+    size_t pos = 0;
+    int line = 1;
+    while (pos < src.size()) {
+        size_t end = src.find('\n', pos);
+        if (end == std::string::npos) end = src.size();
+        const std::string text = src.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t first = text.find_first_not_of(" \t");
+        if (first != std::string::npos && text.compare(first, 8, "#include") == 0) {
+            size_t open = text.find('"', first + 8);
+            size_t close = open == std::string::npos ? open : text.find('"', open + 1);
+            if (close == std::string::npos) {
+                error = path + ":" + std::to_string(line) + ": malformed #include";
+                return false;
+            }
+            const std::string target = dir + text.substr(open + 1, close - open - 1);
+            if (std::find(included.begin(), included.end(), target) == included.end()) {
+                std::string chunk;
+                if (!Shader::readFile(target, chunk)) {
+                    error = path + ":" + std::to_string(line) + ": cannot open include " + target;
+                    return false;
+                }
+                included.push_back(target);
+                out += "#line 1 " + std::to_string(included.size()) + "\n";
+                if (!expandIncludes(target, chunk, static_cast<int>(included.size()), defines, included, out, error, depth + 1)) return false;
+                out += "\n#line " + std::to_string(line + 1) + " " + std::to_string(sourceIndex) + "\n";
+            } else {
+                out += "\n"; // 已展开过，保留空行以维持行号
+            }
+        } else {
+            out += text;
+            out += '\n';
+            // 宏定义紧跟在主文件的 #version 之后 (#version 必须是第一条指令)
+            if (sourceIndex == 0 && first != std::string::npos && text.compare(first, 8, "#version") == 0 && !defines.empty()) {
+                out += defines;
+                if (defines.back() != '\n') out += '\n';
+                out += "#line " + std::to_string(line + 1) + " 0\n";
+            }
+        }
+        ++line;
+    }
+    return true;
+}
+
+} // namespace
+
+Shader::Shader()
+    : program_(0), fromBinary_(false), pendingProgram_(0), pendingVert_(0), pendingFrag_(0), pendingGeom_(0), pendingCache_(nullptr) {}
 
 Shader::~Shader() {
     // 释放着色器程序资源
-    if (program_) glDeleteProgram(program_);
+    releasePending();
+    if (program_) deleteProgram(program_);
 }
 
 // 读取文件内容到字符串
@@ -31,53 +114,141 @@ bool Shader::readFile(const std::string& path, std::string& out) {
     return true;
 }
 
-// 编译单个着色器阶段 (顶点或片元)
-GLuint Shader::compileStage(GLenum type, const std::string& src, std::string& outError) {
+// 提交单个着色器阶段 (顶点、几何或片元) 的编译
+// 不查询 GL_COMPILE_STATUS，避免强制驱动同步完成编译
+GLuint Shader::compileStage(GLenum type, const std::string& src) {
     GLuint s = glCreateShader(type);
     const char* c = src.c_str();
     GLint len = (GLint)src.size();
     glShaderSource(s, 1, &c, &len);
     glCompileShader(s);
-    
-    // 检查编译状态
-    GLint ok = 0;
-    glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
-    if (!ok) {
-        GLint logLen = 0;
-        glGetShaderiv(s, GL_INFO_LOG_LENGTH, &logLen);
-        std::string log;
-        log.resize(logLen);
-        glGetShaderInfoLog(s, logLen, nullptr, log.data());
-        outError = log;
-        glDeleteShader(s);
-        return 0;
-    }
     return s;
 }
 
+// 检查编译状态，失败时读取日志
+bool Shader::stageError(GLuint shader, std::string& outError) {
+    GLint ok = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (ok) return false;
+    GLint logLen = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLen);
+    std::string log;
+    log.resize(logLen);
+    glGetShaderInfoLog(shader, logLen, nullptr, log.data());
+    outError = log.empty() ? "shader compile failed" : log;
+    return true;
+}
+
+void Shader::releasePending() {
+    if (pendingVert_) glDeleteShader(pendingVert_);
+    if (pendingFrag_) glDeleteShader(pendingFrag_);
+    if (pendingGeom_) glDeleteShader(pendingGeom_);
+    if (pendingProgram_) glDeleteProgram(pendingProgram_);
+    pendingProgram_ = pendingVert_ = pendingFrag_ = pendingGeom_ = 0;
+    pendingCache_ = nullptr;
+    pendingVertSrc_.clear();
+    pendingFragSrc_.clear();
+    pendingGeomSrc_.clear();
+}
+
 // 从源码字符串编译完整的着色器程序
-bool Shader::compileFromSource(const std::string& vert, const std::string& frag) {
-    std::string errV, errF;
-    // 1. 编译顶点着色器
-    GLuint v = compileStage(GL_VERTEX_SHADER, vert, errV);
-    if (!v) { error_ = errV; return false; }
-    
-    // 2. 编译片元着色器
-    GLuint f = compileStage(GL_FRAGMENT_SHADER, frag, errF);
-    if (!f) { glDeleteShader(v); error_ = errF; return false; }
-    
-    // 3. 链接着色器程序
-    GLuint p = glCreateProgram();
-    glAttachShader(p, v);
-    glAttachShader(p, f);
-    glLinkProgram(p);
-    
-    // 链接后即可删除着色器对象
-    glDetachShader(p, v);
-    glDetachShader(p, f);
-    glDeleteShader(v);
-    glDeleteShader(f);
-    
+// 提交后立即阻塞等待结果
+bool Shader::compileFromSource(const std::string& vert, const std::string& frag, ProgramBinaryCache* cache,
+                               const std::string& geom) {
+    if (!submitFromSource(vert, frag, cache, geom)) return false;
+    poll(false);
+    return error_.empty();
+}
+
+bool Shader::preprocessFile(const std::string& path, const std::string& defines, std::string& out, std::string& error) {
+    std::string src;
+    if (!readFile(path, src)) {
+        error = "cannot open " + path;
+        return false;
+    }
+    out.clear();
+    std::vector<std::string> included;
+    return expandIncludes(path, src, 0, defines, included, out, error, 0);
+}
+
+// 从文件加载并编译着色器
+bool Shader::compileFromFiles(const std::string& vertPath, const std::string& fragPath, ProgramBinaryCache* cache,
+                              const std::string& defines, const std::string& geomPath) {
+    if (!submitFromFiles(vertPath, fragPath, cache, defines, geomPath)) return false;
+    poll(false);
+    return error_.empty();
+}
+
+// 提交编译
+// 提供缓存时先尝试加载程序二进制，驱动拒绝或缺失时回退到源码编译，完成后写回缓存
+// 几何着色器源码作为缓存键的附加部分
+bool Shader::submitFromSource(const std::string& vert, const std::string& frag, ProgramBinaryCache* cache,
+                              const std::string& geom) {
+    releasePending();
+    error_.clear();
+    if (cache) {
+        if (GLuint p = cache->load(vert, frag, geom)) {
+            if (program_) deleteProgram(program_);
+            program_ = p;
+            fromBinary_ = true;
+            bindUniformBlocks();
+            reflectUniforms();
+            return true;
+        }
+    }
+
+    // 1. 各阶段连续提交，驱动可在后台线程并行编译
+    pendingVert_ = compileStage(GL_VERTEX_SHADER, vert);
+    pendingFrag_ = compileStage(GL_FRAGMENT_SHADER, frag);
+    if (!geom.empty()) pendingGeom_ = compileStage(GL_GEOMETRY_SHADER, geom);
+
+    // 2. 不等待编译结果直接链接，编译失败时链接同样失败，错误在 poll 中按阶段报告
+    pendingProgram_ = glCreateProgram();
+    glAttachShader(pendingProgram_, pendingVert_);
+    glAttachShader(pendingProgram_, pendingFrag_);
+    if (pendingGeom_) glAttachShader(pendingProgram_, pendingGeom_);
+    if (cache) cache->prepare(pendingProgram_);
+    glLinkProgram(pendingProgram_);
+    pendingCache_ = cache;
+    if (cache) {
+        pendingVertSrc_ = vert;
+        pendingFragSrc_ = frag;
+        pendingGeomSrc_ = geom;
+    }
+    return true;
+}
+
+// 宏定义已注入源码，二进制缓存键随源码自然区分各变体
+bool Shader::submitFromFiles(const std::string& vertPath, const std::string& fragPath, ProgramBinaryCache* cache,
+                             const std::string& defines, const std::string& geomPath) {
+    std::string vsrc, fsrc, gsrc, err;
+    if (!preprocessFile(vertPath, defines, vsrc, err) || !preprocessFile(fragPath, defines, fsrc, err)
+        || (!geomPath.empty() && !preprocessFile(geomPath, defines, gsrc, err))) {
+        error_ = err;
+        return false;
+    }
+    return submitFromSource(vsrc, fsrc, cache, gsrc);
+}
+
+// 轮询编译结果
+// 1. 支持并行编译时查询 GL_COMPLETION_STATUS_KHR，未完成立即返回
+// 2. 完成后依次检查各阶段的编译状态与链接状态 (此时查询不再阻塞)
+bool Shader::poll(bool parallel) {
+    if (!pendingProgram_) return true;
+    if (parallel) {
+        GLint done = GL_FALSE;
+        glGetProgramiv(pendingProgram_, GL_COMPLETION_STATUS_KHR, &done);
+        if (!done) return false;
+    }
+
+    GLuint p = pendingProgram_;
+    std::string err;
+    if (stageError(pendingVert_, err) || stageError(pendingFrag_, err) || (pendingGeom_ && stageError(pendingGeom_, err))) {
+        error_ = err;
+        releasePending();
+        return true;
+    }
+
     // 检查链接状态
     GLint ok = 0;
     glGetProgramiv(p, GL_LINK_STATUS, &ok);
@@ -87,54 +258,154 @@ bool Shader::compileFromSource(const std::string& vert, const std::string& frag)
         std::string log;
         log.resize(logLen);
         glGetProgramInfoLog(p, logLen, nullptr, log.data());
-        glDeleteProgram(p);
-        error_ = log;
-        return false;
+        error_ = log.empty() ? "program link failed" : log;
+        releasePending();
+        return true;
     }
-    
+
+    // 链接后即可删除着色器对象
+    glDetachShader(p, pendingVert_);
+    glDetachShader(p, pendingFrag_);
+    if (pendingGeom_) glDetachShader(p, pendingGeom_);
+    if (pendingCache_) pendingCache_->store(p, pendingVertSrc_, pendingFragSrc_, pendingGeomSrc_);
+    pendingProgram_ = 0; // 所有权转移给 program_
+    releasePending();
+
     // 如果之前有程序，先删除
-    if (program_) glDeleteProgram(program_);
+    if (program_) deleteProgram(program_);
     program_ = p;
+    fromBinary_ = false;
     error_.clear();
+    bindUniformBlocks();
+    reflectUniforms();
     return true;
 }
 
-// 从文件加载并编译着色器
-bool Shader::compileFromFiles(const std::string& vertPath, const std::string& fragPath) {
-    std::string vsrc, fsrc;
-    if (!readFile(vertPath, vsrc)) { error_ = "vertex file read failed"; return false; }
-    if (!readFile(fragPath, fsrc)) { error_ = "fragment file read failed"; return false; }
-    return compileFromSource(vsrc, fsrc);
+// 绑定共享 Uniform 块
+// GLSL 330 不支持 layout(binding)，按块名映射到固定绑定点；程序未声明的块跳过
+void Shader::bindUniformBlocks() {
+    const struct { const char* name; GLuint binding; } blocks[] = {
+        { "FrameData", kFrameBlockBinding },
+        { "ObjectData", kObjectBlockBinding },
+    };
+    for (const auto& b : blocks) {
+        GLuint index = glGetUniformBlockIndex(program_, b.name);
+        if (index != GL_INVALID_INDEX) glUniformBlockBinding(program_, index, b.binding);
+    }
 }
 
+bool Shader::pending() const { return pendingProgram_ != 0; }
+bool Shader::ready() const { return program_ != 0; }
+
 void Shader::use() const {
-    glUseProgram(program_);
+    GLState::shared().useProgram(program_);
 }
 
 GLuint Shader::program() const { return program_; }
+bool Shader::fromBinary() const { return fromBinary_; }
 const std::string& Shader::error() const { return error_; }
 
 // 获取 Uniform 变量位置
-GLint Shader::uniform(const char* name) const { return glGetUniformLocation(program_, name); }
+GLint Shader::uniform(const char* name) const {
+    ++gCounters.lookups;
+    return glGetUniformLocation(program_, name);
+}
+
+const UniformCounters& Shader::counters() { return gCounters; }
+
+// 建立反射表
+// 数组 Uniform 的名字带 "[0]" 后缀，去掉后与声明名一致；块成员没有位置，跳过
+void Shader::reflectUniforms() {
+    uniforms_.clear();
+    GLint count = 0, maxLen = 0;
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLen);
+    std::vector<char> name(static_cast<size_t>(std::max(maxLen, 1)));
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei len = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program_, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), &len, &size, &type, name.data());
+        ++gCounters.lookups;
+        GLint location = glGetUniformLocation(program_, name.data());
+        if (location < 0) continue;
+        if (len > 3 && std::strcmp(name.data() + len - 3, "[0]") == 0) len -= 3;
+        UniformSlot slot;
+        slot.hash = fnv1a64(name.data(), static_cast<size_t>(len));
+        slot.location = location;
+        slot.type = type;
+        uniforms_.push_back(slot);
+    }
+    std::sort(uniforms_.begin(), uniforms_.end(), [](const UniformSlot& a, const UniformSlot& b) { return a.hash < b.hash; });
+}
+
+// 查找 Uniform 并检查类型
+// 整数类别同时接受采样器 (纹理单元)，布尔类别接受 bool 与 int
+int Shader::findUniform(uint64_t hash, UniformKind kind) const {
+    auto it = std::lower_bound(uniforms_.begin(), uniforms_.end(), hash,
+                               [](const UniformSlot& slot, uint64_t h) { return slot.hash < h; });
+    if (it == uniforms_.end() || it->hash != hash) return -1;
+    bool ok = false;
+    switch (kind) {
+    case UniformKind::Bool:
+    case UniformKind::Int:
+        ok = it->type == GL_INT || it->type == GL_BOOL || it->type == GL_SAMPLER_2D || it->type == GL_SAMPLER_CUBE;
+        break;
+    case UniformKind::Float: ok = it->type == GL_FLOAT; break;
+    case UniformKind::Vec3:  ok = it->type == GL_FLOAT_VEC3; break;
+    case UniformKind::Mat4:  ok = it->type == GL_FLOAT_MAT4; break;
+    }
+    return ok ? static_cast<int>(it - uniforms_.begin()) : -1;
+}
+
+bool Shader::changed(int index, const void* data, size_t bytes) const {
+    UniformSlot& slot = uniforms_[index];
+    if (slot.hasValue && std::memcmp(slot.value, data, bytes) == 0) {
+        ++gCounters.redundant;
+        return false;
+    }
+    std::memcpy(slot.value, data, bytes);
+    slot.hasValue = true;
+    ++gCounters.uploads;
+    return true;
+}
+
+// 句柄设置
+void Shader::set(UniformHandle<bool> h, bool value) const {
+    UniformHandle<int> asInt;
+    asInt.index_ = h.index_;
+    set(asInt, value ? 1 : 0);
+}
+void Shader::set(UniformHandle<int> h, int value) const {
+    if (h.index_ < 0 || !changed(h.index_, &value, sizeof(value))) return;
+    glUniform1i(uniforms_[h.index_].location, value);
+}
+void Shader::set(UniformHandle<float> h, float value) const {
+    if (h.index_ < 0 || !changed(h.index_, &value, sizeof(value))) return;
+    glUniform1f(uniforms_[h.index_].location, value);
+}
+void Shader::set(UniformHandle<glm::vec3> h, const glm::vec3& value) const {
+    if (h.index_ < 0 || !changed(h.index_, glm::value_ptr(value), sizeof(value))) return;
+    glUniform3fv(uniforms_[h.index_].location, 1, glm::value_ptr(value));
+}
+void Shader::set(UniformHandle<glm::mat4> h, const glm::mat4& value) const {
+    if (h.index_ < 0 || !changed(h.index_, glm::value_ptr(value), sizeof(value))) return;
+    glUniformMatrix4fv(uniforms_[h.index_].location, 1, GL_FALSE, glm::value_ptr(value));
+}
 
-// Uniform 设置辅助函数
+// Uniform 设置辅助函数 (名字在运行时求哈希)
 void Shader::setBool(const std::string &name, bool value) const {
-    GLint loc = glGetUniformLocation(program_, name.c_str());
-    if (loc != -1) glUniform1i(loc, value ? 1 : 0);
+    set(handle<bool>(UniformName(name.c_str())), value);
 }
 void Shader::setInt(const std::string &name, int value) const {
-    GLint loc = glGetUniformLocation(program_, name.c_str());
-    if (loc != -1) glUniform1i(loc, value);
+    set(handle<int>(UniformName(name.c_str())), value);
 }
 void Shader::setFloat(const std::string &name, float value) const {
-    GLint loc = glGetUniformLocation(program_, name.c_str());
-    if (loc != -1) glUniform1f(loc, value);
+    set(handle<float>(UniformName(name.c_str())), value);
 }
 void Shader::setVec3(const std::string &name, const glm::vec3& value) const {
-    GLint loc = glGetUniformLocation(program_, name.c_str());
-    if (loc != -1) glUniform3fv(loc, 1, glm::value_ptr(value));
+    set(handle<glm::vec3>(UniformName(name.c_str())), value);
 }
 void Shader::setMat4(const std::string& name, const glm::mat4& value) const {
-    GLint loc = glGetUniformLocation(program_, name.c_str());
-    if (loc != -1) glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value));
+    set(handle<glm::mat4>(UniformName(name.c_str())), value);
 }
@@ -0,0 +1,121 @@
+#include "shader_library.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// 后备程序：与场景/立方体着色器使用相同的顶点属性位置与 Uniform 块，输出固定颜色
+// 支持压缩顶点格式的位置反量化，保证网格在切换前后位置一致
+const char* kFallbackVert = R"(#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 shadowMatrices[6];
+    vec3 viewPos;
+    float farPlane;
+    vec3 lightPos;
+    float outlineWidth;
+    vec3 lightColor;
+};
+layout(std140) uniform ObjectData {
+    mat4 model;
+    mat4 normalMatrix;
+    vec3 objectColor;
+};
+uniform vec3 posScale = vec3(1.0);
+uniform vec3 posOffset = vec3(0.0);
+void main() {
+    gl_Position = projection * view * model * vec4(aPos * posScale + posOffset, 1.0);
+}
+)";
+
+const char* kFallbackFrag = R"(#version 330 core
+out vec4 FragColor;
+void main() {
+    FragColor = vec4(0.6, 0.6, 0.6, 1.0);
+}
+)";
+
+} // namespace
+
+ShaderLibrary::ShaderLibrary(ProgramBinaryCache* cache)
+    : cache_(cache)
+    , parallel_(hasExtension("GL_KHR_parallel_shader_compile") || hasExtension("GL_ARB_parallel_shader_compile"))
+    , pending_(0)
+    , doneMs_(0.0)
+    , started_(false)
+{
+    // 后备程序很小，同步编译
+    if (!fallback_.compileFromSource(kFallbackVert, kFallbackFrag)) {
+        std::cerr << "WARNING::SHADER_LIBRARY::fallback program failed: " << fallback_.error() << std::endl;
+    }
+}
+
+bool ShaderLibrary::hasExtension(const char* name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const GLubyte* ext = glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i));
+        if (ext && std::strcmp(reinterpret_cast<const char*>(ext), name) == 0) return true;
+    }
+    return false;
+}
+
+Shader& ShaderLibrary::add(const std::string& vertPath, const std::string& fragPath, const std::string& defines,
+                           const std::string& geomPath)
+{
+    if (!started_) {
+        start_ = std::chrono::steady_clock::now();
+        started_ = true;
+    }
+    shaders_.emplace_back();
+    Shader& s = shaders_.back();
+    s.submitFromFiles(vertPath, fragPath, cache_, defines, geomPath);
+    if (s.pending()) ++pending_;
+    else if (pending_ == 0) doneMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+    return s;
+}
+
+// 轮询编译结果
+// 有并行编译扩展时查询所有程序；否则查询会阻塞到编译结束，每次只结束一个
+size_t ShaderLibrary::update()
+{
+    size_t finished = 0;
+    for (auto& s : shaders_) {
+        if (!s.pending()) continue;
+        if (!s.poll(parallel_)) continue;
+        ++finished;
+        --pending_;
+        if (!parallel_) break;
+    }
+    if (finished > 0 && pending_ == 0) {
+        doneMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+    }
+    return finished;
+}
+
+void ShaderLibrary::finish()
+{
+    for (auto& s : shaders_) {
+        if (s.pending()) s.poll(false);
+    }
+    if (pending_ > 0) {
+        pending_ = 0;
+        doneMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+    }
+}
+
+Shader& ShaderLibrary::resolve(Shader& shader)
+{
+    return shader.ready() ? shader : fallback_;
+}
+
+const Shader* ShaderLibrary::failed() const
+{
+    for (const auto& s : shaders_) {
+        if (!s.pending() && !s.ready()) return &s;
+    }
+    return nullptr;
+}
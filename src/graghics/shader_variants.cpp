@@ -0,0 +1,61 @@
+#include "shader_variants.h"
+#include "shader_library.h"
+
+constexpr int ShaderPermutation::kPcfSampleCounts[4];
+
+int ShaderPermutation::pcfLevel() const
+{
+    int level = 0;
+    for (int i = 1; i < 4; ++i) {
+        if (pcfSamples >= kPcfSampleCounts[i]) level = i;
+    }
+    return level;
+}
+
+// 位 0: textured，位 1: outline，位 2-3: PCF 档位
+uint32_t ShaderPermutation::key() const
+{
+    return (textured ? 1u : 0u) | (outline ? 2u : 0u) | (uint32_t(pcfLevel()) << 2);
+}
+
+std::string ShaderPermutation::defines() const
+{
+    std::string out;
+    out += "#define HAS_TEXTURE ";
+    out += textured ? "1\n" : "0\n";
+    out += "#define OUTLINE ";
+    out += outline ? "1\n" : "0\n";
+    out += "#define PCF_SAMPLES " + std::to_string(kPcfSampleCounts[pcfLevel()]) + "\n";
+    return out;
+}
+
+ShaderVariants::ShaderVariants(ShaderLibrary& library, std::string vertPath, std::string fragPath)
+    : library_(library)
+    , vertPath_(std::move(vertPath))
+    , fragPath_(std::move(fragPath))
+{
+}
+
+Shader& ShaderVariants::request(const ShaderPermutation& permutation)
+{
+    const uint32_t key = permutation.key();
+    for (const auto& v : variants_) {
+        if (v.first == key) return *v.second;
+    }
+    Shader& s = library_.add(vertPath_, fragPath_, permutation.defines());
+    variants_.emplace_back(key, &s);
+    return s;
+}
+
+Shader& ShaderVariants::resolve(const ShaderPermutation& permutation)
+{
+    const uint32_t key = permutation.key();
+    Shader& s = request(permutation);
+    if (s.ready()) return s;
+    // 只借用纹理与描边选项相同、仅 PCF 档位不同的就绪变体 (其他选项不同会采样错误的纹理或输出描边)
+    const uint32_t featureMask = 3u;
+    for (const auto& v : variants_) {
+        if ((v.first & featureMask) == (key & featureMask) && v.second->ready()) return *v.second;
+    }
+    return library_.resolve(s);
+}
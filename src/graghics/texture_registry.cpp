@@ -0,0 +1,41 @@
+#include "texture_registry.h"
+
+TextureRegistry::TextureRegistry(TextureStreamer& streamer)
+    : streamer_(streamer) {}
+
+std::string TextureRegistry::makeKey(const std::string& source, const SamplerDesc& sampler) {
+    return source + "#" + std::to_string(sampler.wrapS) + "," + std::to_string(sampler.wrapT)
+         + "," + std::to_string(sampler.minFilter) + "," + std::to_string(sampler.magFilter);
+}
+
+std::shared_ptr<GLTexture> TextureRegistry::find(const std::string& key) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return nullptr;
+    std::shared_ptr<GLTexture> tex = it->second.lock();
+    if (!tex) entries_.erase(it);
+    return tex;
+}
+
+std::shared_ptr<GLTexture> TextureRegistry::loadEncoded(const std::string& key, std::vector<unsigned char> encoded,
+                                                        const SamplerDesc& sampler,
+                                                        TextureStreamer::DecodedCallback onDecoded) {
+    std::shared_ptr<GLTexture> tex = streamer_.loadEncoded(std::move(encoded), sampler, std::move(onDecoded));
+    entries_[key] = tex;
+    return tex;
+}
+
+std::shared_ptr<GLTexture> TextureRegistry::loadPixels(const std::string& key, int width, int height,
+                                                       const unsigned char* pixels, std::shared_ptr<const void> owner,
+                                                       const SamplerDesc& sampler) {
+    std::shared_ptr<GLTexture> tex = streamer_.loadPixels(width, height, pixels, std::move(owner), sampler);
+    entries_[key] = tex;
+    return tex;
+}
+
+size_t TextureRegistry::collect() {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.expired()) it = entries_.erase(it);
+        else ++it;
+    }
+    return entries_.size();
+}
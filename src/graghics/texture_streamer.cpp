@@ -0,0 +1,208 @@
+#include "texture_streamer.h"
+#include "gl_state.h"
+#include "thread_pool.h"
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+TextureStreamer::TextureStreamer(ThreadPool& pool, size_t bytesPerFrame, int ringSize)
+    : pool_(pool)
+    , ready_(std::make_shared<ReadyQueue>())
+    , nextTicket_(1)
+    , nextPbo_(0)
+    , bytesPerFrame_(0)
+    , pending_(0)
+    , uploadedBytes_(0) {
+    setBytesPerFrame(bytesPerFrame);
+    ringSize = std::max(1, ringSize);
+    pbos_.resize(ringSize);
+    pboSizes_.assign(ringSize, 0);
+    fences_.assign(ringSize, nullptr);
+    glGenBuffers(ringSize, pbos_.data());
+}
+
+// 析构函数：释放 PBO 与栅栏
+// 仍在解码的任务只持有就绪队列，析构后其结果被丢弃
+TextureStreamer::~TextureStreamer() {
+    for (GLsync f : fences_) {
+        if (f) glDeleteSync(f);
+    }
+    if (!pbos_.empty()) glDeleteBuffers(static_cast<GLsizei>(pbos_.size()), pbos_.data());
+}
+
+void TextureStreamer::setBytesPerFrame(size_t bytes) {
+    // 预算过小时每帧至少前进一行 4K 纹理
+    bytesPerFrame_ = std::max<size_t>(bytes, 16u << 10);
+}
+
+bool TextureStreamer::decode(const unsigned char* data, size_t size, ImageData& out) {
+    int w = 0, h = 0, ch = 0;
+    stbi_set_flip_vertically_on_load_thread(false); // 加载模型纹理时通常不需要翻转 (线程局部设置)
+    unsigned char* pixels = stbi_load_from_memory(data, static_cast<int>(size), &w, &h, &ch, 4);
+    if (!pixels) return false;
+    out.width = w;
+    out.height = h;
+    out.pixels.assign(pixels, pixels + size_t(w) * size_t(h) * 4);
+    stbi_image_free(pixels);
+    return true;
+}
+
+// 创建占位纹理
+// 1x1 白色纹素，不使用 mipmap 过滤，保证纹理完整可采样
+std::shared_ptr<GLTexture> TextureStreamer::createPlaceholder(const SamplerDesc& sampler) {
+    static const unsigned char white[4] = { 255, 255, 255, 255 };
+    auto tex = std::make_shared<GLTexture>();
+    glGenTextures(1, &tex->id);
+    GLState::shared().bindTexture(GL_TEXTURE_2D, tex->id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, sampler.wrapS);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, sampler.wrapT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, sampler.magFilter);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    GLState::shared().bindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+}
+
+std::shared_ptr<GLTexture> TextureStreamer::loadEncoded(std::vector<unsigned char> encoded, const SamplerDesc& sampler,
+                                                        DecodedCallback onDecoded) {
+    const uint64_t ticket = nextTicket_++;
+    Upload& u = decoding_[ticket];
+    u.texture = createPlaceholder(sampler);
+    u.sampler = sampler;
+    ++pending_;
+
+    std::shared_ptr<ReadyQueue> ready = ready_;
+    auto bytes = std::make_shared<std::vector<unsigned char>>(std::move(encoded));
+    pool_.submit([ready, ticket, bytes, onDecoded] {
+        auto image = std::make_shared<ImageData>();
+        bool ok = decode(bytes->data(), bytes->size(), *image);
+        if (!ok) image.reset();
+        if (onDecoded) onDecoded(image);
+
+        std::lock_guard<std::mutex> lock(ready->mutex);
+        ready->decoded.push_back(Decoded{ ticket, std::move(image) });
+    });
+    return u.texture;
+}
+
+std::shared_ptr<GLTexture> TextureStreamer::loadPixels(int width, int height, const unsigned char* pixels,
+                                                       std::shared_ptr<const void> owner, const SamplerDesc& sampler) {
+    Upload u;
+    u.texture = createPlaceholder(sampler);
+    u.sampler = sampler;
+    u.width = width;
+    u.height = height;
+    u.pixels = pixels;
+    u.owner = std::move(owner);
+    ++pending_;
+    queue_.push_back(std::move(u));
+    return queue_.back().texture;
+}
+
+// 获取 PBO 槽位
+// 槽位按环形顺序轮换；上一次提交的 DMA 未完成时不等待，留到下一帧
+int TextureStreamer::acquirePbo(size_t size) {
+    int slot = nextPbo_;
+    if (fences_[slot]) {
+        GLenum r = glClientWaitSync(fences_[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (r == GL_TIMEOUT_EXPIRED) return -1;
+        glDeleteSync(fences_[slot]);
+        fences_[slot] = nullptr;
+    }
+    if (pboSizes_[slot] < size) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos_[slot]);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        pboSizes_[slot] = size;
+    }
+    nextPbo_ = (nextPbo_ + 1) % static_cast<int>(pbos_.size());
+    return slot;
+}
+
+// 提交完整图像
+// 像素已全部位于 PBO 中，glTexImage2D 以缓冲区偏移为源，由驱动异步完成传输
+void TextureStreamer::commit(Upload& u) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos_[u.pbo]);
+    GLState::shared().bindTexture(GL_TEXTURE_2D, u.texture->id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, u.width, u.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, u.sampler.minFilter);
+    GLState::shared().bindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    fences_[u.pbo] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    u.texture->width = u.width;
+    u.texture->height = u.height;
+    u.texture->resident = true;
+    u.owner.reset();
+    --pending_;
+}
+
+void TextureStreamer::pump(size_t budget) {
+    // 1. 取出工作线程解码完成的请求
+    std::deque<Decoded> decoded;
+    {
+        std::lock_guard<std::mutex> lock(ready_->mutex);
+        decoded.swap(ready_->decoded);
+    }
+    for (auto& d : decoded) {
+        auto it = decoding_.find(d.ticket);
+        if (it == decoding_.end()) continue;
+        Upload u = std::move(it->second);
+        decoding_.erase(it);
+        if (d.image) {
+            u.width = d.image->width;
+            u.height = d.image->height;
+            u.pixels = d.image->pixels.data();
+            u.owner = std::move(d.image);
+        }
+        queue_.push_back(std::move(u));
+    }
+
+    // 2. 按顺序把像素写入 PBO，预算耗尽时剩余部分留到下一帧
+    while (!queue_.empty() && budget > 0) {
+        Upload& u = queue_.front();
+        if (!u.pixels) {
+            --pending_;
+            queue_.pop_front();
+            continue;
+        }
+        const size_t total = size_t(u.width) * size_t(u.height) * 4;
+        if (u.pbo < 0) {
+            u.pbo = acquirePbo(total);
+            if (u.pbo < 0) break;
+        }
+        size_t chunk = std::min(total - u.staged, budget);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos_[u.pbo]);
+        void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, static_cast<GLintptr>(u.staged), static_cast<GLsizeiptr>(chunk),
+                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (dst) {
+            std::memcpy(dst, u.pixels + u.staged, chunk);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (!dst) break;
+        u.staged += chunk;
+        budget -= chunk;
+        uploadedBytes_ += chunk;
+        if (u.staged < total) break;
+        commit(u);
+        queue_.pop_front();
+    }
+}
+
+void TextureStreamer::update() {
+    pump(bytesPerFrame_);
+}
+
+void TextureStreamer::finish() {
+    while (pending_ > 0) {
+        size_t before = pending_;
+        pump(std::numeric_limits<size_t>::max());
+        if (pending_ == before) std::this_thread::yield(); // 等待解码或 PBO 释放
+    }
+}
@@ -0,0 +1,118 @@
+#include "uniform_buffers.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <cstring>
+
+FrameUniformBuffer::FrameUniformBuffer() : ubo_(0), valid_(false) {
+    glGenBuffers(1, &ubo_);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo_);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, kFrameBlockBinding, ubo_);
+}
+
+FrameUniformBuffer::~FrameUniformBuffer() {
+    if (ubo_) glDeleteBuffers(1, &ubo_);
+}
+
+bool FrameUniformBuffer::update(const FrameUniforms& data) {
+    if (valid_ && std::memcmp(&last_, &data, sizeof(FrameUniforms)) == 0) return false;
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo_);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    last_ = data;
+    valid_ = true;
+    return true;
+}
+
+ObjectUniformBuffer::ObjectUniformBuffer(size_t capacity)
+    : ubo_(0)
+    , stride_(sizeof(ObjectUniforms))
+    , capacity_(0)
+    , dirtyBegin_(0)
+    , dirtyEnd_(0)
+    , uploadedBytes_(0) {
+    GLint align = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+    align = std::max(align, 16);
+    stride_ = (sizeof(ObjectUniforms) + size_t(align) - 1) / size_t(align) * size_t(align);
+    glGenBuffers(1, &ubo_);
+    capacity_ = std::max<size_t>(capacity, 1);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo_);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(stride_ * capacity_), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+ObjectUniformBuffer::~ObjectUniformBuffer() {
+    GLState::shared().forgetBuffer(ubo_);
+    if (ubo_) glDeleteBuffers(1, &ubo_);
+}
+
+// 调整槽位数量
+// 新槽位初始化为单位矩阵与白色；扩容时重新分配缓冲区，全部槽位标记为脏
+void ObjectUniformBuffer::resize(size_t count) {
+    const size_t old = objects_.size();
+    ObjectUniforms identity;
+    identity.model = glm::mat4(1.0f);
+    identity.normalMatrix = glm::mat4(1.0f);
+    identity.objectColor = glm::vec3(1.0f);
+    objects_.resize(count, identity);
+    if (count > capacity_) {
+        while (capacity_ < count) capacity_ *= 2;
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo_);
+        glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(stride_ * capacity_), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        dirtyBegin_ = 0;
+        dirtyEnd_ = count;
+    } else if (count > old) {
+        for (size_t i = old; i < count; ++i) markDirty(i);
+    }
+    dirtyEnd_ = std::min(dirtyEnd_, count);
+    if (dirtyBegin_ >= dirtyEnd_) dirtyBegin_ = dirtyEnd_ = 0;
+}
+
+void ObjectUniformBuffer::markDirty(size_t slot) {
+    if (dirtyBegin_ == dirtyEnd_) {
+        dirtyBegin_ = slot;
+        dirtyEnd_ = slot + 1;
+    } else {
+        dirtyBegin_ = std::min(dirtyBegin_, slot);
+        dirtyEnd_ = std::max(dirtyEnd_, slot + 1);
+    }
+}
+
+// 更新对象数据
+// 法线矩阵为模型矩阵左上 3x3 的逆转置，只在模型矩阵变化时重算
+void ObjectUniformBuffer::set(size_t slot, const glm::mat4& model, const glm::vec3& color) {
+    if (slot >= objects_.size()) resize(slot + 1);
+    ObjectUniforms& o = objects_[slot];
+    const bool modelChanged = o.model != model;
+    if (!modelChanged && o.objectColor == color) return;
+    if (modelChanged) {
+        o.model = model;
+        o.normalMatrix = glm::mat4(glm::transpose(glm::inverse(glm::mat3(model))));
+    }
+    o.objectColor = color;
+    markDirty(slot);
+}
+
+size_t ObjectUniformBuffer::flush() {
+    if (dirtyBegin_ == dirtyEnd_) return 0;
+    const size_t count = dirtyEnd_ - dirtyBegin_;
+    staging_.resize(stride_ * count);
+    for (size_t i = 0; i < count; ++i) {
+        std::memcpy(staging_.data() + stride_ * i, &objects_[dirtyBegin_ + i], sizeof(ObjectUniforms));
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo_);
+    glBufferSubData(GL_UNIFORM_BUFFER, static_cast<GLintptr>(stride_ * dirtyBegin_),
+                    static_cast<GLsizeiptr>(staging_.size()), staging_.data());
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    uploadedBytes_ += staging_.size();
+    dirtyBegin_ = dirtyEnd_ = 0;
+    return staging_.size();
+}
+
+void ObjectUniformBuffer::bind(size_t slot) const {
+    GLState::shared().bindUniformRange(kObjectBlockBinding, ubo_, static_cast<GLintptr>(stride_ * slot),
+                                       sizeof(ObjectUniforms));
+}
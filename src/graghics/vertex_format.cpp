@@ -0,0 +1,136 @@
+#include "vertex_format.h"
+#include "mesh.h"
+#include "cube.h"
+#include "gtc/packing.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+uint16_t quantizeUnorm16(float v) {
+    v = std::min(std::max(v, 0.0f), 1.0f);
+    return static_cast<uint16_t>(v * 65535.0f + 0.5f);
+}
+
+int16_t quantizeSnorm16(float v) {
+    v = std::min(std::max(v, -1.0f), 1.0f);
+    return static_cast<int16_t>(std::lround(v * 32767.0f));
+}
+
+// 位置按量化参数压缩到 3 x unorm16
+void packPosition(const glm::vec3& p, const PositionQuantization& q, uint16_t out[3]) {
+    glm::vec3 n = (p - q.offset) / q.scale;
+    out[0] = quantizeUnorm16(n.x);
+    out[1] = quantizeUnorm16(n.y);
+    out[2] = quantizeUnorm16(n.z);
+}
+
+template <typename V>
+PositionQuantization quantizationFor(const std::vector<V>& in) {
+    if (in.empty()) return PositionQuantization{};
+    glm::vec3 minPos = in[0].Position, maxPos = in[0].Position;
+    for (const V& v : in) {
+        minPos = glm::min(minPos, v.Position);
+        maxPos = glm::max(maxPos, v.Position);
+    }
+    return computeQuantization(minPos, maxPos);
+}
+
+} // namespace
+
+PositionQuantization computeQuantization(const glm::vec3& minPos, const glm::vec3& maxPos) {
+    PositionQuantization q;
+    q.offset = minPos;
+    q.scale = glm::max(maxPos - minPos, glm::vec3(1e-6f));
+    return q;
+}
+
+// 八面体编码
+// 把单位球投影到 |x|+|y|+|z|=1 的八面体，下半球沿对角线折叠到上半平面
+void octEncode(const glm::vec3& n, int16_t out[2]) {
+    float l1 = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+    if (l1 <= 0.0f) {
+        out[0] = out[1] = 0;
+        return;
+    }
+    glm::vec2 p(n.x / l1, n.y / l1);
+    if (n.z < 0.0f) {
+        glm::vec2 folded((1.0f - std::fabs(p.y)) * (p.x >= 0.0f ? 1.0f : -1.0f),
+                         (1.0f - std::fabs(p.x)) * (p.y >= 0.0f ? 1.0f : -1.0f));
+        p = folded;
+    }
+    out[0] = quantizeSnorm16(p.x);
+    out[1] = quantizeSnorm16(p.y);
+}
+
+glm::vec3 octDecode(const int16_t in[2]) {
+    glm::vec2 e(std::max(in[0] / 32767.0f, -1.0f), std::max(in[1] / 32767.0f, -1.0f));
+    glm::vec3 n(e.x, e.y, 1.0f - std::fabs(e.x) - std::fabs(e.y));
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+PositionQuantization packVertices(const std::vector<Vertex>& in, std::vector<PackedVertex>& out) {
+    PositionQuantization q = quantizationFor(in);
+    out.resize(in.size());
+    for (size_t i = 0; i < in.size(); ++i) {
+        PackedVertex& v = out[i];
+        packPosition(in[i].Position, q, v.Position);
+        v.Padding = 0;
+        octEncode(in[i].Normal, v.Normal);
+        v.TexCoords[0] = glm::packHalf1x16(in[i].TexCoords.x);
+        v.TexCoords[1] = glm::packHalf1x16(in[i].TexCoords.y);
+    }
+    return q;
+}
+
+PositionQuantization packVertices(const std::vector<VertexCube>& in, std::vector<PackedVertexCube>& out) {
+    PositionQuantization q = quantizationFor(in);
+    out.resize(in.size());
+    for (size_t i = 0; i < in.size(); ++i) {
+        PackedVertexCube& v = out[i];
+        packPosition(in[i].Position, q, v.Position);
+        v.Padding = 0;
+        octEncode(in[i].Normal, v.Normal);
+        for (int c = 0; c < 3; ++c) v.Color[c] = static_cast<uint8_t>(quantizeUnorm16(in[i].Color[c]) >> 8);
+        v.Color[3] = 255;
+    }
+    return q;
+}
+
+void applyDecodeUniforms(Shader& shader, const PositionQuantization& quant, VertexFormat format) {
+    shader.set(kPosScale, quant.scale);
+    shader.set(kPosOffset, quant.offset);
+    shader.set(kOctNormals, format == VertexFormat::Packed);
+}
+
+// 配置顶点属性
+// 压缩格式的位置与法线以归一化整数读取，着色器中再反量化/解码
+void setupVertexAttributes(VertexFormat format, bool cube) {
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    if (format == VertexFormat::Float32) {
+        if (cube) {
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VertexCube), (void*)0);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(VertexCube), (void*)offsetof(VertexCube, Normal));
+            glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(VertexCube), (void*)offsetof(VertexCube, Color));
+        } else {
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+        }
+        return;
+    }
+    if (cube) {
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertexCube), (void*)0);
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertexCube), (void*)offsetof(PackedVertexCube, Normal));
+        glVertexAttribPointer(2, 3, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PackedVertexCube), (void*)offsetof(PackedVertexCube, Color));
+    } else {
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)0);
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, Normal));
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, TexCoords));
+    }
+}
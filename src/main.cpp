@@ -10,14 +10,65 @@
 #include "ui.h"
 #include "cube.h"
 #include "light.h"
+#include "bench.h"
+#include "thread_pool.h"
+#include "texture_streamer.h"
+#include "texture_registry.h"
+#include "geometry_pool.h"
+#include "program_cache.h"
+#include "shader_library.h"
+#include "shader_variants.h"
+#include "uniform_buffers.h"
+#include "gl_state.h"
+#include "gpu_timer.h"
+#include "render_queue.h"
+#include "frustum_cull.h"
+#include "bvh.h"
+#include "occlusion.h"
+#include "alloc_counter.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
 #include <vector>
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 
+namespace {
 
-int main()
+// 主循环中设置的 Uniform 名 (编译期哈希)
+constexpr UniformName kTexture1("texture1");
+constexpr UniformName kShadowMap("shadowMap");
+constexpr UniformName kShadowFace("shadowFace");
+
+// 遮挡体代理的三角形总数上限 (软件光栅化的每帧工作量)
+const size_t kOccluderTriangles = 20000;
+
+} // namespace
+
+int main(int argc, char** argv)
 {
+    // 基准测试模式：--bench <名称> [参数...]
+    std::string benchName;
+    std::vector<std::string> benchArgs;
+    if (argc >= 3 && std::string(argv[1]) == "--bench") {
+        benchName = argv[2];
+        for (int i = 3; i < argc; ++i) benchArgs.push_back(argv[i]);
+        // 纯 CPU 基准无需创建窗口
+        if (!bench_needs_gl(benchName)) return bench_run(benchName, benchArgs);
+    }
+
+    // 渲染选项
+    // --packed-vertices: 模型与立方体使用量化压缩顶点格式
+    // --sync-load: 阻塞加载整个模型后再进入渲染循环 (默认异步逐个发布网格)
+    ModelOptions modelOptions;
+    modelOptions.async = true;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--packed-vertices") modelOptions.vertexFormat = VertexFormat::Packed;
+        if (std::string(argv[i]) == "--sync-load") modelOptions.async = false;
+    }
+
     // 初始化 GLFW
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
@@ -27,6 +78,7 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (!benchName.empty()) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); // 基准模式使用隐藏窗口
     
     // 创建窗口
     GLFWwindow* window = glfwCreateWindow(1280, 720, "Model Example", nullptr, nullptr);
@@ -45,9 +97,24 @@ int main()
         glfwTerminate();
         return -1;
     }
+    // 3.3 上下文下 GLAD 不加载 4.1 函数；驱动提供 ARB_get_program_binary 时手动加载程序二进制接口
+    if (!glGetProgramBinary && glfwExtensionSupported("GL_ARB_get_program_binary")) {
+        glad_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)glfwGetProcAddress("glGetProgramBinary");
+        glad_glProgramBinary = (PFNGLPROGRAMBINARYPROC)glfwGetProcAddress("glProgramBinary");
+        glad_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)glfwGetProcAddress("glProgramParameteri");
+    }
     
-    // 开启深度测试
-    glEnable(GL_DEPTH_TEST);
+    // 需要 OpenGL 上下文的基准测试
+    if (!benchName.empty()) {
+        int rc = bench_run(benchName, benchArgs);
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return rc;
+    }
+
+    // 开启深度测试 (GL 状态统一经由 GLState 设置，重复设置不会调用驱动)
+    GLState& glState = GLState::shared();
+    glState.setDepthTest(true);
 
     // 设置清屏颜色
     glClearColor(0.2f, 0.3f, 0.4f, 1.0f);
@@ -71,31 +138,43 @@ int main()
     }
 
     // 编译着色器
-    Shader shader;      // 主场景着色器
-    Shader cubeShader;  // 立方体着色器
-    Shader depthShader; // 阴影深度图着色器
-    
-    if (!shader.compileFromFiles("resource/shader/vertex.vs", "resource/shader/pixel.vs")) {
-        std::cerr << "Shader error: " << shader.error() << std::endl;
-        glfwDestroyWindow(window);
-        glfwTerminate();
-        return -1;
-    }
-    if (!cubeShader.compileFromFiles("resource/shader/vertex_cube.vs", "resource/shader/pixel_cube.vs")) {
-        std::cerr << "Shader error: " << cubeShader.error() << std::endl;
-        glfwDestroyWindow(window);
-        glfwTerminate();
-        return -1;
-    }
-    if (!depthShader.compileFromFiles("resource/shader/depth.vs", "resource/shader/depth_frag.vs")) {
-        std::cerr << "Shader error: " << depthShader.error() << std::endl;
-        glfwDestroyWindow(window);
-        glfwTerminate();
-        return -1;
+    // 默认选项下的各程序一次性提交，驱动可并行编译；渲染循环在程序就绪前使用后备程序，不等待编译
+    // 场景与立方体着色器按特化选项 (纹理、描边、PCF 采样数) 编译为变体，其他组合在首次使用时再提交
+    // 链接后的程序二进制缓存在着色器目录下，热启动直接加载，驱动拒绝时自动回退到源码编译
+    ProgramBinaryCache programCache("resource/shader");
+    ShaderLibrary shaderLibrary(&programCache);
+    const double shaderStart = glfwGetTime();
+    ShaderVariants sceneVariants(shaderLibrary, "resource/shader/vertex.vs", "resource/shader/pixel.vs");        // 主场景着色器
+    ShaderVariants cubeVariants(shaderLibrary, "resource/shader/vertex_cube.vs", "resource/shader/pixel_cube.vs"); // 立方体着色器
+    Shader& depthProgram = shaderLibrary.add("resource/shader/depth.vs", "resource/shader/depth_frag.vs");     // 阴影深度图着色器
+    Shader& cubeDepthProgram = shaderLibrary.add("resource/shader/depth.vs", "resource/shader/depth_frag.vs",
+                                                 "#define INSTANCED 1\n");                                     // 立方体实例的阴影深度图着色器
+    // 分层渲染的深度程序：几何着色器把每个三角形发射到与其相交的面，6 个面一次提交
+    Shader& layeredDepthProgram = shaderLibrary.add("resource/shader/depth.vs", "resource/shader/depth_frag.vs",
+                                                    "#define LAYERED 1\n", "resource/shader/depth_layered.gs");
+    Shader& layeredCubeDepthProgram = shaderLibrary.add("resource/shader/depth.vs", "resource/shader/depth_frag.vs",
+                                                        "#define LAYERED 1\n#define INSTANCED 1\n", "resource/shader/depth_layered.gs");
+    {
+        ShaderPermutation p; // 默认选项与 UIState 的初始值一致
+        sceneVariants.request(p);
+        p.textured = false;
+        sceneVariants.request(p);
+        p.outline = false;
+        cubeVariants.request(p);
     }
+    std::cout << "Shader submit: " << (glfwGetTime() - shaderStart) * 1000.0 << " ms ("
+              << (shaderLibrary.parallel() ? "parallel compile" : "no parallel compile extension") << ")" << std::endl;
+    bool shaderStatsReported = false;
 
-    // 加载模型
-    Model sceneModel("resource/model/ark.glb");
+    // 共享 Uniform 缓冲区：每帧数据 (相机、光源、阴影参数) 三个程序共用，对象数据 (模型/法线矩阵、颜色) 按槽位只上传变化部分
+    // 槽位 0 为主模型；立方体的矩阵与颜色在实例缓冲区中
+    FrameUniformBuffer frameUniforms;
+    ObjectUniformBuffer objectUniforms;
+
+    // 共享几何池：模型网格与立方体各一个 (按顶点布局区分)，各自只有一个 VAO
+    GeometryPool meshPool(modelOptions.vertexFormat);
+    GeometryPool cubePool(modelOptions.vertexFormat, true, 64, 256);
+    modelOptions.geometryPool = &meshPool;
 
     // 初始化 UI 状态和光源
     UIState uistate;
@@ -104,13 +183,69 @@ int main()
     int init_w = 0, init_h = 0;
     glfwGetFramebufferSize(window, &init_w, &init_h);
     ui_init(uistate, init_w, init_h);
+    ui_compute_matrices(uistate, init_w, init_h);
     light.setupShadowCube(2048, 1.0f, 50.0f); // 设置阴影分辨率和裁剪平面
-    
+
+    // 加载模型 (纹理在后台解码，渲染循环中分帧上传)
+    // 异步加载时以初始相机位置为参考点，离相机近、尺寸大的网格先发布
+    TextureStreamer textureStreamer(ThreadPool::shared());
+    TextureRegistry textureRegistry(textureStreamer);
+    const double loadStart = glfwGetTime();
+    modelOptions.hasFocus = true;
+    modelOptions.focus = glm::vec3(glm::inverse(uistate.model) * glm::vec4(uistate.camera_pos, 1.0f));
+    Model sceneModel("resource/model/ark.glb", textureRegistry, modelOptions);
+    const ModelLoadStats& loadStats = sceneModel.loadStats();
+    bool firstFrameReported = false;
+    bool firstMeshReported = false;
+    bool loadReported = false;
+
     // 预创建一个单位立方体，用于后续复用渲染
     // 颜色参数这里给默认值，实际渲染时通过 uniform objectColor 控制
-    Cube unitCube(1.0f, 1.0f, 1.0f, glm::vec3(1.0f));
+    Cube unitCube(1.0f, 1.0f, 1.0f, glm::vec3(1.0f), modelOptions.vertexFormat, &cubePool);
+    // 所有可见立方体实例化绘制：每个 Pass 一次绘制调用，只上传参数变化的立方体
+    // 实例按场景存储的稠密下标排列，与可见段一一对应
+    CubeInstanceBuffer cubeInstances;
+    unitCube.attachInstances(cubeInstances);
+    glm::vec3 cubeCenter(0.0f);  // 可见立方体的包围球 (用于排序深度，场景变化时重算)
+    float cubeBoundsRadius = 0.0f;
+    // 逐面阴影投射体：每个面只保留会影响该面的立方体实例 (紧密排列，一次实例化绘制)
+    // GL 3.3 没有 baseInstance，每个面使用独立的实例缓冲区与 VAO (不放入几何池，池内共享一个 VAO)
+    CubeInstanceBuffer faceCubeInstances[6];
+    std::unique_ptr<Cube> faceCubes[6];
+    for (int face = 0; face < 6; ++face) {
+        faceCubes[face] = std::make_unique<Cube>(1.0f, 1.0f, 1.0f, glm::vec3(1.0f), modelOptions.vertexFormat);
+        faceCubes[face]->attachInstances(faceCubeInstances[face]);
+    }
+    std::vector<uint8_t> extraCasterMasks; // extraMeshes 各自影响的面
+    // 立方体的层次包围盒：以实体下标为对象，只包含可见的立方体 (只在立方体变化时更新)
+    // 主 Pass 视锥剔除、阴影投射体的光源范围查询与鼠标拾取都经由它，而不是遍历全部立方体
+    Bvh cubeBvh;
+    std::vector<uint32_t> cubeHits;
+    bool pickLast = false;
+    // 主 Pass 可见的实例挑选到独立的实例缓冲区，同样使用独立的 VAO
+    CubeInstanceBuffer visibleCubeInstances;
+    Cube visibleCube(1.0f, 1.0f, 1.0f, glm::vec3(1.0f), modelOptions.vertexFormat);
+    visibleCube.attachInstances(visibleCubeInstances);
+    // 遮挡剔除：主模型网格的简化代理光栅化到低分辨率的 CPU 深度缓冲区，通过视锥剔除的网格与立方体再以包围盒测试
+    OcclusionBuffer occlusionBuffer;
+    std::vector<OccluderMesh> occluders;
+    size_t occluderMeshCount = 0; // 生成代理时的网格数 (网格逐个发布时重新生成)
+    AabbSoA occludeeBoxes;
+    std::vector<uint8_t> occludeeVisible;
+    GLTexture occlusionTexture;   // 调试视图
+    std::vector<uint8_t> occlusionImage;
 
     std::vector<Mesh> extraMeshes;
+    // 渲染队列：每帧提交、排序一次后按 Pass 执行
+    RenderQueue renderQueue;
+    // 阴影 Pass 的 GPU 计时
+    GpuTimer shadowTimer;
+    // 阴影缓存：上次标记时的主模型状态与阴影相关设置
+    glm::mat4 shadowModel(0.0f);
+    size_t shadowMeshCount = 0;
+    glm::vec3 shadowModelCenter(0.0f);
+    float shadowModelRadius = 0.0f;
+    uint32_t lastShadowConfig = ~0u;
     double lastTime = glfwGetTime();
 
     // 渲染循环
@@ -118,6 +253,32 @@ int main()
         // 处理窗口事件
         glfwPollEvents();
 
+        // 轮询着色器编译：未就绪的场景/立方体程序由后备程序代替，阴影 Pass 等待深度程序就绪
+        shaderLibrary.update();
+        if (const Shader* failed = shaderLibrary.failed()) {
+            std::cerr << "Shader error: " << failed->error() << std::endl;
+            break;
+        }
+        if (!shaderStatsReported && shaderLibrary.done()) {
+            const ProgramCacheStats& programStats = programCache.stats();
+            std::cout << "Shader setup: " << shaderLibrary.doneMs() << " ms ("
+                      << (programCache.supported() ? "" : "program binary unsupported, ")
+                      << programStats.hits << " from binary cache, " << programStats.misses + programStats.rejected << " compiled, "
+                      << programStats.rejected << " rejected by driver)" << std::endl;
+            shaderStatsReported = true;
+        }
+        // 按当前选项选择变体 (描边宽度为 0 时使用无描边变体)；立方体没有纹理也不描边
+        ShaderPermutation permutation;
+        permutation.pcfSamples = uistate.shadow_pcf_samples;
+        permutation.outline = uistate.outlinewidth > 0.0f;
+        Shader& shader = sceneVariants.resolve(permutation);
+        permutation.textured = false;
+        Shader& untexturedShader = sceneVariants.resolve(permutation);
+        permutation.outline = false;
+        Shader& cubeShader = cubeVariants.resolve(permutation);
+        Shader& depthShader = depthProgram;
+        const bool shadowReady = depthProgram.ready();
+
         int w=0,h=0;
         glfwGetFramebufferSize(window, &w, &h);
 
@@ -132,130 +293,495 @@ int main()
 
         light.setPoint(uistate.light_pos, uistate.light_color);
 
+        // 平滑帧时间，按 LOD 开关分别统计以便对比
+        float& frameMs = uistate.lod_enabled ? uistate.frame_ms_lod_on : uistate.frame_ms_lod_off;
+        frameMs = frameMs > 0.0f ? frameMs * 0.95f + dt * 1000.0f * 0.05f : dt * 1000.0f;
+
+        // 发布后台加载完成的网格 (每帧数量有限，新网格在本帧即可绘制)
+        sceneModel.update();
+        uistate.load_meshes = sceneModel.meshCount();
+        uistate.load_total = sceneModel.expectedMeshCount();
+        for (int l = 0; l < kMaxLodLevels; ++l) {
+            uistate.lod_level_tris[l] = loadStats.lodTriangles[l];
+            if (loadStats.lodTriangles[l] > 0) uistate.lod_levels = std::max(uistate.lod_levels, l + 1);
+        }
+        uistate.cluster_count = loadStats.meshletCount;
+
+        // 按投影尺寸选择 LOD：主 Pass 以相机为视点，阴影 Pass 以光源为视点 (90° 视场、阴影贴图分辨率)
+        LodSettings lodSettings;
+        lodSettings.enabled = uistate.lod_enabled;
+        lodSettings.errorPixels = uistate.lod_error_px;
+        lodSettings.shadowBias = uistate.lod_shadow_bias;
+        lodSettings.hysteresis = uistate.lod_hysteresis;
+        float mainProjScale = float(h) / (2.0f * std::tan(glm::radians(uistate.camera_fov) * 0.5f));
+        float shadowProjScale = float(light.shadowSize()) * 0.5f;
+        LodPassStats mainLod = sceneModel.selectLods(uistate.model, uistate.view_pos, mainProjScale, lodSettings, LodPass::Main);
+        LodPassStats shadowLod = sceneModel.selectLods(uistate.model, light.position(), shadowProjScale, lodSettings, LodPass::Shadow);
+        for (int l = 0; l < kMaxLodLevels; ++l) {
+            uistate.lod_main_meshes[l] = mainLod.meshesPerLevel[l];
+            uistate.lod_shadow_meshes[l] = shadowLod.meshesPerLevel[l];
+        }
+        uistate.lod_main_tris = mainLod.triangles;
+        uistate.lod_shadow_tris = shadowLod.triangles * 6;
+        uistate.lod_full_tris = mainLod.fullTriangles;
+
+        // 按每帧预算上传已解码的纹理
+        textureStreamer.update();
+
+        // 网格与纹理全部驻留后输出加载统计 (完全加载时间)
+        if (!loadReported && !sceneModel.loading() && textureStreamer.pendingCount() == 0) {
+            std::cout << "Model loaded from " << (loadStats.fromCache ? "mesh cache" : "assimp")
+                      << ": " << loadStats.meshCount << " meshes in " << loadStats.loadMs << " ms, "
+                      << loadStats.uniqueTextures << " textures for " << loadStats.textureRefs << " references, "
+                      << (loadStats.vertexBytes + loadStats.indexBytes) / 1024 << " KiB geometry ("
+                      << (modelOptions.vertexFormat == VertexFormat::Packed ? "packed" : "float") << ", "
+                      << meshPool.allocationCount() << " meshes in geometry pool)" << std::endl;
+            if (!loadStats.fromCache && loadStats.optimize.triangles > 0) {
+                std::cout << "Mesh optimization: vertices " << loadStats.optimize.verticesBefore << " -> " << loadStats.optimize.verticesAfter
+                          << ", ACMR " << loadStats.optimize.acmrBefore() << " -> " << loadStats.optimize.acmrAfter()
+                          << ", ATVR " << loadStats.optimize.atvrBefore() << " -> " << loadStats.optimize.atvrAfter() << std::endl;
+            }
+            TextureShareStats share = sceneModel.textureShareStats();
+            std::cout << "Texture sharing: " << share.decodesSaved << " decodes and "
+                      << share.bytesSaved / 1024 << " KiB saved" << std::endl;
+            uistate.load_all_ms = float((glfwGetTime() - loadStart) * 1000.0);
+            std::cout << "Time to fully loaded: " << uistate.load_all_ms << " ms (meshes " << loadStats.allMeshesMs
+                      << " ms, " << (modelOptions.async ? "async" : "sync") << ")" << std::endl;
+            loadReported = true;
+        }
+
+        // 渲染部分的堆分配与 Uniform 计数 (稳定状态下分配与查找均应为 0)
+        const uint64_t allocsBefore = alloc_count();
+        const UniformCounters uniformsBefore = Shader::counters();
+        const GLStateCounters glBefore = glState.counters();
+
         // ---------------------------------------------------------
         // Pass 1: 阴影贴图生成 (Depth Pass)
         // ---------------------------------------------------------
-        float nearPlane = 1.0f;
+        // 立方体贴图 6 个面的矩阵由光源维护 (位置变化时重算)
         float farPlane = light.farPlane();
         glm::vec3 lightPos = light.position();
-        float aspect = 1.0f;
-        glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), aspect, nearPlane, farPlane);
-        
-        // 生成立方体贴图 6 个面的视图矩阵
-        glm::mat4 shadowTransforms[6];
-        shadowTransforms[0] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
-        shadowTransforms[1] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
-        shadowTransforms[2] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        shadowTransforms[3] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
-        shadowTransforms[4] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
-        shadowTransforms[5] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
-
-        depthShader.use();
-        depthShader.setVec3("lightPos", lightPos);
-        depthShader.setFloat("farPlane", farPlane);
-
-        light.beginDepthPass();
-        // 渲染场景到深度立方体贴图的 6 个面
-        for (int face = 0; face < 6; ++face) {
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, light.depthCubeTexture(), 0);
+        // 包住整个阴影范围 (以光源为中心、边长 2 * farPlane 的立方体)，用于分层渲染时的逐簇剔除
+        glm::mat4 shadowRange = glm::ortho(-farPlane, farPlane, -farPlane, farPlane, -farPlane, farPlane)
+                              * glm::translate(glm::mat4(1.0f), -lightPos);
+
+        // 每帧数据一次性写入 UBO，内容不变时跳过上传
+        FrameUniforms frame;
+        frame.view = uistate.view;
+        frame.projection = uistate.projection;
+        for (int face = 0; face < 6; ++face) frame.shadowMatrices[face] = light.faceMatrix(face);
+        frame.viewPos = uistate.view_pos;
+        frame.farPlane = farPlane;
+        frame.lightPos = lightPos;
+        frame.outlineWidth = uistate.outlinewidth;
+        frame.lightColor = light.color();
+        frameUniforms.update(frame);
+
+        // 对象数据：矩阵与颜色未变化的槽位不会重新上传 (法线矩阵只在模型矩阵变化时重算)
+        objectUniforms.resize(1);
+        objectUniforms.set(0, uistate.model);
+        objectUniforms.flush();
+
+        // 阴影缓存：主模型的变换、已发布网格数或阴影 LOD 变化时，以变化前后的包围球标记受影响的面
+        glm::vec3 modelCenter(0.0f);
+        float modelRadius = 0.0f;
+        const bool hasModelBounds = sceneModel.worldBounds(uistate.model, modelCenter, modelRadius);
+        if (uistate.model != shadowModel || sceneModel.meshCount() != shadowMeshCount || shadowLod.changed > 0) {
+            if (shadowModelRadius > 0.0f) light.markCasterChanged(shadowModelCenter, shadowModelRadius);
+            if (hasModelBounds) light.markCasterChanged(modelCenter, modelRadius);
+            shadowModel = uistate.model;
+            shadowMeshCount = sceneModel.meshCount();
+            shadowModelCenter = modelCenter;
+            shadowModelRadius = hasModelBounds ? modelRadius : 0.0f;
+        }
+
+        // 立方体：场景存储只为变化的实体重算世界矩阵与包围体
+        // 变化 (含删除) 的实体以新旧包围球标记阴影面，并更新层次包围盒
+        SceneStore& scene = uistate.scene;
+        scene.update();
+        const bool sceneChanged = !scene.changes().empty();
+        for (const SceneChange& c : scene.changes()) {
+            if (c.wasVisible) light.markCasterChanged(c.oldCenter, c.oldRadius);
+            const uint32_t d = scene.denseIndex(c.index);
+            if (d != SceneStore::kNull && d < scene.visibleCount()) {
+                const glm::vec3& center = scene.boundsCenter(d);
+                const glm::vec3& extent = scene.boundsExtent(d);
+                light.markCasterChanged(center, scene.boundsRadius(d));
+                cubeBvh.set(c.index, center - extent, center + extent);
+            } else {
+                cubeBvh.remove(c.index);
+            }
+        }
+        scene.clearChanges();
+        // 有变化时按可见段重新写入实例 (删除或显隐会交换稠密位置；内容不变的实例不上传)，同时求可见立方体的包围盒
+        const size_t visibleCubes = scene.visibleCount();
+        if (sceneChanged) {
+            cubeInstances.resize(visibleCubes);
+            glm::vec3 cubeMin(0.0f), cubeMax(0.0f);
+            for (size_t d = 0; d < visibleCubes; ++d) {
+                cubeInstances.set(d, scene.world(d), scene.color(d));
+                const glm::vec3& c = scene.boundsCenter(d);
+                const float r = scene.boundsRadius(d);
+                cubeMin = d ? glm::min(cubeMin, c - r) : c - r;
+                cubeMax = d ? glm::max(cubeMax, c + r) : c + r;
+            }
+            cubeCenter = (cubeMin + cubeMax) * 0.5f;
+            cubeBoundsRadius = glm::length(cubeMax - cubeMin) * 0.5f;
+        }
+        size_t instanceBytes = cubeInstances.flush();
+        const uint32_t cubeDraws = uint32_t(visibleCubes);
+        // 重新拟合移动过的立方体，树质量下降过多时整体重建
+        cubeBvh.maintain();
+        uistate.bvh = cubeBvh.stats();
+
+        // 鼠标拾取 (UI 激活、光标可见时左键点击场景)：射线先经层次包围盒筛选，再在立方体局部空间精确求交
+        const bool pickDown = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+        if (pickDown && !pickLast && uistate.ui_active && !ImGui::GetIO().WantCaptureMouse) {
+            double cx = 0.0, cy = 0.0;
+            int ww = 0, wh = 0;
+            glfwGetCursorPos(window, &cx, &cy);
+            glfwGetWindowSize(window, &ww, &wh);
+            if (ww > 0 && wh > 0) {
+                const glm::mat4 invViewProj = glm::inverse(uistate.projection * uistate.view);
+                const float nx = float(2.0 * cx / ww - 1.0), ny = float(1.0 - 2.0 * cy / wh);
+                const glm::vec4 nearPt = invViewProj * glm::vec4(nx, ny, -1.0f, 1.0f);
+                const glm::vec4 farPt = invViewProj * glm::vec4(nx, ny, 1.0f, 1.0f);
+                const glm::vec3 origin = glm::vec3(nearPt) / nearPt.w;
+                const glm::vec3 dir = glm::vec3(farPt) / farPt.w - origin;
+                cubeHits.clear();
+                cubeBvh.queryRay(origin, dir, 1.0f, cubeHits);
+                float bestT = 2.0f;
+                for (uint32_t i : cubeHits) {
+                    // 射线参数 t 在仿射变换下不变，局部空间中单位立方体为 [-0.5, 0.5]^3
+                    const glm::mat4 inv = glm::inverse(scene.world(scene.denseIndex(i)));
+                    const glm::vec3 o = glm::vec3(inv * glm::vec4(origin, 1.0f));
+                    const glm::vec3 d = glm::vec3(inv * glm::vec4(dir, 0.0f));
+                    float t = 0.0f;
+                    if (aabb_ray_overlap(glm::vec3(-0.5f), glm::vec3(0.5f), o, 1.0f / d, 1.0f, &t) && t < bestT) {
+                        bestT = t;
+                        uistate.selected_cube = scene.handle(i);
+                    }
+                }
+            }
+        }
+        pickLast = pickDown;
+
+        // 构建渲染队列：阴影立方体贴图的 6 个面为 Pass 0 - 5 (分层渲染时只用 Pass 0)，主场景为 Pass 6
+        // 逐簇剔除的结果按 Pass 追加到同一条索引流，全部提交后上传一次，再统一排序
+        // 分层渲染需要两个分层深度程序都已就绪，否则本帧仍逐面渲染
+        const uint32_t kMainPass = 6;
+        const bool layered = uistate.shadow_layered && layeredDepthProgram.ready() && layeredCubeDepthProgram.ready();
+        Shader& shadowMeshShader = layered ? layeredDepthProgram : depthShader;
+        Shader& shadowCubeShader = layered ? layeredCubeDepthProgram : cubeDepthProgram;
+
+        // 影响阴影内容但不属于具体投射体的设置 (剔除选项、渲染模式、深度程序是否就绪) 变化时全部面失效
+        const uint32_t shadowConfig = (shadowReady ? 1u : 0u) | (shadowCubeShader.ready() ? 2u : 0u) | (layered ? 4u : 0u)
+                                    | (uistate.cluster_culling ? 8u : 0u) | (uistate.cluster_backface_shadow ? 16u : 0u);
+        if (shadowConfig != lastShadowConfig) {
+            light.invalidateShadow();
+            lastShadowConfig = shadowConfig;
+        }
+        // 只渲染失效的面；分层渲染一次覆盖全部 6 个面
+        uint8_t shadowFaces = light.dirtyFaces();
+        if (layered && shadowFaces) shadowFaces = 0x3F;
+        int renderedFaces = 0;
+        for (int face = 0; face < 6; ++face) renderedFaces += (shadowFaces >> face) & 1;
+        uistate.shadow_faces_rendered = renderedFaces;
+        uistate.shadow_faces_skipped = 6 - renderedFaces;
+        uistate.shadow_version = light.shadowVersion();
+
+        const double shadowCpuStart = glfwGetTime();
+        renderQueue.clear();
+        sceneModel.resetClusterStream();
+        uistate.cluster_shadow = ClusterCullStats{};
+        for (int face = 0; face < 6; ++face) uistate.shadow_casters[face] = 0;
+        uistate.shadow_caster_candidates = sceneModel.meshCount() + extraMeshes.size() + visibleCubes;
+        if (shadowReady && shadowFaces) {
+            // 逐面投射体剔除：按世界空间包围球求每个投射体影响的面 (面视锥 + 远平面范围)，只提交到这些面
+            // 分层渲染只有一次提交，面的划分交给几何着色器，这里只排除阴影范围外的投射体
+            sceneModel.classifyCasters(light, uistate.model);
+            extraCasterMasks.resize(extraMeshes.size());
+            for (size_t i = 0; i < extraMeshes.size(); ++i) {
+                glm::vec3 c;
+                float r;
+                extraMeshes[i].worldSphere(uistate.model, c, r);
+                extraCasterMasks[i] = light.casterFaces(c, r);
+            }
+            // 立方体按面挑选实例写入各面的实例缓冲区 (内容不变时不上传)，同时求各面实例的包围盒
+            // 候选立方体由层次包围盒按光源范围 (以光源为球心、远平面为半径的球) 查询，结果按下标排序以保持实例顺序稳定
+            uint32_t faceCubeCount[6] = {};
+            glm::vec3 faceMin[6], faceMax[6];
+            if (!layered && shadowCubeShader.ready()) {
+                cubeHits.clear();
+                cubeBvh.querySphere(lightPos, farPlane, cubeHits);
+                std::sort(cubeHits.begin(), cubeHits.end());
+                for (uint32_t i : cubeHits) {
+                    const uint32_t d = scene.denseIndex(i);
+                    const glm::vec3& c = scene.boundsCenter(d);
+                    const float r = scene.boundsRadius(d);
+                    const uint8_t mask = light.casterFaces(c, r) & shadowFaces;
+                    for (int face = 0; face < 6; ++face) {
+                        if (!(mask & (1u << face))) continue;
+                        uint32_t& n = faceCubeCount[face];
+                        faceMin[face] = n ? glm::min(faceMin[face], c - r) : c - r;
+                        faceMax[face] = n ? glm::max(faceMax[face], c + r) : c + r;
+                        faceCubeInstances[face].set(n++, cubeInstances.instance(d));
+                    }
+                }
+                for (int face = 0; face < 6; ++face) {
+                    if (!(shadowFaces & (1u << face))) continue;
+                    faceCubeInstances[face].resize(faceCubeCount[face]);
+                    instanceBytes += faceCubeInstances[face].flush();
+                }
+            }
+
+            const int faces = layered ? 1 : 6;
+            for (int face = 0; face < faces; ++face) {
+                if (!layered && !(shadowFaces & (1u << face))) continue;
+                RenderView view;
+                view.pass = uint32_t(face);
+                view.lodPass = LodPass::Shadow;
+                view.eye = lightPos;
+                view.depthRange = farPlane;
+                // 主模型 (逐簇剔除使用当前面的视锥；分层渲染时使用包住阴影范围的立方体，面的划分交给几何着色器)
+                if (uistate.cluster_culling) {
+                    const glm::mat4 cullMatrix = layered ? shadowRange : light.faceMatrix(face);
+                    uistate.cluster_shadow += sceneModel.cullClusters(uistate.model, cullMatrix, lightPos,
+                                                                      uistate.cluster_backface_shadow, LodPass::Shadow);
+                }
+                const uint8_t faceMask = layered ? uint8_t(0x3F) : uint8_t(1u << face);
+                size_t& casters = uistate.shadow_casters[face];
+                casters += sceneModel.submit(renderQueue, view, shadowMeshShader, shadowMeshShader, 0, uistate.model,
+                                             uistate.cluster_culling, faceMask);
+                for (size_t i = 0; i < extraMeshes.size(); ++i) {
+                    if (!(extraCasterMasks[i] & faceMask)) continue;
+                    renderQueue.submitMesh(view, shadowMeshShader, extraMeshes[i], 0, uistate.model);
+                    ++casters;
+                }
+                // 动态添加的立方体 (一次实例化绘制；逐面渲染时只绘制该面挑选出的实例)
+                if (!shadowCubeShader.ready()) continue;
+                if (layered) {
+                    renderQueue.submitCubes(view, shadowCubeShader, unitCube, cubeDraws, cubeCenter, cubeBoundsRadius);
+                    casters += visibleCubes;
+                } else if (faceCubeCount[face] > 0) {
+                    const glm::vec3 center = (faceMin[face] + faceMax[face]) * 0.5f;
+                    const float radius = glm::length(faceMax[face] - faceMin[face]) * 0.5f;
+                    renderQueue.submitCubes(view, shadowCubeShader, *faceCubes[face], faceCubeCount[face], center, radius);
+                    casters += faceCubeCount[face];
+                }
+            }
+        }
+        double shadowCpuMs = (glfwGetTime() - shadowCpuStart) * 1000.0;
+        {
+            RenderView view;
+            view.pass = kMainPass;
+            view.lodPass = LodPass::Main;
+            view.eye = uistate.view_pos;
+            view.depthRange = 200.0f; // 与相机投影的远平面一致
+            if (uistate.cluster_culling) {
+                uistate.cluster_main = sceneModel.cullClusters(uistate.model, uistate.projection * uistate.view, uistate.view_pos,
+                                                               uistate.cluster_backface_main, LodPass::Main);
+            } else {
+                uistate.cluster_main = ClusterCullStats{};
+            }
+            // 视锥剔除：网格与立方体的包围盒批量测试，只提交可见的网格，可见立方体挑选后一次实例化绘制
+            const double cullStart = glfwGetTime();
+            const Frustum cameraFrustum = Frustum::fromMatrix(uistate.projection * uistate.view);
+            uint8_t mainMask = 0;
+            Cube* mainCube = &unitCube;
+            uint32_t mainCubeDraws = cubeDraws;
+            uistate.frustum_meshes = FrustumCullStats{};
+            uistate.frustum_cubes = FrustumCullStats{};
+            uistate.bvh_query_nodes = 0;
+            uistate.occlusion_raster = OcclusionRasterStats{};
+            uistate.occlusion_tested = 0;
+            uistate.occlusion_meshes = 0;
+            uistate.occlusion_cubes = 0;
+            uistate.occlusion_ms = 0.0f;
+            uistate.occlusion_texture = 0;
+            if (uistate.frustum_culling || uistate.occlusion_culling) {
+                // 候选：开启视锥剔除时为视锥内的网格与立方体，否则为全部网格与可见立方体 (只做遮挡剔除)
+                const FrustumCullStats candidateMeshes =
+                    sceneModel.cullMeshes(uistate.model, uistate.frustum_culling ? &cameraFrustum : nullptr);
+                mainMask = kMainPassMask;
+                // 立方体经层次包围盒查询，按下标排序使实例顺序不受树结构 (重建、插入) 影响
+                cubeHits.clear();
+                if (uistate.frustum_culling) {
+                    uistate.bvh_query_nodes = cubeBvh.queryFrustum(cameraFrustum, cubeHits);
+                    uistate.frustum_meshes = candidateMeshes;
+                    uistate.frustum_cubes.tested = visibleCubes;
+                    uistate.frustum_cubes.visible = cubeHits.size();
+                } else {
+                    for (size_t d = 0; d < visibleCubes; ++d) cubeHits.push_back(scene.handleAt(d).index);
+                }
+                std::sort(cubeHits.begin(), cubeHits.end());
+                if (uistate.occlusion_culling) {
+                    // 遮挡剔除：光栅化遮挡体代理后测试候选网格与立方体，被遮挡的立方体从候选中移除
+                    const double occlusionStart = glfwGetTime();
+                    if (occluderMeshCount != sceneModel.meshCount()) {
+                        sceneModel.buildOccluders(kOccluderTriangles, occluders);
+                        occluderMeshCount = sceneModel.meshCount();
+                    }
+                    occlusionBuffer.begin(uistate.projection * uistate.view);
+                    for (const OccluderMesh& o : occluders) occlusionBuffer.addOccluder(o, uistate.model);
+                    occlusionBuffer.rasterize(&ThreadPool::shared());
+                    uistate.occlusion_meshes = sceneModel.cullOccluded(occlusionBuffer);
+                    occludeeBoxes.resize(cubeHits.size());
+                    for (size_t k = 0; k < cubeHits.size(); ++k) {
+                        const uint32_t d = scene.denseIndex(cubeHits[k]);
+                        occludeeBoxes.set(k, scene.boundsCenter(d), scene.boundsExtent(d));
+                    }
+                    occludeeVisible.assign(cubeHits.size(), 1);
+                    uistate.occlusion_cubes = occlusionBuffer.cullBoxes(occludeeBoxes, occludeeVisible, &ThreadPool::shared());
+                    size_t kept = 0;
+                    for (size_t k = 0; k < cubeHits.size(); ++k) {
+                        if (occludeeVisible[k]) cubeHits[kept++] = cubeHits[k];
+                    }
+                    cubeHits.resize(kept);
+                    uistate.occlusion_raster = occlusionBuffer.stats();
+                    uistate.occlusion_tested = candidateMeshes.visible + occludeeVisible.size();
+                    uistate.occlusion_ms = float((glfwGetTime() - occlusionStart) * 1000.0);
+
+                    if (uistate.occlusion_debug) {
+                        if (!occlusionTexture.id) {
+                            glGenTextures(1, &occlusionTexture.id);
+                            glState.bindTexture(GL_TEXTURE_2D, occlusionTexture.id);
+                            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                        }
+                        occlusionBuffer.debugImage(occlusionImage);
+                        glState.bindTexture(GL_TEXTURE_2D, occlusionTexture.id);
+                        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, occlusionBuffer.width(), occlusionBuffer.height(), 0,
+                                     GL_RGBA, GL_UNSIGNED_BYTE, occlusionImage.data());
+                        uistate.occlusion_texture = occlusionTexture.id;
+                        uistate.occlusion_size[0] = occlusionBuffer.width();
+                        uistate.occlusion_size[1] = occlusionBuffer.height();
+                    }
+                }
+                uint32_t n = 0;
+                for (uint32_t i : cubeHits) visibleCubeInstances.set(n++, cubeInstances.instance(scene.denseIndex(i)));
+                visibleCubeInstances.resize(n);
+                instanceBytes += visibleCubeInstances.flush();
+                mainCube = &visibleCube;
+                mainCubeDraws = n;
+            }
+            uistate.frustum_cull_ms = float((glfwGetTime() - cullStart) * 1000.0);
+
+            sceneModel.submit(renderQueue, view, shader, untexturedShader, 0, uistate.model, uistate.cluster_culling, mainMask);
+            for (auto& m : extraMeshes) {
+                glm::vec3 c;
+                float r;
+                m.worldSphere(uistate.model, c, r);
+                if (uistate.frustum_culling && !cameraFrustum.intersectsSphere(c, r)) continue;
+                renderQueue.submitMesh(view, m.hasTexture() ? shader : untexturedShader, m, 0, uistate.model);
+            }
+            renderQueue.submitCubes(view, cubeShader, *mainCube, mainCubeDraws, cubeCenter, cubeBoundsRadius);
+        }
+        uistate.frame_instance_bytes = instanceBytes;
+        sceneModel.uploadClusterStream();
+        renderQueue.sort();
+        renderQueue.resetStats();
+
+        // 面索引的句柄在面循环外解析一次 (分层程序不使用面索引)
+        const double shadowExecStart = glfwGetTime();
+        UniformHandle<int> shadowFaceHandle;
+        UniformHandle<int> cubeShadowFaceHandle;
+        const bool cubeShadowReady = shadowReady && cubeDepthProgram.ready() && cubeDraws > 0;
+        if (shadowReady && !layered) {
+            depthShader.use();
+            shadowFaceHandle = depthShader.handle<int>(kShadowFace);
+        }
+        if (cubeShadowReady && !layered) {
+            cubeDepthProgram.use();
+            cubeShadowFaceHandle = cubeDepthProgram.handle<int>(kShadowFace);
+        }
+
+        glState.setDepthTest(true);
+        if (shadowFaces == 0) {
+            // 阴影贴图仍然有效，跳过整个深度 Pass
+        } else if (layered) {
+            // 整个立方体贴图作为分层附件，一次清除、一次提交
+            shadowTimer.begin(1);
+            light.beginDepthPass();
+            light.attachDepthFace(-1);
             glClear(GL_DEPTH_BUFFER_BIT);
+            renderQueue.execute(0, objectUniforms);
+        } else {
+            // 渲染场景到深度立方体贴图的失效面
+            shadowTimer.begin(0);
+            light.beginDepthPass();
+            for (int face = 0; face < 6; ++face) {
+                if (!(shadowFaces & (1u << face))) continue;
+                light.attachDepthFace(face);
+                glClear(GL_DEPTH_BUFFER_BIT);
+                if (!shadowReady) continue; // 深度程序就绪前阴影贴图保持清空 (无阴影)
 
-            depthShader.setMat4("lightSpaceMatrix", shadowTransforms[face]);
-            depthShader.setMat4("model", uistate.model);
-            
-            // 绘制主模型
-            sceneModel.Draw(depthShader);
-            for (auto& m : extraMeshes) m.Draw(depthShader);
-            
-            // 绘制动态添加的立方体
-            if (!uistate.cubes.empty()) {
-                for (const auto& cfg : uistate.cubes) {
-                    if (!cfg.visible) continue;
-                    glm::mat4 rx = glm::rotate(glm::mat4(1.0f), glm::radians(cfg.rot.x), glm::vec3(1.0f, 0.0f, 0.0f));
-                    glm::mat4 ry = glm::rotate(glm::mat4(1.0f), glm::radians(cfg.rot.y), glm::vec3(0.0f, 1.0f, 0.0f));
-                    glm::mat4 rz = glm::rotate(glm::mat4(1.0f), glm::radians(cfg.rot.z), glm::vec3(0.0f, 0.0f, 1.0f));
-                    glm::mat4 t = glm::translate(glm::mat4(1.0f), cfg.pos);
-                    glm::mat4 s = glm::scale(glm::mat4(1.0f), glm::vec3(cfg.scale));
-                    // Apply scale for unit cube
-                    glm::mat4 sizeScale = glm::scale(glm::mat4(1.0f), glm::vec3(cfg.length, cfg.width, cfg.height));
-                    glm::mat4 modelcube = t * rz * ry * rx * s * sizeScale;
-                    depthShader.setMat4("model", modelcube);
-                    
-                    // Use unitCube for depth pass too
-                    unitCube.Draw(depthShader);
+                depthShader.use();
+                depthShader.set(shadowFaceHandle, face);
+                if (cubeShadowReady) {
+                    cubeDepthProgram.use();
+                    cubeDepthProgram.set(cubeShadowFaceHandle, face);
                 }
+                renderQueue.execute(uint32_t(face), objectUniforms);
             }
         }
         light.endDepthPass();
+        shadowTimer.end();
+        shadowCpuMs += (glfwGetTime() - shadowExecStart) * 1000.0;
+
+        light.markFacesRendered(shadowReady ? shadowFaces : 0);
+
+        // 平滑阴影 Pass 耗时，按模式分别统计以便对比 (CPU 只统计实际渲染的帧)
+        // GPU 结果来自几帧前，按查询提交时的模式计入，每个结果只计入一次
+        if (shadowFaces) {
+            float& cpuMs = uistate.shadow_cpu_ms[layered ? 1 : 0];
+            cpuMs = cpuMs > 0.0f ? cpuMs * 0.95f + float(shadowCpuMs) * 0.05f : float(shadowCpuMs);
+        }
+        GpuTimer::Result shadowGpu;
+        while (shadowTimer.popResult(shadowGpu)) {
+            float& gpuMs = uistate.shadow_gpu_ms[shadowGpu.tag];
+            gpuMs = gpuMs > 0.0f ? gpuMs * 0.95f + float(shadowGpu.ms) * 0.05f : float(shadowGpu.ms);
+        }
+        uistate.shadow_layered_active = layered;
 
         // ---------------------------------------------------------
         // Pass 2: 正常场景渲染 (Lighting Pass)
         // ---------------------------------------------------------
-        glViewport(0, 0, w, h);
+        glState.viewport(0, 0, w, h);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+        // 设置采样器单元 (相机与光源参数来自 FrameData 块)，各变体各自保存 Uniform 状态
+        untexturedShader.use();
+        untexturedShader.set(kShadowMap, 1);
         shader.use();
-        // 设置 Uniforms
-        GLint locModel = shader.uniform("model");
-        GLint locView = shader.uniform("view");
-        GLint locProj = shader.uniform("projection");
-        if (locModel >= 0) glUniformMatrix4fv(locModel, 1, GL_FALSE, glm::value_ptr(uistate.model));
-        if (locView >= 0) glUniformMatrix4fv(locView, 1, GL_FALSE, glm::value_ptr(uistate.view));
-        if (locProj >= 0) glUniformMatrix4fv(locProj, 1, GL_FALSE, glm::value_ptr(uistate.projection));
-
-        shader.setVec3("viewPos", uistate.view_pos);
-        shader.setVec3("lightPos", light.position());
-        shader.setVec3("lightColor", light.color());
-        shader.setFloat("outlineWidth", uistate.outlinewidth);
-        shader.setInt("texture1", 0);
-        shader.setInt("shadowMap", 1);
-        shader.setFloat("farPlane", farPlane);
+        shader.set(kTexture1, 0);
+        shader.set(kShadowMap, 1);
+        cubeShader.use();
+        cubeShader.set(kShadowMap, 1);
 
         // 绑定阴影贴图
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, light.depthCubeTexture());
-
-        // 绘制主模型
-        sceneModel.Draw(shader);
-        for (auto& m : extraMeshes) m.Draw(shader);
-
-        // 绘制动态添加的立方体
-        if (!uistate.cubes.empty()) {
-            cubeShader.use();
-            GLint cubeModel = cubeShader.uniform("model");
-            GLint cubeView = cubeShader.uniform("view");
-            GLint cubeProj = cubeShader.uniform("projection");
-            if (cubeView >= 0) glUniformMatrix4fv(cubeView, 1, GL_FALSE, glm::value_ptr(uistate.view));
-            if (cubeProj >= 0) glUniformMatrix4fv(cubeProj, 1, GL_FALSE, glm::value_ptr(uistate.projection));
-            cubeShader.setVec3("lightPos", light.position());
-            cubeShader.setVec3("lightColor", light.color());
-            cubeShader.setInt("shadowMap", 1);
-            cubeShader.setFloat("farPlane", farPlane);
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_CUBE_MAP, light.depthCubeTexture());
-            for (const auto& cfg : uistate.cubes) {
-                if (!cfg.visible) continue;
-                glm::mat4 rx = glm::rotate(glm::mat4(1.0f), glm::radians(cfg.rot.x), glm::vec3(1.0f, 0.0f, 0.0f));
-                glm::mat4 ry = glm::rotate(glm::mat4(1.0f), glm::radians(cfg.rot.y), glm::vec3(0.0f, 1.0f, 0.0f));
-                glm::mat4 rz = glm::rotate(glm::mat4(1.0f), glm::radians(cfg.rot.z), glm::vec3(0.0f, 0.0f, 1.0f));
-                glm::mat4 t = glm::translate(glm::mat4(1.0f), cfg.pos);
-                glm::mat4 s = glm::scale(glm::mat4(1.0f), glm::vec3(cfg.scale));
-                // 应用长宽高的缩放（因为现在使用单位立方体）
-                glm::mat4 sizeScale = glm::scale(glm::mat4(1.0f), glm::vec3(cfg.length, cfg.width, cfg.height));
-                glm::mat4 modelcube = t * rz * ry * rx * s * sizeScale;
-                
-                if (cubeModel >= 0) glUniformMatrix4fv(cubeModel, 1, GL_FALSE, glm::value_ptr(modelcube));
-                
-                // 设置颜色 Uniform
-                cubeShader.setVec3("objectColor", cfg.color);
-                
-                // 使用复用的单位立方体进行绘制
-                unitCube.Draw(cubeShader);
-            }
-        }
+        glState.bindTexture(1, GL_TEXTURE_CUBE_MAP, light.depthCubeTexture());
+
+        // 按排序结果绘制主模型与立方体
+        renderQueue.execute(kMainPass, objectUniforms);
+        const RenderQueueStats& queueStats = renderQueue.stats();
+        uistate.queue_packets = queueStats.packets;
+        uistate.queue_program_changes = queueStats.programChanges;
+        uistate.queue_material_changes = queueStats.materialChanges;
+        uistate.queue_geometry_changes = queueStats.geometryChanges;
 
         // 显式解绑 VAO，避免干扰 ImGui
-        glBindVertexArray(0);
+        glState.bindVertexArray(0);
+
+        const UniformCounters& uniformsAfter = Shader::counters();
+        uistate.frame_allocs = alloc_count() - allocsBefore;
+        uistate.frame_uniform_lookups = uniformsAfter.lookups - uniformsBefore.lookups;
+        uistate.frame_uniform_uploads = uniformsAfter.uploads - uniformsBefore.uploads;
+        uistate.frame_uniform_redundant = uniformsAfter.redundant - uniformsBefore.redundant;
+        uistate.frame_gl_issued = glState.counters().issued - glBefore.issued;
+        uistate.frame_gl_elided = glState.counters().elided - glBefore.elided;
 
         // ---------------------------------------------------------
         // UI 渲染
@@ -270,9 +796,24 @@ int main()
         // 提交 UI 渲染
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        // ImGui 后端直接调用 GL (虽会恢复大部分状态)，保守起见使状态缓存失效
+        glState.invalidate();
 
         // 交换缓冲区
         glfwSwapBuffers(window);
+
+        // 首帧时间与首个网格可见时间 (从开始加载模型算起)
+        if (!firstFrameReported) {
+            uistate.load_first_frame_ms = float((glfwGetTime() - loadStart) * 1000.0);
+            std::cout << "Time to first frame: " << uistate.load_first_frame_ms << " ms (" << sceneModel.meshCount()
+                      << " meshes resident)" << std::endl;
+            firstFrameReported = true;
+        }
+        if (!firstMeshReported && sceneModel.meshCount() > 0) {
+            uistate.load_first_mesh_ms = float((glfwGetTime() - loadStart) * 1000.0);
+            std::cout << "Time to first mesh drawn: " << uistate.load_first_mesh_ms << " ms" << std::endl;
+            firstMeshReported = true;
+        }
     }
     
     // 清理 ImGui 资源
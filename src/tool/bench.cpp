@@ -0,0 +1,1170 @@
+#include "bench.h"
+#include "model.h"
+#include "mesh_cache.h"
+#include "cluster_culling.h"
+#include "frustum_cull.h"
+#include "bvh.h"
+#include "occlusion.h"
+#include "scene_store.h"
+#include "gtc/constants.hpp"
+#include "gtc/matrix_transform.hpp"
+#include "vertex_format.h"
+#include "thread_pool.h"
+#include "texture_streamer.h"
+#include "texture_registry.h"
+#include "program_cache.h"
+#include "shader.h"
+#include "cube.h"
+#include "instance_buffer.h"
+#include "uniform_buffers.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// 基准描述
+struct BenchEntry {
+    const char* name;   // 命令行名称
+    bool needsGL;       // 是否需要 OpenGL 上下文
+    int (*run)(const std::vector<std::string>& args);
+    const char* usage;  // 参数说明
+};
+
+double elapsedMs(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+// 模型缓存冷/热启动对比
+// 冷启动：删除缓存后加载 (Assimp 导入 + 解码 + 写缓存)；热启动：直接读取映射缓存
+// 计时包含等待全部纹理驻留 (TextureStreamer::finish)
+int benchModelCache(const std::vector<std::string>& args)
+{
+    std::string path = args.empty() ? "resource/model/ark.glb" : args[0];
+    int runs = args.size() > 1 ? std::max(1, std::atoi(args[1].c_str())) : 3;
+    TextureStreamer streamer(ThreadPool::shared());
+    TextureRegistry registry(streamer);
+
+    std::remove(MeshCache::pathFor(path).c_str());
+    ModelLoadStats cold;
+    TextureShareStats share;
+    double coldMs = 0.0;
+    {
+        auto start = std::chrono::steady_clock::now();
+        Model m(path.c_str(), registry);
+        streamer.finish();
+        coldMs = elapsedMs(start);
+        cold = m.loadStats();
+        share = m.textureShareStats();
+    }
+    if (cold.meshCount == 0 || cold.fromCache) {
+        std::cerr << "model-cache: failed to import " << path << std::endl;
+        return -1;
+    }
+
+    double warmTotal = 0.0;
+    double warmBest = 0.0;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        Model m(path.c_str(), registry);
+        streamer.finish();
+        double ms = elapsedMs(start);
+        if (!m.loadStats().fromCache) {
+            std::cerr << "model-cache: warm load missed the cache" << std::endl;
+            return -1;
+        }
+        warmTotal += ms;
+        if (i == 0 || ms < warmBest) warmBest = ms;
+    }
+
+    std::cout << "model-cache " << path << "\n"
+              << "  meshes:   " << cold.meshCount << ", vertices: " << cold.vertexCount
+              << ", indices: " << cold.indexCount << "\n"
+              << "  textures: " << cold.uniqueTextures << " unique for " << cold.textureRefs << " references, "
+              << share.decodesSaved << " decodes and " << share.bytesSaved / 1024 << " KiB saved\n"
+              << "  cold:     " << coldMs << " ms (assimp + decode + cache write)\n"
+              << "  warm avg: " << warmTotal / runs << " ms, best: " << warmBest << " ms (" << runs << " runs)\n"
+              << "  speedup:  " << coldMs / std::max(warmTotal / runs, 1e-3) << "x" << std::endl;
+    return 0;
+}
+
+// 渐进式加载对比
+// 同步与异步各加载一次 (冷启动删除缓存，热启动命中缓存)；异步加载模拟渲染循环，每 "帧" 发布一批网格并推进纹理上传
+// 首个网格：第一个网格可绘制的时间；完全加载：全部网格与纹理驻留的时间
+int benchModelLoad(const std::vector<std::string>& args)
+{
+    std::string path = args.empty() ? "resource/model/ark.glb" : args[0];
+    TextureStreamer streamer(ThreadPool::shared());
+
+    auto load = [&](bool async, bool cold, double& firstMs, double& allMs, size_t& frames) {
+        if (cold) std::remove(MeshCache::pathFor(path).c_str());
+        TextureRegistry registry(streamer);
+        ModelOptions options;
+        options.async = async;
+        auto start = std::chrono::steady_clock::now();
+        Model m(path.c_str(), registry, options);
+        firstMs = m.meshCount() > 0 ? elapsedMs(start) : 0.0;
+        frames = 0;
+        while (m.loading() || streamer.pendingCount() > 0) {
+            m.update();
+            streamer.update();
+            if (firstMs == 0.0 && m.meshCount() > 0) firstMs = elapsedMs(start);
+            ++frames;
+        }
+        allMs = elapsedMs(start);
+        if (m.meshCount() == 0) return false;
+        return true;
+    };
+
+    std::cout << "model-load " << path << std::endl;
+    const char* modes[2] = { "sync ", "async" };
+    for (int cold = 1; cold >= 0; --cold) {
+        for (int async = 0; async < 2; ++async) {
+            double firstMs = 0.0, allMs = 0.0;
+            size_t frames = 0;
+            if (!load(async != 0, cold != 0, firstMs, allMs, frames)) {
+                std::cerr << "model-load: failed to load " << path << std::endl;
+                return -1;
+            }
+            std::cout << "  " << (cold ? "cold " : "warm ") << modes[async] << ": first mesh " << firstMs
+                      << " ms, fully loaded " << allMs << " ms (" << frames << " frames)" << std::endl;
+        }
+    }
+    return 0;
+}
+
+// 着色器程序冷/热启动对比
+// 冷启动：删除程序二进制后从源码编译、链接并写入缓存；热启动：由 glProgramBinary 直接创建
+// 每轮以 glFinish 结束，计入驱动的延迟编译
+int benchShaderCache(const std::vector<std::string>& args)
+{
+    int runs = args.empty() ? 5 : std::max(1, std::atoi(args[0].c_str()));
+    const char* programs[][2] = {
+        { "resource/shader/vertex.vs", "resource/shader/pixel.vs" },
+        { "resource/shader/vertex_cube.vs", "resource/shader/pixel_cube.vs" },
+        { "resource/shader/depth.vs", "resource/shader/depth_frag.vs" },
+    };
+    ProgramBinaryCache cache("resource/shader");
+    if (!cache.supported()) {
+        std::cerr << "shader-cache: driver does not support program binaries" << std::endl;
+        return -1;
+    }
+
+    auto setup = [&](bool cold, size_t& fromBinary) {
+        fromBinary = 0;
+        if (cold) {
+            for (auto& p : programs) {
+                std::string vert, frag;
+                if (Shader::readFile(p[0], vert) && Shader::readFile(p[1], frag)) cache.remove(vert, frag);
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (auto& p : programs) {
+            Shader s;
+            if (!s.compileFromFiles(p[0], p[1], &cache)) {
+                std::cerr << "shader-cache: " << p[0] << ": " << s.error() << std::endl;
+                return -1.0;
+            }
+            if (s.fromBinary()) ++fromBinary;
+        }
+        glFinish();
+        return elapsedMs(start);
+    };
+
+    std::cout << "shader-cache (" << sizeof(programs) / sizeof(programs[0]) << " programs)" << std::endl;
+    for (int cold = 1; cold >= 0; --cold) {
+        double total = 0.0, best = 0.0;
+        size_t fromBinary = 0;
+        for (int i = 0; i < runs; ++i) {
+            double ms = setup(cold != 0, fromBinary);
+            if (ms < 0.0) return -1;
+            total += ms;
+            if (i == 0 || ms < best) best = ms;
+        }
+        std::cout << "  " << (cold ? "cold" : "warm") << ": avg " << total / runs << " ms, best " << best << " ms ("
+                  << fromBinary << " from binary)" << std::endl;
+    }
+    std::cout << "  note: drivers with their own shader disk cache make cold runs after the first one faster" << std::endl;
+    return 0;
+}
+
+// 立方体逐个绘制与实例化绘制对比
+// 以阴影深度 Pass 的着色器渲染到离屏深度缓冲：逐个绘制为每个立方体绑定对象 UBO 槽位并调用一次 glDrawElements，
+// 实例化绘制为一次 glDrawElementsInstanced；另测每帧重建全部矩阵与只更新 1% 脏立方体的 CPU 开销与上传量
+int benchCubes(const std::vector<std::string>& args)
+{
+    std::vector<size_t> counts;
+    for (const auto& a : args) counts.push_back(size_t(std::max(1, std::atoi(a.c_str()))));
+    if (counts.empty()) counts = { 1000, 10000, 100000 };
+    const int frames = 20;
+
+    Shader perCube, instanced;
+    if (!perCube.compileFromFiles("resource/shader/depth.vs", "resource/shader/depth_frag.vs")
+        || !instanced.compileFromFiles("resource/shader/depth.vs", "resource/shader/depth_frag.vs", nullptr, "#define INSTANCED 1\n")) {
+        std::cerr << "cubes: " << perCube.error() << instanced.error() << std::endl;
+        return -1;
+    }
+
+    // 离屏深度目标
+    const GLsizei size = 512;
+    GLuint fbo = 0, depth = 0;
+    glGenFramebuffers(1, &fbo);
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size, size);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glViewport(0, 0, size, size);
+    glEnable(GL_DEPTH_TEST);
+
+    FrameUniformBuffer frameUniforms;
+    Cube cube(1.0f, 1.0f, 1.0f, glm::vec3(1.0f));
+    std::printf("cubes (%d frames, %dx%d depth target)\n", frames, size, size);
+    std::printf("  %8s %12s %12s %10s %14s %14s %12s\n", "cubes", "per-cube ms", "instanced ms", "speedup",
+                "rebuild all ms", "update 1%% ms", "1%% bytes");
+
+    for (size_t count : counts) {
+        // 立方体排布在光源前方的网格上
+        const int side = int(std::ceil(std::cbrt(double(count))));
+        std::vector<glm::mat4> models(count);
+        std::vector<glm::vec3> colors(count);
+        for (size_t i = 0; i < count; ++i) {
+            const int x = int(i) % side, y = int(i) / side % side, z = int(i) / (side * side);
+            glm::vec3 pos = glm::vec3(x - side * 0.5f, y - side * 0.5f, -2.0f - z) * 1.5f;
+            models[i] = glm::translate(glm::mat4(1.0f), pos) * glm::rotate(glm::mat4(1.0f), float(i), glm::vec3(0.3f, 1.0f, 0.2f));
+            colors[i] = glm::vec3(float(x) / side, float(y) / side, float(z) / side);
+        }
+        FrameUniforms frame;
+        frame.farPlane = float(side) * 3.0f + 10.0f;
+        frame.shadowMatrices[0] = glm::perspective(glm::radians(90.0f), 1.0f, 0.5f, frame.farPlane)
+                                * glm::lookAt(glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        frameUniforms.update(frame);
+
+        ObjectUniformBuffer objects(count);
+        objects.resize(count);
+        CubeInstanceBuffer instances(count);
+        instances.resize(count);
+        cube.attachInstances(instances);
+        for (size_t i = 0; i < count; ++i) {
+            objects.set(i, models[i], colors[i]);
+            instances.set(i, models[i], colors[i]);
+        }
+        objects.flush();
+        instances.flush();
+
+        auto timeFrames = [&](auto&& draw) {
+            glClear(GL_DEPTH_BUFFER_BIT);
+            draw();
+            glFinish();
+            auto start = std::chrono::steady_clock::now();
+            for (int f = 0; f < frames; ++f) {
+                glClear(GL_DEPTH_BUFFER_BIT);
+                draw();
+            }
+            glFinish();
+            return elapsedMs(start) / frames;
+        };
+        perCube.use();
+        perCube.set(UniformName("shadowFace"), 0);
+        const double perCubeMs = timeFrames([&]() {
+            perCube.use();
+            for (size_t i = 0; i < count; ++i) {
+                objects.bind(i);
+                cube.Draw(perCube);
+            }
+        });
+        instanced.use();
+        instanced.set(UniformName("shadowFace"), 0);
+        const double instancedMs = timeFrames([&]() {
+            instanced.use();
+            cube.DrawInstanced(instanced, uint32_t(count));
+        });
+
+        // 每帧重建全部立方体的矩阵 (原先的做法) 与只更新 1% 的立方体
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; ++f) {
+            for (size_t i = 0; i < count; ++i) {
+                glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::vec3(models[i][3]) + glm::vec3(0.0f, 0.001f * (f + 1), 0.0f))
+                            * glm::rotate(glm::mat4(1.0f), float(i), glm::vec3(0.3f, 1.0f, 0.2f));
+                instances.set(i, m, colors[i]);
+            }
+            instances.flush();
+        }
+        glFinish();
+        const double rebuildMs = elapsedMs(start) / frames;
+        const size_t step = 100;
+        size_t bytes = 0;
+        start = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; ++f) {
+            for (size_t i = size_t(f) % step; i < count; i += step) {
+                glm::mat4 m = models[i];
+                m[3].y += 0.01f * (f + 1);
+                instances.set(i, m, colors[i]);
+            }
+            bytes = instances.flush();
+        }
+        glFinish();
+        const double dirtyMs = elapsedMs(start) / frames;
+
+        std::printf("  %8zu %12.3f %12.3f %9.1fx %14.3f %14.3f %12zu\n", count, perCubeMs, instancedMs,
+                    instancedMs > 0.0 ? perCubeMs / instancedMs : 0.0, rebuildMs, dirtyMs, bytes);
+    }
+
+    GLState::shared().invalidate();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteRenderbuffers(1, &depth);
+    glDeleteFramebuffers(1, &fbo);
+    return 0;
+}
+
+std::string base64Encode(const std::vector<unsigned char>& data)
+{
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((data.size() + 2) / 3 * 4);
+    for (size_t i = 0; i < data.size(); i += 3) {
+        uint32_t n = uint32_t(data[i]) << 16;
+        if (i + 1 < data.size()) n |= uint32_t(data[i + 1]) << 8;
+        if (i + 2 < data.size()) n |= uint32_t(data[i + 2]);
+        out += table[(n >> 18) & 63];
+        out += table[(n >> 12) & 63];
+        out += i + 1 < data.size() ? table[(n >> 6) & 63] : '=';
+        out += i + 2 < data.size() ? table[n & 63] : '=';
+    }
+    return out;
+}
+
+template <typename T>
+void appendBytes(std::vector<unsigned char>& buf, const T* data, size_t count)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    buf.insert(buf.end(), p, p + sizeof(T) * count);
+}
+
+// 生成 24 位无压缩 BMP (宽度为 4 的倍数，无需行填充)
+std::vector<unsigned char> makeBmp(int size, int seed)
+{
+    std::vector<unsigned char> bmp(54 + size_t(size) * size * 3);
+    auto put32 = [&](size_t at, uint32_t v) { std::memcpy(&bmp[at], &v, 4); };
+    auto put16 = [&](size_t at, uint16_t v) { std::memcpy(&bmp[at], &v, 2); };
+    bmp[0] = 'B'; bmp[1] = 'M';
+    put32(2, uint32_t(bmp.size()));
+    put32(10, 54);
+    put32(14, 40);
+    put32(18, uint32_t(size));
+    put32(22, uint32_t(size));
+    put16(26, 1);
+    put16(28, 24);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            unsigned char* px = &bmp[54 + (size_t(y) * size + x) * 3];
+            px[0] = static_cast<unsigned char>(x * 4 + seed);
+            px[1] = static_cast<unsigned char>(y * 4);
+            px[2] = static_cast<unsigned char>((x ^ y) + seed);
+        }
+    }
+    return bmp;
+}
+
+// 生成多网格合成 glTF
+// 所有网格共享一份 grid x grid 的网格几何，每个网格拥有独立材质与内嵌纹理
+std::string makeSyntheticGltf(int meshCount, int grid, int texSize)
+{
+    std::vector<float> positions, normals, uvs;
+    std::vector<uint32_t> indices;
+    for (int y = 0; y <= grid; ++y) {
+        for (int x = 0; x <= grid; ++x) {
+            float u = float(x) / grid, v = float(y) / grid;
+            positions.insert(positions.end(), { u, 0.0f, v });
+            normals.insert(normals.end(), { 0.0f, 1.0f, 0.0f });
+            uvs.insert(uvs.end(), { u, v });
+        }
+    }
+    for (int y = 0; y < grid; ++y) {
+        for (int x = 0; x < grid; ++x) {
+            uint32_t i0 = uint32_t(y * (grid + 1) + x), i1 = i0 + 1, i2 = i0 + uint32_t(grid + 1), i3 = i2 + 1;
+            indices.insert(indices.end(), { i0, i2, i1, i1, i2, i3 });
+        }
+    }
+    const size_t vertexCount = positions.size() / 3;
+
+    std::vector<unsigned char> buffer;
+    std::vector<std::pair<size_t, size_t>> views; // (offset, length)
+    auto addView = [&](const std::vector<unsigned char>& bytes) {
+        while (buffer.size() % 4) buffer.push_back(0);
+        views.emplace_back(buffer.size(), bytes.size());
+        buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+    };
+    std::vector<unsigned char> tmp;
+    tmp.clear(); appendBytes(tmp, positions.data(), positions.size()); addView(tmp);
+    tmp.clear(); appendBytes(tmp, normals.data(), normals.size()); addView(tmp);
+    tmp.clear(); appendBytes(tmp, uvs.data(), uvs.size()); addView(tmp);
+    tmp.clear(); appendBytes(tmp, indices.data(), indices.size()); addView(tmp);
+    for (int i = 0; i < meshCount; ++i) addView(makeBmp(texSize, i));
+
+    std::ostringstream js;
+    js << "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[";
+    for (int i = 0; i < meshCount; ++i) js << (i ? "," : "") << i;
+    js << "]}],\"nodes\":[";
+    for (int i = 0; i < meshCount; ++i) js << (i ? "," : "") << "{\"mesh\":" << i << "}";
+    js << "],\"meshes\":[";
+    for (int i = 0; i < meshCount; ++i) {
+        js << (i ? "," : "") << "{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},"
+           << "\"indices\":3,\"material\":" << i << "}]}";
+    }
+    js << "],\"materials\":[";
+    for (int i = 0; i < meshCount; ++i) {
+        js << (i ? "," : "") << "{\"pbrMetallicRoughness\":{\"baseColorTexture\":{\"index\":" << i << "}}}";
+    }
+    js << "],\"textures\":[";
+    for (int i = 0; i < meshCount; ++i) js << (i ? "," : "") << "{\"source\":" << i << "}";
+    js << "],\"images\":[";
+    for (int i = 0; i < meshCount; ++i) js << (i ? "," : "") << "{\"bufferView\":" << 4 + i << ",\"mimeType\":\"image/bmp\"}";
+    js << "],\"buffers\":[{\"byteLength\":" << buffer.size()
+       << ",\"uri\":\"data:application/octet-stream;base64," << base64Encode(buffer) << "\"}],\"bufferViews\":[";
+    for (size_t i = 0; i < views.size(); ++i) {
+        js << (i ? "," : "") << "{\"buffer\":0,\"byteOffset\":" << views[i].first << ",\"byteLength\":" << views[i].second << "}";
+    }
+    js << "],\"accessors\":["
+       << "{\"bufferView\":0,\"componentType\":5126,\"count\":" << vertexCount
+       << ",\"type\":\"VEC3\",\"min\":[0,0,0],\"max\":[1,0,1]},"
+       << "{\"bufferView\":1,\"componentType\":5126,\"count\":" << vertexCount << ",\"type\":\"VEC3\"},"
+       << "{\"bufferView\":2,\"componentType\":5126,\"count\":" << vertexCount << ",\"type\":\"VEC2\"},"
+       << "{\"bufferView\":3,\"componentType\":5125,\"count\":" << indices.size() << ",\"type\":\"SCALAR\"}]}";
+    return js.str();
+}
+
+// 网格转换并行扩展性
+// 导入一次合成 glTF，然后用 1, 2, 4 ... N 个工作线程分别运行 CPU 转换阶段
+// (纹理只提取压缩数据，解码由 TextureStreamer 在后台完成，不计入此处)
+int benchMeshConvert(const std::vector<std::string>& args)
+{
+    int meshCount = args.size() > 0 ? std::max(1, std::atoi(args[0].c_str())) : 512;
+    int grid = args.size() > 1 ? std::max(1, std::atoi(args[1].c_str())) : 48;
+    int texSize = args.size() > 2 ? std::max(4, std::atoi(args[2].c_str()) & ~3) : 128;
+    int runs = 3;
+
+    std::string gltf = makeSyntheticGltf(meshCount, grid, texSize);
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFileFromMemory(gltf.data(), gltf.size(), aiProcess_Triangulate | aiProcess_FlipUVs, "gltf");
+    if (!scene || !scene->mRootNode) {
+        std::cerr << "mesh-convert: synthetic glTF import failed: " << importer.GetErrorString() << std::endl;
+        return -1;
+    }
+
+    std::vector<unsigned> threadCounts;
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned t = 1; t < hw; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(hw);
+
+    std::cout << "mesh-convert: " << scene->mNumMeshes << " meshes, "
+              << (grid + 1) * (grid + 1) << " vertices and " << texSize << "x" << texSize << " texture each" << std::endl;
+    double baseline = 0.0;
+    for (unsigned threads : threadCounts) {
+        ThreadPool pool(threads);
+        double best = 0.0;
+        size_t images = 0;
+        for (int r = 0; r < runs; ++r) {
+            ModelData data;
+            auto start = std::chrono::steady_clock::now();
+            Model::convertScene(scene, std::string(), pool, data);
+            double ms = elapsedMs(start);
+            if (r == 0 || ms < best) best = ms;
+            images = data.images.size();
+        }
+        if (threads == 1) baseline = best;
+        std::cout << "  threads " << threads << ": " << best << " ms, speedup " << baseline / best
+                  << "x (" << images << " images extracted)" << std::endl;
+    }
+    return 0;
+}
+
+// 导入期网格优化效果
+// 逐网格报告焊接前后顶点数与模拟 FIFO(16) 缓存的 ACMR / ATVR；阴影 Pass 每帧对同一几何做 6 次顶点处理，收益按此放大
+// 模型路径为 "synthetic" 时使用合成 glTF (无需模型资源)
+int benchMeshOpt(const std::vector<std::string>& args)
+{
+    std::string path = args.empty() ? "resource/model/ark.glb" : args[0];
+    size_t maxRows = args.size() > 1 ? size_t(std::max(0, std::atoi(args[1].c_str()))) : 32;
+
+    Assimp::Importer importer;
+    const aiScene* scene = nullptr;
+    if (path == "synthetic") {
+        std::string gltf = makeSyntheticGltf(8, 64, 4);
+        scene = importer.ReadFileFromMemory(gltf.data(), gltf.size(), aiProcess_Triangulate | aiProcess_FlipUVs, "gltf");
+    } else {
+        scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
+    }
+    if (!scene || !scene->mRootNode) {
+        std::cerr << "mesh-opt: failed to import " << path << ": " << importer.GetErrorString() << std::endl;
+        return -1;
+    }
+
+    ModelData data;
+    auto start = std::chrono::steady_clock::now();
+    std::string::size_type slash = path.find_last_of("/\\");
+    Model::convertScene(scene, slash == std::string::npos ? std::string() : path.substr(0, slash), ThreadPool::shared(), data);
+    double ms = elapsedMs(start);
+
+    MeshOptimizeStats total;
+    std::printf("mesh-opt %s: %zu meshes, convert + optimize %.2f ms\n", path.c_str(), data.meshes.size(), ms);
+    std::printf("  %5s %9s %17s %15s %15s\n", "mesh", "tris", "vertices", "ACMR", "ATVR");
+    for (size_t i = 0; i < data.optimize.size(); ++i) {
+        const MeshOptimizeStats& o = data.optimize[i];
+        total += o;
+        if (i >= maxRows) continue;
+        std::printf("  %5zu %9zu %8zu->%-8zu %6.3f->%-6.3f %6.3f->%-6.3f\n", i, o.triangles, o.verticesBefore, o.verticesAfter,
+                    o.acmrBefore(), o.acmrAfter(), o.atvrBefore(), o.atvrAfter());
+    }
+    if (data.optimize.size() > maxRows) std::printf("  ... (%zu more)\n", data.optimize.size() - maxRows);
+    std::printf("  %5s %9zu %8zu->%-8zu %6.3f->%-6.3f %6.3f->%-6.3f\n", "total", total.triangles, total.verticesBefore,
+                total.verticesAfter, total.acmrBefore(), total.acmrAfter(), total.atvrBefore(), total.atvrAfter());
+    std::printf("  shadow pass vertex shader invocations per frame: %zu -> %zu\n", total.missesBefore * 6, total.missesAfter * 6);
+
+    // LOD 链：各级别三角形总数与最大误差 (相对各网格包围盒对角线)
+    size_t lodTris[kMaxLodLevels] = {};
+    float lodError[kMaxLodLevels] = {};
+    for (const MeshData& m : data.meshes) {
+        if (m.vertices.empty()) continue;
+        glm::vec3 minPos = m.vertices[0].Position, maxPos = minPos;
+        for (const Vertex& v : m.vertices) {
+            minPos = glm::min(minPos, v.Position);
+            maxPos = glm::max(maxPos, v.Position);
+        }
+        float extent = std::max(glm::length(maxPos - minPos), 1e-6f);
+        for (size_t l = 0; l < m.lods.size() && l < size_t(kMaxLodLevels); ++l) {
+            lodTris[l] += m.lods[l].indexCount / 3;
+            lodError[l] = std::max(lodError[l], m.lods[l].error / extent);
+        }
+    }
+    std::printf("  lod triangles:");
+    for (int l = 0; l < kMaxLodLevels; ++l) std::printf(" L%d %zu (err %.2f%%)", l, lodTris[l], lodError[l] * 100.0f);
+    std::printf("\n");
+    return 0;
+}
+
+// 压缩顶点格式的显存与精度
+// 对模型每个网格分别按全精度与 Packed 格式计算顶点/索引字节数，并报告量化后的最大位置误差与法线角度误差
+int benchVertexPack(const std::vector<std::string>& args)
+{
+    std::string path = args.empty() ? "resource/model/ark.glb" : args[0];
+
+    Assimp::Importer importer;
+    const aiScene* scene = nullptr;
+    if (path == "synthetic") {
+        std::string gltf = makeSyntheticGltf(8, 64, 4);
+        scene = importer.ReadFileFromMemory(gltf.data(), gltf.size(), aiProcess_Triangulate | aiProcess_FlipUVs, "gltf");
+    } else {
+        scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
+    }
+    if (!scene || !scene->mRootNode) {
+        std::cerr << "vertex-pack: failed to import " << path << ": " << importer.GetErrorString() << std::endl;
+        return -1;
+    }
+    ModelData data;
+    Model::convertScene(scene, std::string(), ThreadPool::shared(), data);
+
+    size_t floatBytes = 0, packedBytes = 0, shortMeshes = 0;
+    float maxPosError = 0.0f, maxPosErrorRel = 0.0f, maxNormalDeg = 0.0f;
+    for (const MeshData& m : data.meshes) {
+        std::vector<PackedVertex> packed;
+        PositionQuantization q = packVertices(m.vertices, packed);
+        floatBytes += m.vertices.size() * sizeof(Vertex) + m.indices.size() * sizeof(unsigned int);
+        bool shortIdx = useShortIndices(VertexFormat::Packed, m.vertices.size());
+        shortMeshes += shortIdx ? 1 : 0;
+        packedBytes += packed.size() * sizeof(PackedVertex) + m.indices.size() * (shortIdx ? 2 : 4);
+
+        const float extent = std::max(q.scale.x, std::max(q.scale.y, q.scale.z));
+        for (size_t i = 0; i < packed.size(); ++i) {
+            glm::vec3 p = glm::vec3(packed[i].Position[0], packed[i].Position[1], packed[i].Position[2]) / 65535.0f * q.scale + q.offset;
+            float err = glm::length(p - m.vertices[i].Position);
+            maxPosError = std::max(maxPosError, err);
+            maxPosErrorRel = std::max(maxPosErrorRel, err / extent);
+            float len = glm::length(m.vertices[i].Normal);
+            if (len > 0.0f) {
+                float c = glm::dot(octDecode(packed[i].Normal), m.vertices[i].Normal / len);
+                maxNormalDeg = std::max(maxNormalDeg, glm::degrees(std::acos(std::min(1.0f, c))));
+            }
+        }
+    }
+
+    std::printf("vertex-pack %s: %zu meshes (%zu with 16-bit indices)\n", path.c_str(), data.meshes.size(), shortMeshes);
+    std::printf("  vertex %zu -> %zu bytes/vertex\n", sizeof(Vertex), sizeof(PackedVertex));
+    std::printf("  geometry %.1f KiB -> %.1f KiB (%.1f%%)\n", floatBytes / 1024.0, packedBytes / 1024.0,
+                floatBytes ? 100.0 * packedBytes / floatBytes : 0.0);
+    std::printf("  per frame (6 shadow faces + main pass): %.1f MiB -> %.1f MiB fetched\n",
+                floatBytes * 7 / 1048576.0, packedBytes * 7 / 1048576.0);
+    std::printf("  max position error %g (%.2e of mesh extent), max normal error %.3f deg\n",
+                maxPosError, maxPosErrorRel, maxNormalDeg);
+    return 0;
+}
+
+// 网格簇划分与逐簇剔除
+// 报告簇数量与填充率，并模拟相机环绕模型 8 个方向 (主 Pass) 与模型斜上方点光源的 6 个立方体面 (阴影 Pass)，
+// 统计视锥剔除、背面剔除后剩余的三角形比例与剔除耗时
+// 模型路径为 "synthetic" 时使用经纬球 (弯曲表面才有背面簇)
+int benchMeshlet(const std::vector<std::string>& args)
+{
+    std::string path = args.empty() ? "resource/model/ark.glb" : args[0];
+
+    ModelData data;
+    if (path == "synthetic") {
+        const int rings = 256, segments = 512;
+        MeshData m;
+        for (int r = 0; r <= rings; ++r) {
+            for (int c = 0; c <= segments; ++c) {
+                float theta = glm::pi<float>() * r / rings, phi = glm::two_pi<float>() * c / segments;
+                Vertex v{};
+                v.Position = glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+                v.Normal = v.Position;
+                v.TexCoords = glm::vec2(float(c) / segments, float(r) / rings);
+                m.vertices.push_back(v);
+            }
+        }
+        for (int r = 0; r < rings; ++r) {
+            for (int c = 0; c < segments; ++c) {
+                unsigned a = r * (segments + 1) + c, b = a + 1, d = a + segments + 1, e = d + 1;
+                m.indices.insert(m.indices.end(), { a, b, d, b, e, d });
+            }
+        }
+        mesh_optimize(m);
+        mesh_build_meshlets(m);
+        data.meshes.push_back(std::move(m));
+    } else {
+        Assimp::Importer importer;
+        const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
+        if (!scene || !scene->mRootNode) {
+            std::cerr << "meshlet: failed to import " << path << ": " << importer.GetErrorString() << std::endl;
+            return -1;
+        }
+        Model::convertScene(scene, std::string(), ThreadPool::shared(), data);
+    }
+
+    // 簇统计与模型包围盒
+    size_t clusters = 0, triangles = 0, vertices = 0;
+    glm::vec3 minPos(1e30f), maxPos(-1e30f);
+    for (const MeshData& m : data.meshes) {
+        clusters += m.meshlets.size();
+        for (const Meshlet& c : m.meshlets) {
+            triangles += c.triangleCount;
+            std::vector<unsigned int> unique(m.indices.begin() + c.indexOffset, m.indices.begin() + c.indexOffset + c.triangleCount * 3);
+            std::sort(unique.begin(), unique.end());
+            vertices += size_t(std::unique(unique.begin(), unique.end()) - unique.begin());
+        }
+        for (const Vertex& v : m.vertices) {
+            minPos = glm::min(minPos, v.Position);
+            maxPos = glm::max(maxPos, v.Position);
+        }
+    }
+    if (clusters == 0) {
+        std::cerr << "meshlet: no clusters in " << path << std::endl;
+        return -1;
+    }
+    const glm::vec3 center = (minPos + maxPos) * 0.5f;
+    const float radius = glm::length(maxPos - minPos) * 0.5f;
+    std::printf("meshlet %s: %zu meshes, %zu clusters, %.1f vertices / %.1f triangles per cluster\n", path.c_str(),
+                data.meshes.size(), clusters, double(vertices) / clusters, double(triangles) / clusters);
+
+    // 模拟视图：主 Pass 相机环绕，阴影 Pass 点光源位于包围球外的斜上方
+    std::vector<glm::mat4> mainViews, shadowViews;
+    std::vector<glm::vec3> mainEyes;
+    glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, radius * 0.01f, radius * 10.0f);
+    for (int i = 0; i < 8; ++i) {
+        float a = glm::two_pi<float>() * i / 8;
+        glm::vec3 eye = center + glm::vec3(std::cos(a), 0.3f, std::sin(a)) * radius * 2.0f;
+        mainViews.push_back(proj * glm::lookAt(eye, center, glm::vec3(0.0f, 1.0f, 0.0f)));
+        mainEyes.push_back(eye);
+    }
+    glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), 1.0f, radius * 0.01f, radius * 10.0f);
+    const glm::vec3 dirs[6] = { {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1} };
+    const glm::vec3 ups[6] = { {0, -1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}, {0, -1, 0}, {0, -1, 0} };
+    const glm::vec3 light = center + glm::vec3(0.6f, 1.2f, 0.4f) * radius;
+    for (int f = 0; f < 6; ++f) shadowViews.push_back(shadowProj * glm::lookAt(light, light + dirs[f], ups[f]));
+
+    std::vector<uint32_t> stream;
+    auto run = [&](const char* name, const std::vector<glm::mat4>& views, bool backface, auto eyeOf) {
+        ClusterCullStats total;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t v = 0; v < views.size(); ++v) {
+            Frustum frustum = Frustum::fromMatrix(views[v]);
+            stream.clear();
+            for (const MeshData& m : data.meshes) {
+                size_t full = m.lods.empty() ? m.indices.size() / 3 : m.lods[0].indexCount / 3;
+                total.fullTriangles += full;
+                cluster_cull_mesh(m.meshlets, m.indices.data(), frustum, eyeOf(v), backface, stream, total);
+            }
+        }
+        double ms = elapsedMs(start) / views.size();
+        std::printf("  %-16s %5.1f%% triangles kept (frustum %zu, backface %zu of %zu clusters), %.3f ms per view\n", name,
+                    total.fullTriangles ? 100.0 * total.triangles / total.fullTriangles : 0.0,
+                    total.frustumCulled, total.backfaceCulled, total.clusters, ms);
+    };
+    run("main frustum", mainViews, false, [&](size_t v) { return mainEyes[v]; });
+    run("main +backface", mainViews, true, [&](size_t v) { return mainEyes[v]; });
+    run("shadow frustum", shadowViews, false, [&](size_t) { return light; });
+    run("shadow +backface", shadowViews, true, [&](size_t) { return light; });
+    return 0;
+}
+
+// 包围盒视锥剔除
+// 随机包围盒均匀分布在边长 200 的立方体内，相机位于中心依次朝 8 个方向观察
+// 对比逐个包围盒的标量实现、SoA + SSE 与 SSE + 线程池分块，并校验三者结果一致；同时测量整体变换的耗时
+int benchFrustum(const std::vector<std::string>& args)
+{
+    std::vector<size_t> counts;
+    for (const auto& a : args) counts.push_back(size_t(std::max(1, std::atoi(a.c_str()))));
+    if (counts.empty()) counts = { 1000, 10000, 100000, 1000000 };
+
+    std::vector<Frustum> frusta;
+    const glm::mat4 proj = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+    for (int i = 0; i < 8; ++i) {
+        float a = glm::two_pi<float>() * i / 8;
+        frusta.push_back(Frustum::fromMatrix(proj * glm::lookAt(glm::vec3(0.0f), glm::vec3(std::cos(a), 0.2f, std::sin(a)),
+                                                                glm::vec3(0.0f, 1.0f, 0.0f))));
+    }
+
+    std::printf("frustum (%zu views, %u worker threads)\n", frusta.size(), ThreadPool::shared().threadCount());
+    std::printf("  %8s %9s %12s %12s %12s %9s %14s\n", "boxes", "visible", "scalar ns", "sse ns", "threads ns",
+                "speedup", "transform ns");
+    uint32_t seed = 12345;
+    auto random01 = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return float(seed >> 8) / float(1u << 24);
+    };
+    for (size_t count : counts) {
+        AabbSoA local, world;
+        local.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            glm::vec3 c(random01(), random01(), random01());
+            glm::vec3 e(random01(), random01(), random01());
+            local.set(i, (c - 0.5f) * 200.0f, e * 1.5f + 0.1f);
+        }
+
+        // 每种实现至少处理约 2000 万个包围盒
+        const size_t reps = std::max<size_t>(1, 20000000 / (count * frusta.size()));
+        const double boxes = double(count) * frusta.size() * reps;
+        std::vector<uint8_t> scalarVis, sseVis, threadVis;
+        size_t visible = 0;
+        auto time = [&](auto fn) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t r = 0; r < reps; ++r)
+                for (const Frustum& f : frusta) fn(f);
+            return elapsedMs(start) * 1e6 / boxes;
+        };
+        const double scalarNs = time([&](const Frustum& f) { visible += frustum_cull_aabbs_scalar(f, local, scalarVis); });
+        const double sseNs = time([&](const Frustum& f) { frustum_cull_aabbs(f, local, sseVis); });
+        const double threadNs = time([&](const Frustum& f) { frustum_cull_aabbs(f, local, threadVis, &ThreadPool::shared()); });
+        const glm::mat4 model = glm::rotate(glm::mat4(1.0f), 0.3f, glm::vec3(0.0f, 1.0f, 0.0f));
+        auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < reps * frusta.size(); ++r) aabb_transform_all(model, local, world);
+        const double transformNs = elapsedMs(start) * 1e6 / boxes;
+
+        // 校验：最后一个视图的结果逐项一致
+        for (size_t i = 0; i < count; ++i) {
+            if (scalarVis[i] != sseVis[i] || scalarVis[i] != threadVis[i]) {
+                std::cerr << "frustum: SIMD result differs from scalar at box " << i << std::endl;
+                return -1;
+            }
+        }
+        std::printf("  %8zu %8.1f%% %12.2f %12.2f %12.2f %8.1fx %14.2f\n", count, 100.0 * visible / boxes,
+                    scalarNs, sseNs, threadNs, threadNs > 0.0 ? scalarNs / threadNs : 0.0, transformNs);
+    }
+    return 0;
+}
+
+// 层次包围盒查询
+// 随机包围盒 (边长 0.2 - 2) 均匀分布在立方体空间内 (边长随数量增长，密度不变)，对比 BVH 与逐个遍历：
+// 视锥 (中心朝 8 个方向，逐个遍历使用 SoA + SSE)、球 (64 个随机球心，半径为空间边长的 1/10)、射线 (256 条随机线段)
+// 校验两者结果一致；同时测量 SAH 建树与移动 1% 对象后重新拟合的耗时
+int benchBvh(const std::vector<std::string>& args)
+{
+    std::vector<size_t> counts;
+    for (const auto& a : args) counts.push_back(size_t(std::max(1, std::atoi(a.c_str()))));
+    if (counts.empty()) counts = { 10000, 100000, 1000000 };
+
+    uint32_t seed = 4321;
+    auto random01 = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return float(seed >> 8) / float(1u << 24);
+    };
+    auto randomVec = [&]() { return glm::vec3(random01(), random01(), random01()); };
+    auto sameSet = [](std::vector<uint32_t>& a, std::vector<uint32_t>& b) {
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        return a == b;
+    };
+
+    std::printf("bvh (8 frusta, 64 spheres, 256 rays per size; times are ms per query, brute force / bvh)\n");
+    std::printf("  %8s %9s %10s %20s %20s %20s\n", "objects", "build ms", "refit ms", "frustum", "sphere", "ray");
+    for (size_t count : counts) {
+        const float side = 4.0f * std::cbrt(float(count));
+        std::vector<glm::vec3> lo(count), hi(count);
+        for (size_t i = 0; i < count; ++i) {
+            const glm::vec3 c = (randomVec() - 0.5f) * side;
+            const glm::vec3 e = randomVec() * 0.9f + 0.1f;
+            lo[i] = c - e;
+            hi[i] = c + e;
+        }
+        AabbSoA soa;
+        soa.resize(count);
+        for (size_t i = 0; i < count; ++i) soa.set(i, (lo[i] + hi[i]) * 0.5f, (hi[i] - lo[i]) * 0.5f);
+
+        Bvh bvh;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i) bvh.set(uint32_t(i), lo[i], hi[i]);
+        bvh.maintain(); // 新对象超过 1/4，直接按 SAH 建树
+        const double buildMs = elapsedMs(start);
+
+        // 移动 1% 的对象后重新拟合 (不触发重建)
+        const size_t moved = std::max<size_t>(1, count / 100);
+        start = std::chrono::steady_clock::now();
+        for (size_t k = 0; k < moved; ++k) {
+            const size_t i = (k * 7919) % count;
+            const glm::vec3 offset = (randomVec() - 0.5f) * 2.0f;
+            lo[i] += offset;
+            hi[i] += offset;
+            soa.set(i, (lo[i] + hi[i]) * 0.5f, (hi[i] - lo[i]) * 0.5f);
+            bvh.set(uint32_t(i), lo[i], hi[i]);
+        }
+        bvh.maintain();
+        const double refitMs = elapsedMs(start);
+
+        std::vector<uint32_t> bruteHits, bvhHits;
+        std::vector<uint8_t> visible;
+        bool match = true;
+
+        // 视锥
+        const glm::mat4 proj = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, side);
+        double frustumBrute = 0.0, frustumBvh = 0.0;
+        for (int v = 0; v < 8; ++v) {
+            const float a = glm::two_pi<float>() * v / 8;
+            const Frustum f = Frustum::fromMatrix(proj * glm::lookAt(glm::vec3(0.0f), glm::vec3(std::cos(a), 0.2f, std::sin(a)),
+                                                                     glm::vec3(0.0f, 1.0f, 0.0f)));
+            start = std::chrono::steady_clock::now();
+            frustum_cull_aabbs(f, soa, visible);
+            bruteHits.clear();
+            for (size_t i = 0; i < count; ++i) {
+                if (visible[i]) bruteHits.push_back(uint32_t(i));
+            }
+            frustumBrute += elapsedMs(start);
+            start = std::chrono::steady_clock::now();
+            bvhHits.clear();
+            bvh.queryFrustum(f, bvhHits);
+            frustumBvh += elapsedMs(start);
+            match = match && sameSet(bruteHits, bvhHits);
+        }
+
+        // 球 (光源范围)
+        double sphereBrute = 0.0, sphereBvh = 0.0;
+        for (int s = 0; s < 64; ++s) {
+            const glm::vec3 c = (randomVec() - 0.5f) * side;
+            const float r = side * 0.1f;
+            start = std::chrono::steady_clock::now();
+            bruteHits.clear();
+            for (size_t i = 0; i < count; ++i) {
+                if (aabb_sphere_overlap(lo[i], hi[i], c, r)) bruteHits.push_back(uint32_t(i));
+            }
+            sphereBrute += elapsedMs(start);
+            start = std::chrono::steady_clock::now();
+            bvhHits.clear();
+            bvh.querySphere(c, r, bvhHits);
+            sphereBvh += elapsedMs(start);
+            match = match && sameSet(bruteHits, bvhHits);
+        }
+
+        // 射线 (拾取)
+        double rayBrute = 0.0, rayBvh = 0.0;
+        for (int q = 0; q < 256; ++q) {
+            const glm::vec3 o = (randomVec() - 0.5f) * side;
+            const glm::vec3 d = glm::normalize(randomVec() - 0.5f + 1e-4f) * side * 0.5f;
+            const glm::vec3 invD = 1.0f / d;
+            start = std::chrono::steady_clock::now();
+            bruteHits.clear();
+            for (size_t i = 0; i < count; ++i) {
+                if (aabb_ray_overlap(lo[i], hi[i], o, invD, 1.0f)) bruteHits.push_back(uint32_t(i));
+            }
+            rayBrute += elapsedMs(start);
+            start = std::chrono::steady_clock::now();
+            bvhHits.clear();
+            bvh.queryRay(o, d, 1.0f, bvhHits);
+            rayBvh += elapsedMs(start);
+            match = match && sameSet(bruteHits, bvhHits);
+        }
+
+        if (!match) {
+            std::cerr << "bvh: query results differ from brute force at " << count << " objects" << std::endl;
+            return -1;
+        }
+        const BvhStats stats = bvh.stats();
+        char cols[3][32];
+        std::snprintf(cols[0], sizeof(cols[0]), "%.3f / %.3f", frustumBrute / 8, frustumBvh / 8);
+        std::snprintf(cols[1], sizeof(cols[1]), "%.3f / %.4f", sphereBrute / 64, sphereBvh / 64);
+        std::snprintf(cols[2], sizeof(cols[2]), "%.3f / %.4f", rayBrute / 256, rayBvh / 256);
+        std::printf("  %8zu %9.1f %10.2f %20s %20s %20s\n", count, buildMs, refitMs, cols[0], cols[1], cols[2]);
+        std::printf("  %8s speedup %.1fx / %.1fx / %.1fx, SAH after refit %.2fx of build\n", "",
+                    frustumBrute / std::max(frustumBvh, 1e-9), sphereBrute / std::max(sphereBvh, 1e-9),
+                    rayBrute / std::max(rayBvh, 1e-9), stats.sahRatio);
+    }
+    return 0;
+}
+
+// 遮挡剔除：一排球体作为遮挡体，随机包围盒散布在其后方，另有一组位于遮挡体前方 (不应被遮挡) 用于校验
+// 比较单线程与线程池下的光栅化与测试耗时，报告被遮挡的比例
+int benchOcclusion(const std::vector<std::string>& args)
+{
+    std::vector<size_t> budgets;
+    for (const auto& a : args) budgets.push_back(size_t(std::max(8, std::atoi(a.c_str()))));
+    if (budgets.empty()) budgets = { 2000, 20000, 200000 };
+
+    const int kSpheres = 8;
+    const float kSphereRadius = 3.0f;
+    const size_t kBoxes = 100000, kFrontBoxes = 1000;
+    const int kRuns = 20;
+    uint32_t seed = 777;
+    auto random01 = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return float(seed >> 8) / float(1u << 24);
+    };
+
+    // 被遮挡体：前 kFrontBoxes 个位于遮挡体前方
+    AabbSoA boxes;
+    boxes.resize(kFrontBoxes + kBoxes);
+    for (size_t i = 0; i < kFrontBoxes + kBoxes; ++i) {
+        const bool front = i < kFrontBoxes;
+        const glm::vec3 c((random01() - 0.5f) * 60.0f, (random01() - 0.5f) * 16.0f,
+                          front ? -3.0f - random01() * 10.0f : -25.0f - random01() * 60.0f);
+        boxes.set(i, c, glm::vec3(0.2f + random01() * 0.8f));
+    }
+
+    const glm::mat4 viewProj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+    ThreadPool& pool = ThreadPool::shared();
+    std::printf("occlusion (%d spheres, %zu boxes behind + %zu in front, %d runs; %u pool threads)\n", kSpheres, kBoxes,
+                kFrontBoxes, kRuns, pool.threadCount());
+    std::printf("  %9s %10s %22s %22s %10s\n", "tris", "rasterized", "raster ms (1 / pool)", "test ms (1 / pool)", "occluded");
+    for (size_t budget : budgets) {
+        // 经纬球：segments 条经线、segments / 2 条纬线，约 segments² 个三角形
+        const int segments = std::max(4, int(std::sqrt(float(budget) / kSpheres)));
+        const int rings = std::max(2, segments / 2);
+        OccluderMesh sphere;
+        for (int r = 0; r <= rings; ++r) {
+            const float theta = glm::pi<float>() * r / rings;
+            for (int s = 0; s <= segments; ++s) {
+                const float phi = glm::two_pi<float>() * s / segments;
+                sphere.positions.push_back(kSphereRadius * glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta),
+                                                                     std::sin(theta) * std::sin(phi)));
+            }
+        }
+        for (int r = 0; r < rings; ++r) {
+            for (int s = 0; s < segments; ++s) {
+                const uint32_t a = uint32_t(r * (segments + 1) + s), b = a + uint32_t(segments + 1);
+                sphere.indices.insert(sphere.indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+            }
+        }
+
+        OcclusionBuffer buffer;
+        std::vector<uint8_t> visible;
+        double rasterMs[2] = {}, testMs[2] = {};
+        size_t occluded = 0;
+        for (int mode = 0; mode < 2; ++mode) {
+            ThreadPool* p = mode ? &pool : nullptr;
+            for (int run = 0; run < kRuns; ++run) {
+                auto start = std::chrono::steady_clock::now();
+                buffer.begin(viewProj);
+                for (int k = 0; k < kSpheres; ++k) {
+                    const glm::vec3 pos(-21.0f + 6.0f * k, 0.0f, -20.0f);
+                    buffer.addOccluder(sphere, glm::translate(glm::mat4(1.0f), pos));
+                }
+                buffer.rasterize(p);
+                rasterMs[mode] += elapsedMs(start);
+                visible.assign(boxes.size(), 1);
+                start = std::chrono::steady_clock::now();
+                occluded = buffer.cullBoxes(boxes, visible, p);
+                testMs[mode] += elapsedMs(start);
+            }
+            for (size_t i = 0; i < kFrontBoxes; ++i) {
+                if (!visible[i]) {
+                    std::cerr << "occlusion: box in front of the occluders was culled (" << budget << " tris)" << std::endl;
+                    return -1;
+                }
+            }
+        }
+        const OcclusionRasterStats& stats = buffer.stats();
+        char cols[2][32];
+        std::snprintf(cols[0], sizeof(cols[0]), "%.3f / %.3f", rasterMs[0] / kRuns, rasterMs[1] / kRuns);
+        std::snprintf(cols[1], sizeof(cols[1]), "%.3f / %.3f", testMs[0] / kRuns, testMs[1] / kRuns);
+        std::printf("  %9zu %10zu %22s %22s %9.1f%%\n", stats.triangles, stats.rasterized, cols[0], cols[1],
+                    100.0 * double(occluded) / double(kBoxes + kFrontBoxes));
+    }
+    return 0;
+}
+
+// 场景存储：对比逐帧遍历 CubeConfig 数组 (与缓存逐个比较、为变化的立方体转换欧拉角、遍历时跳过隐藏项)
+// 与 SoA 场景存储 (只更新变化的实体，连续遍历可见段) 每帧的 CPU 耗时；每帧修改 1% 的实体，10% 的实体隐藏
+// 同时校验两者的世界矩阵一致，以及删除后复用下标时旧句柄失效
+int benchScene(const std::vector<std::string>& args)
+{
+    std::vector<size_t> counts;
+    for (const auto& a : args) counts.push_back(size_t(std::max(1, std::atoi(a.c_str()))));
+    if (counts.empty()) counts = { 1000, 10000, 100000 };
+
+    uint32_t seed = 99;
+    auto random01 = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return float(seed >> 8) / float(1u << 24);
+    };
+    auto randomCube = [&]() {
+        CubeConfig c;
+        c.pos = glm::vec3(random01(), random01(), random01()) * 100.0f - 50.0f;
+        c.rot = glm::vec3(random01(), random01(), random01()) * 360.0f - 180.0f;
+        c.scale = 0.5f + random01();
+        c.length = 0.5f + random01();
+        c.width = 0.5f + random01();
+        c.height = 0.5f + random01();
+        c.color = glm::vec3(random01(), random01(), random01());
+        c.visible = random01() >= 0.1f;
+        return c;
+    };
+    auto cubeMatrix = [](const CubeConfig& c) {
+        const glm::mat4 rx = glm::rotate(glm::mat4(1.0f), glm::radians(c.rot.x), glm::vec3(1.0f, 0.0f, 0.0f));
+        const glm::mat4 ry = glm::rotate(glm::mat4(1.0f), glm::radians(c.rot.y), glm::vec3(0.0f, 1.0f, 0.0f));
+        const glm::mat4 rz = glm::rotate(glm::mat4(1.0f), glm::radians(c.rot.z), glm::vec3(0.0f, 0.0f, 1.0f));
+        return glm::translate(glm::mat4(1.0f), c.pos) * rz * ry * rx * glm::scale(glm::mat4(1.0f), glm::vec3(c.scale))
+             * glm::scale(glm::mat4(1.0f), glm::vec3(c.length, c.width, c.height));
+    };
+    auto sameCube = [](const CubeConfig& a, const CubeConfig& b) {
+        return a.length == b.length && a.width == b.width && a.height == b.height && a.pos == b.pos
+            && a.scale == b.scale && a.color == b.color && a.rot == b.rot && a.visible == b.visible;
+    };
+
+    // 句柄：删除后复用的下标不能被旧句柄访问
+    {
+        SceneStore store;
+        const EntityHandle a = store.create(CubeConfig());
+        store.destroy(a);
+        const EntityHandle b = store.create(CubeConfig());
+        CubeConfig tmp;
+        if (b.index != a.index || store.alive(a) || store.get(a, tmp) || !store.alive(b)) {
+            std::cerr << "scene: stale handle still valid after index reuse" << std::endl;
+            return -1;
+        }
+    }
+
+    const int kFrames = 50;
+    std::printf("scene (%d frames, 1%% of entities changed per frame, 10%% hidden; ms per frame)\n", kFrames);
+    std::printf("  %8s %12s %12s %10s\n", "entities", "AoS", "SoA store", "speedup");
+    for (size_t count : counts) {
+        std::vector<CubeConfig> cubes(count);
+        for (auto& c : cubes) c = randomCube();
+        std::vector<CubeConfig> cache = cubes;
+        std::vector<glm::mat4> matrices(count);
+        for (size_t i = 0; i < count; ++i) matrices[i] = cubeMatrix(cubes[i]);
+
+        SceneStore store;
+        std::vector<EntityHandle> handles(count);
+        for (size_t i = 0; i < count; ++i) handles[i] = store.create(cubes[i]);
+        store.update();
+        store.clearChanges();
+
+        // 每帧的变化预先生成，两种实现使用相同的序列
+        const size_t changed = std::max<size_t>(1, count / 100);
+        std::vector<std::pair<size_t, CubeConfig>> edits(changed * kFrames);
+        for (auto& e : edits) e = { size_t(random01() * float(count)) % count, randomCube() };
+
+        // 两种实现遍历可见立方体时累加包围球半径与平移，结果须一致 (同时防止遍历被优化掉)
+        double aosMs = 0.0, soaMs = 0.0, aosSum = 0.0, soaSum = 0.0;
+        for (int frame = 0; frame < kFrames; ++frame) {
+            const auto* frameEdits = &edits[size_t(frame) * changed];
+            // AoS：UI 写入数组，渲染时逐个与缓存比较，变化的重建矩阵；包围体遍历全部并跳过隐藏项
+            auto start = std::chrono::steady_clock::now();
+            for (size_t k = 0; k < changed; ++k) cubes[frameEdits[k].first] = frameEdits[k].second;
+            for (size_t i = 0; i < count; ++i) {
+                if (!sameCube(cache[i], cubes[i])) {
+                    matrices[i] = cubeMatrix(cubes[i]);
+                    cache[i] = cubes[i];
+                }
+                if (!cubes[i].visible) continue;
+                aosSum += 0.5f * cubes[i].scale * glm::length(glm::vec3(cubes[i].length, cubes[i].width, cubes[i].height))
+                      + matrices[i][3].x;
+            }
+            aosMs += elapsedMs(start);
+
+            // SoA：经句柄写入，只为变化的实体重算，连续遍历可见段
+            start = std::chrono::steady_clock::now();
+            for (size_t k = 0; k < changed; ++k) store.set(handles[frameEdits[k].first], frameEdits[k].second);
+            store.update();
+            store.clearChanges();
+            for (size_t d = 0; d < store.visibleCount(); ++d) soaSum += store.boundsRadius(d) + store.world(d)[3].x;
+            soaMs += elapsedMs(start);
+        }
+
+        float maxError = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t d = store.denseIndex(handles[i].index);
+            if ((d < store.visibleCount()) != cubes[i].visible) maxError = 1e30f;
+            for (int c = 0; c < 4; ++c) {
+                const glm::vec4 diff = glm::abs(store.world(d)[c] - matrices[i][c]);
+                maxError = std::max(maxError, std::max(std::max(diff.x, diff.y), std::max(diff.z, diff.w)));
+            }
+        }
+        if (maxError > 1e-4f || std::abs(aosSum - soaSum) > 1e-4 * std::abs(aosSum)) {
+            std::cerr << "scene: store differs from reference (max error " << maxError << ")" << std::endl;
+            return -1;
+        }
+        std::printf("  %8zu %12.4f %12.4f %9.1fx\n", count, aosMs / kFrames, soaMs / kFrames, aosMs / std::max(soaMs, 1e-9));
+    }
+    return 0;
+}
+
+const BenchEntry kBenches[] = {
+    { "model-cache", true, benchModelCache, "[model path] [warm runs]" },
+    { "model-load", true, benchModelLoad, "[model path]" },
+    { "shader-cache", true, benchShaderCache, "[runs]" },
+    { "cubes", true, benchCubes, "[cube counts...]" },
+    { "mesh-convert", false, benchMeshConvert, "[mesh count] [grid size] [texture size]" },
+    { "mesh-opt", false, benchMeshOpt, "[model path | synthetic] [max rows]" },
+    { "vertex-pack", false, benchVertexPack, "[model path | synthetic]" },
+    { "meshlet", false, benchMeshlet, "[model path | synthetic]" },
+    { "frustum", false, benchFrustum, "[box counts...]" },
+    { "bvh", false, benchBvh, "[object counts...]" },
+    { "occlusion", false, benchOcclusion, "[occluder triangle counts...]" },
+    { "scene", false, benchScene, "[entity counts...]" },
+};
+
+const BenchEntry* findBench(const std::string& name)
+{
+    for (const auto& b : kBenches) {
+        if (name == b.name) return &b;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+bool bench_needs_gl(const std::string& name)
+{
+    const BenchEntry* b = findBench(name);
+    return b ? b->needsGL : false;
+}
+
+int bench_run(const std::string& name, const std::vector<std::string>& args)
+{
+    const BenchEntry* b = findBench(name);
+    if (!b) {
+        std::cerr << "Unknown benchmark: " << name << "\nAvailable:" << std::endl;
+        for (const auto& e : kBenches) {
+            std::cerr << "  --bench " << e.name << " " << e.usage << std::endl;
+        }
+        return -1;
+    }
+    return b->run(args);
+}
@@ -1,17 +1,26 @@
 #include "cube.h"
+#include "gl_state.h"
 
 // 构造函数
 // 创建指定尺寸和颜色的立方体
-Cube::Cube(float length, float width, float height, glm::vec3 color) {
+Cube::Cube(float length, float width, float height, glm::vec3 color, VertexFormat format, GeometryPool* pool)
+    : VAO(0), VBO(0), EBO(0)
+    , pool_(pool)
+    , format_(format)
+    , indexType_(GL_UNSIGNED_INT) {
     build(length, width, height, color);
 }
 
 // 析构函数
 // 清理 OpenGL 缓冲区资源
 Cube::~Cube() {
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
+    if (pool_) pool_->remove(alloc_);
+    if (VAO) {
+        GLState::shared().forgetVertexArray(VAO);
+        glDeleteVertexArrays(1, &VAO);
+    }
+    if (VBO) glDeleteBuffers(1, &VBO);
+    if (EBO) glDeleteBuffers(1, &EBO);
 }
 
 // 构建立方体几何数据
@@ -40,39 +49,88 @@ void Cube::build(float length, float width, float height, glm::vec3 color) {
         3, 2, 6, 6, 7, 3,
         4, 5, 1, 1, 0, 4
     };
+    // 准备 GPU 端顶点与索引数据
+    std::vector<PackedVertexCube> packed;
+    const void* vertexData = vertices_.data();
+    size_t vertexBytes = vertices_.size() * sizeof(VertexCube);
+    if (format_ == VertexFormat::Packed) {
+        quant_ = packVertices(vertices_, packed);
+        vertexData = packed.data();
+        vertexBytes = packed.size() * sizeof(PackedVertexCube);
+    }
+    if (pool_ && pool_->format() != format_) pool_ = nullptr;
+    std::vector<unsigned short> shortIndices;
+    const void* indexData = indices_.data();
+    size_t indexBytes = indices_.size() * sizeof(unsigned int);
+    if (pool_ ? pool_->indexType() == GL_UNSIGNED_SHORT : useShortIndices(format_, vertices_.size())) {
+        shortIndices.assign(indices_.begin(), indices_.end());
+        indexType_ = GL_UNSIGNED_SHORT;
+        indexData = shortIndices.data();
+        indexBytes = shortIndices.size() * sizeof(unsigned short);
+    }
+
+    // 子分配到几何池
+    if (pool_) {
+        alloc_ = pool_->add(vertexData, static_cast<uint32_t>(vertices_.size()), indexData, static_cast<uint32_t>(indices_.size()));
+        if (alloc_.valid()) return;
+        pool_ = nullptr;
+    }
+
     // 生成VAO、VBO、EBO
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
     // 绑定VAO
-    glBindVertexArray(VAO);
+    GLState::shared().bindVertexArray(VAO);
     // 绑定VBO并上传顶点数据
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices_.size() * sizeof(VertexCube), vertices_.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertexData, GL_STATIC_DRAW);
     // 绑定EBO并上传索引数据
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices_.size() * sizeof(unsigned int), indices_.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, indexData, GL_STATIC_DRAW);
     
     // 设置顶点属性指针
-    // 属性 0: 位置 (vec3)
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VertexCube), (void*)0);
-    // 属性 1: 法线 (vec3)
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(VertexCube), (void*)offsetof(VertexCube, Normal));
-    // 属性 2: 颜色 (vec3)
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(VertexCube), (void*)offsetof(VertexCube, Color));
+    // 属性 0: 位置，属性 1: 法线，属性 2: 颜色
+    setupVertexAttributes(format_, true);
     
-    glBindVertexArray(0);
+    GLState::shared().bindVertexArray(0);
 }
 
 // 绘制立方体
 void Cube::Draw(Shader &shader) {
-    // 绑定VAO
-    glBindVertexArray(VAO);
-    // 绘制立方体
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices_.size()), GL_UNSIGNED_INT, nullptr);
-    // 解绑VAO
-    glBindVertexArray(0);
+    setDecode(shader);
+    // 绑定VAO并绘制立方体 (几何池中的立方体使用池的 VAO 与基准顶点偏移)
+    if (pool_) {
+        pool_->bind();
+        pool_->draw(alloc_);
+    } else {
+        GLState::shared().bindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices_.size()), indexType_, nullptr);
+    }
+    // VAO 保持绑定，连续绘制立方体时由状态缓存省略重复绑定
+}
+
+void Cube::attachInstances(const CubeInstanceBuffer &instances) {
+    GLState::shared().bindVertexArray(vertexArray());
+    instances.setupAttributes();
+}
+
+// 实例化绘制
+// 所有实例共用一次绘制调用，模型矩阵与颜色来自实例属性
+void Cube::DrawInstanced(Shader &shader, uint32_t instanceCount) {
+    if (instanceCount == 0) return;
+    setDecode(shader);
+    if (pool_) {
+        pool_->bind();
+        pool_->drawInstanced(alloc_, instanceCount);
+    } else {
+        GLState::shared().bindVertexArray(VAO);
+        glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(indices_.size()), indexType_, nullptr,
+                                static_cast<GLsizei>(instanceCount));
+    }
+}
+
+// 顶点解码参数 (全精度格式为恒等变换)
+void Cube::setDecode(Shader &shader) {
+    applyDecodeUniforms(shader, quant_, format_);
 }
@@ -0,0 +1,728 @@
+#include "mesh_optimizer.h"
+#include "hash.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+namespace {
+
+// 缓存重排使用的缓存容量 (略大于常见硬件，Forsyth 推荐值)
+const int kForsythCacheSize = 32;
+
+// 顶点字节视图的哈希与比较，用于焊接
+struct VertexBytesHash {
+    size_t operator()(const Vertex* v) const { return static_cast<size_t>(fnv1a64(v, sizeof(Vertex))); }
+};
+struct VertexBytesEqual {
+    bool operator()(const Vertex* a, const Vertex* b) const { return std::memcmp(a, b, sizeof(Vertex)) == 0; }
+};
+
+// Forsyth 顶点评分
+// cachePos: 顶点在模拟缓存中的位置 (-1 表示不在缓存中)；valence: 尚未输出的相邻三角形数
+float forsythScore(int cachePos, unsigned valence)
+{
+    if (valence == 0) return -1.0f;
+    float score = 0.0f;
+    if (cachePos >= 0) {
+        if (cachePos < 3) {
+            // 刚输出的三角形的顶点：固定分数，避免连续使用同一条边产生细长条带
+            score = 0.75f;
+        } else {
+            float t = 1.0f - float(cachePos - 3) / float(kForsythCacheSize - 3);
+            score = std::pow(t, 1.5f);
+        }
+    }
+    // 剩余相邻三角形越少分数越高，尽快清掉孤立三角形
+    score += 2.0f / std::sqrt(float(valence));
+    return score;
+}
+
+} // namespace
+
+size_t mesh_simulate_vertex_cache(const std::vector<unsigned int>& indices, size_t vertexCount, int cacheSize)
+{
+    // 记录每个顶点进入 FIFO 的时间戳，时间差小于容量即命中
+    std::vector<size_t> stamp(vertexCount, 0);
+    size_t time = size_t(cacheSize) + 1;
+    size_t misses = 0;
+    for (unsigned int idx : indices) {
+        if (idx >= vertexCount) continue;
+        if (time - stamp[idx] > size_t(cacheSize)) {
+            stamp[idx] = time++;
+            ++misses;
+        }
+    }
+    return misses;
+}
+
+size_t mesh_weld_vertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    std::unordered_map<const Vertex*, unsigned int, VertexBytesHash, VertexBytesEqual> unique;
+    unique.reserve(vertices.size());
+    std::vector<unsigned int> remap(vertices.size());
+    std::vector<Vertex> welded;
+    welded.reserve(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        auto ins = unique.emplace(&vertices[i], static_cast<unsigned int>(welded.size()));
+        if (ins.second) welded.push_back(vertices[i]);
+        remap[i] = ins.first->second;
+    }
+    for (unsigned int& idx : indices) idx = remap[idx];
+    vertices.swap(welded);
+    return vertices.size();
+}
+
+// 1. 建立顶点 -> 三角形邻接表
+// 2. 每次从 "最近进入缓存的顶点" 的相邻三角形中选出分数最高者输出；找不到时线性扫描剩余三角形
+// 3. 输出后更新模拟缓存，只重算缓存内顶点及其相邻三角形的分数
+void mesh_optimize_vertex_cache(std::vector<unsigned int>& indices, size_t vertexCount)
+{
+    const size_t triCount = indices.size() / 3;
+    if (triCount == 0 || vertexCount == 0) return;
+
+    std::vector<unsigned> valence(vertexCount, 0);
+    for (unsigned int idx : indices) ++valence[idx];
+    std::vector<unsigned> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] = offsets[v] + valence[v];
+    std::vector<unsigned> adjacency(indices.size());
+    {
+        std::vector<unsigned> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triCount; ++t) {
+            for (int k = 0; k < 3; ++k) adjacency[fill[indices[t * 3 + k]]++] = static_cast<unsigned>(t);
+        }
+    }
+
+    std::vector<int> cachePos(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) vertexScore[v] = forsythScore(-1, valence[v]);
+    std::vector<float> triScore(triCount);
+    std::vector<char> emitted(triCount, 0);
+    for (size_t t = 0; t < triCount; ++t) {
+        triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+    }
+
+    std::vector<unsigned int> out;
+    out.reserve(indices.size());
+    std::vector<unsigned> cache, nextCache;
+    cache.reserve(kForsythCacheSize + 3);
+    nextCache.reserve(kForsythCacheSize + 3);
+    size_t scan = 0;
+    long best = -1;
+
+    for (size_t emittedCount = 0; emittedCount < triCount; ++emittedCount) {
+        if (best < 0) {
+            // 缓存中没有可用三角形：取剩余三角形中分数最高者
+            float bestScore = -1.0f;
+            while (scan < triCount && emitted[scan]) ++scan;
+            for (size_t t = scan; t < triCount; ++t) {
+                if (!emitted[t] && triScore[t] > bestScore) {
+                    bestScore = triScore[t];
+                    best = static_cast<long>(t);
+                }
+            }
+        }
+
+        const size_t tri = static_cast<size_t>(best);
+        emitted[tri] = 1;
+        const unsigned tv[3] = { indices[tri * 3], indices[tri * 3 + 1], indices[tri * 3 + 2] };
+        out.insert(out.end(), tv, tv + 3);
+
+        // 从邻接表移除该三角形
+        for (unsigned v : tv) {
+            unsigned* begin = &adjacency[offsets[v]];
+            unsigned* end = begin + valence[v];
+            unsigned* it = std::find(begin, end, static_cast<unsigned>(tri));
+            if (it != end) {
+                std::swap(*it, *(end - 1));
+                --valence[v];
+            }
+        }
+
+        // 更新模拟缓存：新三角形的顶点置顶，其余依次后移
+        nextCache.assign(tv, tv + 3);
+        for (unsigned v : cache) {
+            if (v != tv[0] && v != tv[1] && v != tv[2]) nextCache.push_back(v);
+        }
+        for (size_t i = 0; i < nextCache.size(); ++i) {
+            unsigned v = nextCache[i];
+            cachePos[v] = i < size_t(kForsythCacheSize) ? static_cast<int>(i) : -1;
+            vertexScore[v] = forsythScore(cachePos[v], valence[v]);
+        }
+        if (nextCache.size() > size_t(kForsythCacheSize)) nextCache.resize(kForsythCacheSize);
+        cache.swap(nextCache);
+
+        // 重算缓存内顶点相邻三角形的分数并选出下一个
+        best = -1;
+        float bestScore = -1.0f;
+        for (unsigned v : cache) {
+            for (unsigned a = offsets[v]; a < offsets[v] + valence[v]; ++a) {
+                unsigned t = adjacency[a];
+                triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                if (triScore[t] > bestScore) {
+                    bestScore = triScore[t];
+                    best = static_cast<long>(t);
+                }
+            }
+        }
+    }
+
+    indices.swap(out);
+}
+
+// 1. 以缓存完全失效处 (三角形三个顶点全部未命中) 作为硬边界切分
+// 2. 硬簇内部累计 ACMR 不超过整体 ACMR * threshold 时再切出软边界
+// 3. 各簇按 "簇中心相对网格中心在簇法线方向上的距离" 从大到小排序，外侧朝外的表面优先绘制
+void mesh_optimize_overdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, float threshold)
+{
+    const size_t triCount = indices.size() / 3;
+    if (triCount < 2 || vertices.empty()) return;
+    const int cacheSize = 16;
+
+    // 硬边界
+    std::vector<size_t> hard;
+    {
+        std::vector<size_t> stamp(vertices.size(), 0);
+        size_t time = cacheSize + 1;
+        for (size_t t = 0; t < triCount; ++t) {
+            int misses = 0;
+            for (int k = 0; k < 3; ++k) {
+                unsigned v = indices[t * 3 + k];
+                if (time - stamp[v] > size_t(cacheSize)) {
+                    stamp[v] = time++;
+                    ++misses;
+                }
+            }
+            if (t == 0 || misses == 3) hard.push_back(t);
+        }
+    }
+    hard.push_back(triCount);
+
+    // 软边界
+    const float targetAcmr = float(mesh_simulate_vertex_cache(indices, vertices.size(), cacheSize)) / float(triCount) * threshold;
+    std::vector<size_t> clusters;
+    {
+        std::vector<size_t> stamp(vertices.size(), 0);
+        size_t time = cacheSize + 1;
+        for (size_t h = 0; h + 1 < hard.size(); ++h) {
+            size_t start = hard[h];
+            size_t misses = 0;
+            clusters.push_back(start);
+            time += cacheSize + 1; // 每个簇从空缓存开始
+            for (size_t t = start; t < hard[h + 1]; ++t) {
+                for (int k = 0; k < 3; ++k) {
+                    unsigned v = indices[t * 3 + k];
+                    if (time - stamp[v] > size_t(cacheSize)) {
+                        stamp[v] = time++;
+                        ++misses;
+                    }
+                }
+                if (t + 1 < hard[h + 1] && float(misses) / float(t - start + 1) <= targetAcmr) {
+                    clusters.push_back(t + 1);
+                    start = t + 1;
+                    misses = 0;
+                    time += cacheSize + 1;
+                }
+            }
+        }
+    }
+    clusters.push_back(triCount);
+    const size_t clusterCount = clusters.size() - 1;
+    if (clusterCount < 2) return;
+
+    // 网格中心
+    glm::vec3 meshCenter(0.0f);
+    for (const Vertex& v : vertices) meshCenter += v.Position;
+    meshCenter /= float(vertices.size());
+
+    // 簇排序键
+    std::vector<float> sortKey(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        glm::vec3 center(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+            const glm::vec3& p0 = vertices[indices[t * 3]].Position;
+            const glm::vec3& p1 = vertices[indices[t * 3 + 1]].Position;
+            const glm::vec3& p2 = vertices[indices[t * 3 + 2]].Position;
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            float a = glm::length(n);
+            center += (p0 + p1 + p2) * (a / 3.0f);
+            normal += n;
+            area += a;
+        }
+        if (area > 0.0f) center /= area;
+        float len = glm::length(normal);
+        sortKey[c] = len > 0.0f ? glm::dot(center - meshCenter, normal / len) : 0.0f;
+    }
+
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+    std::vector<unsigned int> out;
+    out.reserve(indices.size());
+    for (size_t c : order) {
+        out.insert(out.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+    }
+    indices.swap(out);
+}
+
+void mesh_optimize_vertex_fetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    const unsigned int kUnused = ~0u;
+    std::vector<unsigned int> remap(vertices.size(), kUnused);
+    std::vector<Vertex> out;
+    out.reserve(vertices.size());
+    for (unsigned int& idx : indices) {
+        if (remap[idx] == kUnused) {
+            remap[idx] = static_cast<unsigned int>(out.size());
+            out.push_back(vertices[idx]);
+        }
+        idx = remap[idx];
+    }
+    vertices.swap(out);
+}
+
+void mesh_optimize(MeshData& mesh, MeshOptimizeStats* stats)
+{
+    if (mesh.indices.size() < 3 || mesh.indices.size() % 3 != 0) return;
+
+    if (stats) {
+        stats->triangles = mesh.indices.size() / 3;
+        stats->verticesBefore = mesh.vertices.size();
+        stats->missesBefore = mesh_simulate_vertex_cache(mesh.indices, mesh.vertices.size());
+    }
+
+    mesh_weld_vertices(mesh.vertices, mesh.indices);
+    mesh_optimize_vertex_cache(mesh.indices, mesh.vertices.size());
+    mesh_optimize_overdraw(mesh.indices, mesh.vertices);
+    mesh_optimize_vertex_fetch(mesh.vertices, mesh.indices);
+
+    if (stats) {
+        stats->verticesAfter = mesh.vertices.size();
+        stats->missesAfter = mesh_simulate_vertex_cache(mesh.indices, mesh.vertices.size());
+    }
+}
+
+namespace {
+
+// 对称 4x4 二次型 (平面距离平方和)，按面积加权
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+    double a11 = 0, a12 = 0, a13 = 0;
+    double a22 = 0, a23 = 0;
+    double a33 = 0;
+    double weight = 0;
+
+    static Quadric plane(const glm::dvec3& n, double d, double w) {
+        Quadric q;
+        q.a00 = w * n.x * n.x; q.a01 = w * n.x * n.y; q.a02 = w * n.x * n.z; q.a03 = w * n.x * d;
+        q.a11 = w * n.y * n.y; q.a12 = w * n.y * n.z; q.a13 = w * n.y * d;
+        q.a22 = w * n.z * n.z; q.a23 = w * n.z * d;
+        q.a33 = w * d * d;
+        q.weight = w;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric& o) {
+        a00 += o.a00; a01 += o.a01; a02 += o.a02; a03 += o.a03;
+        a11 += o.a11; a12 += o.a12; a13 += o.a13;
+        a22 += o.a22; a23 += o.a23;
+        a33 += o.a33;
+        weight += o.weight;
+        return *this;
+    }
+
+    // 点到各平面的加权平均距离平方
+    double error(const glm::vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double e = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x
+                 + a11 * y * y + 2 * a12 * y * z + 2 * a13 * y
+                 + a22 * z * z + 2 * a23 * z
+                 + a33;
+        return weight > 0 ? std::max(e, 0.0) / weight : 0.0;
+    }
+};
+
+// 候选折叠 a -> b
+struct Collapse {
+    unsigned from;
+    unsigned to;
+    double cost;
+};
+
+} // namespace
+
+// 1. 标记不可移动的顶点：开放边界边的端点、与其他顶点位置相同的接缝顶点
+// 2. 按三角形平面累积每个顶点的二次型
+// 3. 多轮迭代：按代价排序所有候选折叠，每轮中邻域互不重叠的折叠同时执行，并拒绝导致三角形翻转的折叠
+std::vector<unsigned int> mesh_simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                                        size_t targetIndexCount, float targetError, float* outError)
+{
+    std::vector<unsigned int> result(indices);
+    double maxError = 0.0;
+    const size_t vertexCount = vertices.size();
+    if (outError) *outError = 0.0f;
+    if (result.size() <= targetIndexCount || vertexCount == 0) return result;
+
+    // 1. 锁定顶点
+    std::vector<char> locked(vertexCount, 0);
+    {
+        std::unordered_map<uint64_t, unsigned> positions;
+        std::vector<unsigned> first(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v) {
+            uint64_t key = fnv1a64(&vertices[v].Position, sizeof(glm::vec3));
+            auto ins = positions.emplace(key, static_cast<unsigned>(v));
+            if (!ins.second && std::memcmp(&vertices[ins.first->second].Position, &vertices[v].Position, sizeof(glm::vec3)) == 0) {
+                locked[v] = 1;
+                locked[ins.first->second] = 1;
+            }
+        }
+        std::unordered_map<uint64_t, int> edges; // 无向边使用次数
+        edges.reserve(result.size());
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; ++k) {
+                uint64_t a = result[i + k], b = result[i + (k + 1) % 3];
+                ++edges[a < b ? (a << 32 | b) : (b << 32 | a)];
+            }
+        }
+        for (const auto& e : edges) {
+            if (e.second != 1) continue;
+            locked[e.first >> 32] = 1;
+            locked[e.first & 0xffffffffu] = 1;
+        }
+    }
+
+    // 2. 顶点二次型
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        glm::dvec3 p0(vertices[result[i]].Position), p1(vertices[result[i + 1]].Position), p2(vertices[result[i + 2]].Position);
+        glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+        double area = glm::length(n);
+        if (area <= 0.0) continue;
+        n /= area;
+        Quadric q = Quadric::plane(n, -glm::dot(n, p0), area * 0.5);
+        quadrics[result[i]] += q;
+        quadrics[result[i + 1]] += q;
+        quadrics[result[i + 2]] += q;
+    }
+
+    const double maxCost = double(targetError) * double(targetError);
+    std::vector<unsigned> remap(vertexCount);
+    std::vector<char> dirty(vertexCount);
+    std::vector<unsigned> offsets(vertexCount + 1), adjacency;
+    std::vector<Collapse> candidates;
+
+    for (;;) {
+        const size_t triCount = result.size() / 3;
+        if (result.size() <= targetIndexCount) break;
+
+        // 顶点 -> 三角形邻接
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (unsigned idx : result) ++offsets[idx + 1];
+        for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+        adjacency.resize(result.size());
+        {
+            std::vector<unsigned> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t t = 0; t < triCount; ++t) {
+                for (int k = 0; k < 3; ++k) adjacency[fill[result[t * 3 + k]]++] = static_cast<unsigned>(t);
+            }
+        }
+
+        // 候选折叠
+        candidates.clear();
+        for (size_t t = 0; t < triCount; ++t) {
+            for (int k = 0; k < 3; ++k) {
+                unsigned a = result[t * 3 + k], b = result[t * 3 + (k + 1) % 3];
+                for (int dir = 0; dir < 2; ++dir, std::swap(a, b)) {
+                    if (locked[a]) continue;
+                    Quadric q = quadrics[a];
+                    q += quadrics[b];
+                    double cost = q.error(vertices[b].Position);
+                    if (cost <= maxCost) candidates.push_back(Collapse{ a, b, cost });
+                }
+            }
+        }
+        if (candidates.empty()) break;
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+        // 执行互不重叠的折叠
+        for (size_t v = 0; v < vertexCount; ++v) remap[v] = static_cast<unsigned>(v);
+        std::fill(dirty.begin(), dirty.end(), 0);
+        size_t remaining = triCount;
+        size_t collapsed = 0;
+        for (const Collapse& c : candidates) {
+            if (remaining * 3 <= targetIndexCount) break;
+            if (dirty[c.from] || dirty[c.to]) continue;
+
+            // 翻转检查：不含 to 的三角形在 from 移动到 to 后法线不能反向
+            bool flips = false;
+            size_t removed = 0;
+            const glm::vec3& target = vertices[c.to].Position;
+            for (unsigned a = offsets[c.from]; a < offsets[c.from + 1] && !flips; ++a) {
+                const unsigned* tri = &result[adjacency[a] * 3];
+                if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+                    ++removed;
+                    continue;
+                }
+                glm::vec3 p[3], q[3];
+                for (int k = 0; k < 3; ++k) {
+                    p[k] = vertices[tri[k]].Position;
+                    q[k] = tri[k] == c.from ? target : p[k];
+                }
+                glm::vec3 n0 = glm::cross(p[1] - p[0], p[2] - p[0]);
+                glm::vec3 n1 = glm::cross(q[1] - q[0], q[2] - q[0]);
+                flips = glm::dot(n0, n1) <= 0.0f;
+            }
+            if (flips) continue;
+
+            // 锁住折叠邻域，本轮不再修改
+            for (unsigned a = offsets[c.from]; a < offsets[c.from + 1]; ++a) {
+                const unsigned* tri = &result[adjacency[a] * 3];
+                dirty[tri[0]] = dirty[tri[1]] = dirty[tri[2]] = 1;
+            }
+            remap[c.from] = c.to;
+            quadrics[c.to] += quadrics[c.from];
+            maxError = std::max(maxError, c.cost);
+            remaining -= removed;
+            ++collapsed;
+        }
+        if (collapsed == 0) break;
+
+        // 应用折叠并删除退化三角形
+        size_t write = 0;
+        for (size_t t = 0; t < triCount; ++t) {
+            unsigned a = remap[result[t * 3]], b = remap[result[t * 3 + 1]], c = remap[result[t * 3 + 2]];
+            if (a == b || b == c || a == c) continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    if (outError) *outError = static_cast<float>(std::sqrt(maxError));
+    return result;
+}
+
+void mesh_generate_lods(MeshData& mesh, int maxLevels, float errorLimit)
+{
+    mesh.lods.clear();
+    if (mesh.indices.empty() || mesh.vertices.empty() || mesh.indices.size() % 3 != 0) return;
+    const size_t baseCount = mesh.indices.size();
+    mesh.lods.push_back(MeshLod{ 0, static_cast<uint32_t>(baseCount), 0.0f, 0 });
+
+    glm::vec3 minPos = mesh.vertices[0].Position, maxPos = minPos;
+    for (const Vertex& v : mesh.vertices) {
+        minPos = glm::min(minPos, v.Position);
+        maxPos = glm::max(maxPos, v.Position);
+    }
+    const float maxError = glm::length(maxPos - minPos) * errorLimit;
+
+    std::vector<unsigned int> previous(mesh.indices.begin(), mesh.indices.end());
+    float previousError = 0.0f;
+    for (int level = 1; level < maxLevels; ++level) {
+        // 三角形过少的网格不再细分级别
+        if (previous.size() < 3 * 32) break;
+        size_t target = (previous.size() / 2) / 3 * 3;
+        float error = 0.0f;
+        std::vector<unsigned int> lod = mesh_simplify(mesh.vertices, previous, target, maxError, &error);
+        // 减少不足 10% 时停止，避免保存几乎相同的级别
+        if (lod.empty() || lod.size() * 10 > previous.size() * 9) break;
+        mesh_optimize_vertex_cache(lod, mesh.vertices.size());
+
+        error = std::max(error, previousError); // 误差随级别单调不减
+        MeshLod l;
+        l.indexOffset = static_cast<uint32_t>(mesh.indices.size());
+        l.indexCount = static_cast<uint32_t>(lod.size());
+        l.error = error;
+        mesh.lods.push_back(l);
+        mesh.indices.insert(mesh.indices.end(), lod.begin(), lod.end());
+        previous.swap(lod);
+        previousError = error;
+    }
+}
+
+namespace {
+
+// 计算簇的包围球与法线锥
+// 包围球取包围盒中心与最远顶点距离；法线锥轴为各三角形单位法线的均值，
+// 最小夹角余弦过小 (锥角接近 90°) 时不参与背面剔除
+// indices: 簇索引所在的数组 (m.indexOffset 为其中的偏移)
+void computeMeshletBounds(const MeshData& mesh, Meshlet& m, const unsigned int* indices)
+{
+    const unsigned int* idx = indices + m.indexOffset;
+    const size_t count = size_t(m.triangleCount) * 3;
+    glm::vec3 minPos = mesh.vertices[idx[0]].Position, maxPos = minPos;
+    for (size_t i = 1; i < count; ++i) {
+        minPos = glm::min(minPos, mesh.vertices[idx[i]].Position);
+        maxPos = glm::max(maxPos, mesh.vertices[idx[i]].Position);
+    }
+    m.center = (minPos + maxPos) * 0.5f;
+    float r2 = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec3 d = mesh.vertices[idx[i]].Position - m.center;
+        r2 = std::max(r2, glm::dot(d, d));
+    }
+    m.radius = std::sqrt(r2);
+
+    std::vector<glm::vec3> normals;
+    normals.reserve(m.triangleCount);
+    glm::vec3 sum(0.0f);
+    for (size_t i = 0; i < count; i += 3) {
+        const glm::vec3& p0 = mesh.vertices[idx[i]].Position;
+        glm::vec3 n = glm::cross(mesh.vertices[idx[i + 1]].Position - p0, mesh.vertices[idx[i + 2]].Position - p0);
+        float len = glm::length(n);
+        if (len <= 0.0f) continue;
+        normals.push_back(n / len);
+        sum += normals.back();
+    }
+    m.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    m.coneCutoff = 1.0f;
+    float sumLen = glm::length(sum);
+    if (normals.empty() || sumLen <= 1e-6f) return;
+    glm::vec3 axis = sum / sumLen;
+    float minDot = 1.0f;
+    for (const glm::vec3& n : normals) minDot = std::min(minDot, glm::dot(n, axis));
+    m.coneAxis = axis;
+    if (minDot > 0.1f) m.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+} // namespace
+
+// 1. 以上一簇边缘上剩余相邻三角形最少的三角形为种子 (没有时取缓存重排顺序中第一个未输出的三角形)，
+//    优先填补角落，避免留下零碎的孤立三角形
+// 2. 每次从与簇顶点相邻的候选三角形中选出新增顶点最少者，其次选剩余相邻三角形最少者，再次选离簇中心最近者
+// 3. 没有能放下的候选时结束当前簇；簇内再做一次缓存重排，最后按簇顺序重写原始级别的索引
+void mesh_build_meshlets(MeshData& mesh, size_t maxVertices, size_t maxTriangles)
+{
+    mesh.meshlets.clear();
+    const size_t baseCount = (mesh.lods.empty() ? mesh.indices.size() : mesh.lods[0].indexCount) / 3 * 3;
+    const size_t triCount = baseCount / 3;
+    const size_t vertexCount = mesh.vertices.size();
+    if (triCount == 0 || vertexCount == 0) return;
+
+    // 顶点 -> 三角形邻接；live 为顶点尚未输出的相邻三角形数
+    std::vector<unsigned> offsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < baseCount; ++i) ++offsets[mesh.indices[i] + 1];
+    for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+    std::vector<unsigned> adjacency(baseCount);
+    std::vector<unsigned> live(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) live[v] = offsets[v + 1] - offsets[v];
+    {
+        std::vector<unsigned> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triCount; ++t) {
+            for (int k = 0; k < 3; ++k) adjacency[fill[mesh.indices[t * 3 + k]]++] = static_cast<unsigned>(t);
+        }
+    }
+    auto liveScore = [&](unsigned tri) {
+        return live[mesh.indices[tri * 3]] + live[mesh.indices[tri * 3 + 1]] + live[mesh.indices[tri * 3 + 2]];
+    };
+
+    std::vector<unsigned int> out;
+    out.reserve(baseCount);
+    std::vector<char> emitted(triCount, 0);
+    std::vector<uint32_t> stamp(vertexCount, 0); // 顶点所属簇的编号 (从 1 开始)
+    std::vector<unsigned> candidates;
+    std::vector<unsigned> local(vertexCount);    // 全局顶点 -> 簇内局部编号
+    std::vector<unsigned> globalOf;              // 簇内局部编号 -> 全局顶点
+    std::vector<unsigned int> localIndices;
+    uint32_t current = 0;
+    size_t scan = 0;
+
+    while (out.size() < baseCount) {
+        // 选择种子
+        long next = -1;
+        unsigned bestLive = ~0u;
+        for (unsigned tri : candidates) {
+            if (emitted[tri]) continue;
+            unsigned score = liveScore(tri);
+            if (score < bestLive) {
+                bestLive = score;
+                next = static_cast<long>(tri);
+            }
+        }
+        if (next < 0) {
+            while (emitted[scan]) ++scan;
+            next = static_cast<long>(scan);
+        }
+
+        ++current;
+        Meshlet m;
+        m.indexOffset = static_cast<uint32_t>(out.size());
+        size_t used = 0;
+        glm::vec3 sum(0.0f);
+        candidates.clear();
+
+        while (next >= 0) {
+            // 输出三角形并把新顶点的相邻三角形加入候选
+            const size_t t = static_cast<size_t>(next);
+            emitted[t] = 1;
+            ++m.triangleCount;
+            for (int k = 0; k < 3; ++k) {
+                unsigned v = mesh.indices[t * 3 + k];
+                out.push_back(v);
+                --live[v];
+                if (stamp[v] == current) continue;
+                stamp[v] = current;
+                ++used;
+                sum += mesh.vertices[v].Position;
+                for (unsigned a = offsets[v]; a < offsets[v + 1]; ++a) {
+                    if (!emitted[adjacency[a]]) candidates.push_back(adjacency[a]);
+                }
+            }
+            if (m.triangleCount >= maxTriangles) break;
+
+            // 选择下一个三角形
+            const glm::vec3 center = sum / float(used);
+            next = -1;
+            int bestNew = 4;
+            unsigned bestScore = 0;
+            float bestDist = 0.0f;
+            size_t write = 0;
+            for (size_t c = 0; c < candidates.size(); ++c) {
+                unsigned tri = candidates[c];
+                if (emitted[tri]) continue;
+                candidates[write++] = tri;
+                int added = 0;
+                glm::vec3 centroid(0.0f);
+                for (int k = 0; k < 3; ++k) {
+                    unsigned v = mesh.indices[tri * 3 + k];
+                    added += stamp[v] != current;
+                    centroid += mesh.vertices[v].Position;
+                }
+                if (used + added > maxVertices || added > bestNew) continue;
+                unsigned score = liveScore(tri);
+                glm::vec3 d = centroid / 3.0f - center;
+                float dist = glm::dot(d, d);
+                if (added < bestNew || score < bestScore || (score == bestScore && dist < bestDist)) {
+                    bestNew = added;
+                    bestScore = score;
+                    bestDist = dist;
+                    next = static_cast<long>(tri);
+                }
+            }
+            candidates.resize(write);
+        }
+
+        // 簇内缓存重排 (转换为局部编号，避免按整个网格的顶点数分配)
+        globalOf.clear();
+        localIndices.assign(out.begin() + m.indexOffset, out.end());
+        for (unsigned int& idx : localIndices) {
+            if (stamp[idx] == current) {
+                stamp[idx] = ~0u - current; // 标记已编号 (编号不会达到该值)
+                local[idx] = static_cast<unsigned>(globalOf.size());
+                globalOf.push_back(idx);
+            }
+            idx = local[idx];
+        }
+        mesh_optimize_vertex_cache(localIndices, globalOf.size());
+        for (size_t i = 0; i < localIndices.size(); ++i) out[m.indexOffset + i] = globalOf[localIndices[i]];
+        for (unsigned g : globalOf) stamp[g] = current;
+
+        computeMeshletBounds(mesh, m, out.data());
+        mesh.meshlets.push_back(m);
+    }
+    std::copy(out.begin(), out.end(), mesh.indices.begin());
+}
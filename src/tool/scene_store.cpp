@@ -0,0 +1,176 @@
+#include "scene_store.h"
+#include "frustum_cull.h"
+#include "ext/matrix_transform.hpp"
+#include <utility>
+
+// 创建实体
+// 优先复用已删除实体的下标；新实体先放在稠密数组末尾 (隐藏段)，可见时再交换进可见段
+EntityHandle SceneStore::create(const CubeConfig& cfg)
+{
+    uint32_t index;
+    if (!freeIndices_.empty()) {
+        index = freeIndices_.back();
+        freeIndices_.pop_back();
+    } else {
+        index = uint32_t(dense_.size());
+        dense_.push_back(kNull);
+        generation_.push_back(0);
+        changed_.push_back(0);
+    }
+    recordChange(index);
+
+    const size_t d = entity_.size();
+    position_.push_back(cfg.pos);
+    rotation_.push_back(cfg.rot);
+    scale_.push_back(cfg.scale);
+    size_.push_back(glm::vec3(cfg.length, cfg.width, cfg.height));
+    world_.push_back(glm::mat4(1.0f));
+    center_.push_back(cfg.pos);
+    extent_.push_back(glm::vec3(0.0f));
+    radius_.push_back(0.0f);
+    color_.push_back(cfg.color);
+    entity_.push_back(index);
+    dense_[index] = uint32_t(d);
+    setVisible(d, cfg.visible);
+    return { index, generation_[index] };
+}
+
+// 删除实体
+// 先移出可见段，再与最后一个稠密位置交换后弹出；下标的代数加一后放入空闲列表
+void SceneStore::destroy(EntityHandle h)
+{
+    if (!alive(h)) return;
+    recordChange(h.index);
+    setVisible(dense_[h.index], false);
+    swapSlots(dense_[h.index], entity_.size() - 1);
+    position_.pop_back();
+    rotation_.pop_back();
+    scale_.pop_back();
+    size_.pop_back();
+    world_.pop_back();
+    center_.pop_back();
+    extent_.pop_back();
+    radius_.pop_back();
+    color_.pop_back();
+    entity_.pop_back();
+    dense_[h.index] = kNull;
+    ++generation_[h.index];
+    freeIndices_.push_back(h.index);
+}
+
+// 最近的存活实体
+// 实体下标在实体存在期间不变，可作为 UI 中的稳定编号 (稠密下标随可见性变化与删除而交换)
+EntityHandle SceneStore::nearest(uint32_t index, bool forward) const
+{
+    const int64_t n = int64_t(dense_.size());
+    if (n == 0) return {};
+    const int64_t start = index < dense_.size() ? int64_t(index) : n - 1;
+    for (int pass = 0; pass < 2; ++pass, forward = !forward) {
+        for (int64_t i = start; i >= 0 && i < n; i += forward ? 1 : -1) {
+            if (dense_[size_t(i)] != kNull) return { uint32_t(i), generation_[size_t(i)] };
+        }
+    }
+    return {};
+}
+
+bool SceneStore::get(EntityHandle h, CubeConfig& out) const
+{
+    if (!alive(h)) return false;
+    const size_t d = dense_[h.index];
+    out.length = size_[d].x;
+    out.width = size_[d].y;
+    out.height = size_[d].z;
+    out.pos = position_[d];
+    out.scale = scale_[d];
+    out.color = color_[d];
+    out.rot = rotation_[d];
+    out.visible = d < visibleCount_;
+    return true;
+}
+
+void SceneStore::set(EntityHandle h, const CubeConfig& cfg)
+{
+    CubeConfig cur;
+    if (!get(h, cur)) return;
+    if (cur.length == cfg.length && cur.width == cfg.width && cur.height == cfg.height && cur.pos == cfg.pos
+        && cur.scale == cfg.scale && cur.color == cfg.color && cur.rot == cfg.rot && cur.visible == cfg.visible) return;
+    recordChange(h.index);
+    const size_t d = dense_[h.index];
+    position_[d] = cfg.pos;
+    rotation_[d] = cfg.rot;
+    scale_[d] = cfg.scale;
+    size_[d] = glm::vec3(cfg.length, cfg.width, cfg.height);
+    color_[d] = cfg.color;
+    setVisible(d, cfg.visible);
+}
+
+void SceneStore::update()
+{
+    for (const SceneChange& c : changes_) {
+        const uint32_t d = dense_[c.index];
+        if (d != kNull) computeWorld(d);
+    }
+}
+
+void SceneStore::clearChanges()
+{
+    for (const SceneChange& c : changes_) changed_[c.index] = 0;
+    changes_.clear();
+}
+
+void SceneStore::recordChange(uint32_t index)
+{
+    if (changed_[index]) return;
+    changed_[index] = 1;
+    const uint32_t d = dense_[index];
+    SceneChange c;
+    c.index = index;
+    c.wasVisible = d != kNull && d < visibleCount_;
+    c.oldCenter = c.wasVisible ? center_[d] : glm::vec3(0.0f);
+    c.oldRadius = c.wasVisible ? radius_[d] : 0.0f;
+    changes_.push_back(c);
+}
+
+void SceneStore::swapSlots(size_t a, size_t b)
+{
+    if (a == b) return;
+    std::swap(position_[a], position_[b]);
+    std::swap(rotation_[a], rotation_[b]);
+    std::swap(scale_[a], scale_[b]);
+    std::swap(size_[a], size_[b]);
+    std::swap(world_[a], world_[b]);
+    std::swap(center_[a], center_[b]);
+    std::swap(extent_[a], extent_[b]);
+    std::swap(radius_[a], radius_[b]);
+    std::swap(color_[a], color_[b]);
+    std::swap(entity_[a], entity_[b]);
+    dense_[entity_[a]] = uint32_t(a);
+    dense_[entity_[b]] = uint32_t(b);
+}
+
+// 可见段为 [0, visibleCount_)：移入时与段后第一个位置交换，移出时与段内最后一个位置交换
+void SceneStore::setVisible(size_t d, bool visible)
+{
+    if ((d < visibleCount_) == visible) return;
+    if (visible) {
+        swapSlots(d, visibleCount_);
+        ++visibleCount_;
+    } else {
+        --visibleCount_;
+        swapSlots(d, visibleCount_);
+    }
+}
+
+// 世界矩阵：单位立方体按长宽高、整体缩放、旋转 (X、Y、Z)、平移
+// 包围盒由矩阵解析求出，包围球以位置为中心、半对角线为半径
+void SceneStore::computeWorld(size_t d)
+{
+    glm::mat4 m = glm::translate(glm::mat4(1.0f), position_[d]);
+    m = glm::rotate(m, glm::radians(rotation_[d].z), glm::vec3(0.0f, 0.0f, 1.0f));
+    m = glm::rotate(m, glm::radians(rotation_[d].y), glm::vec3(0.0f, 1.0f, 0.0f));
+    m = glm::rotate(m, glm::radians(rotation_[d].x), glm::vec3(1.0f, 0.0f, 0.0f));
+    m = glm::scale(m, glm::vec3(scale_[d]) * size_[d]);
+    world_[d] = m;
+    aabb_transform(m, glm::vec3(0.0f), glm::vec3(0.5f), center_[d], extent_[d]);
+    radius_[d] = 0.5f * scale_[d] * glm::length(size_[d]);
+}
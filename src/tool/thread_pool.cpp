@@ -0,0 +1,90 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned threadCount) : stopping_(false) {
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    workers_.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+// 工作线程主循环
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) return; // stopping_ 且队列已清空
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+// 并行 for
+// 迭代通过原子计数器动态领取；辅助任务可能在所有迭代被领取后才开始执行，
+// 因此共享状态放在 shared_ptr 中，避免引用已返回的栈帧
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        size_t count = 0;
+        const std::function<void(size_t)>* fn = nullptr;
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    auto state = std::make_shared<State>();
+    state->count = count;
+    state->fn = &fn;
+
+    auto work = [](const std::shared_ptr<State>& s) {
+        size_t finished = 0;
+        for (size_t i = s->next.fetch_add(1); i < s->count; i = s->next.fetch_add(1)) {
+            (*s->fn)(i);
+            ++finished;
+        }
+        if (finished && s->done.fetch_add(finished) + finished == s->count) {
+            std::lock_guard<std::mutex> lock(s->mutex);
+            s->cv.notify_all();
+        }
+    };
+
+    // 调用线程占用一个并发槽位，总并发度等于 threadCount()
+    size_t helpers = std::min<size_t>(workers_.size() - 1, count - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+        submit([state, work] { work(state); });
+    }
+    work(state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->done.load() == count; });
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
@@ -1,4 +1,5 @@
 #include "ui.h"
+#include "alloc_counter.h"
 #include "imgui.h"
 #include "GLFW/glfw3.h"
 
@@ -13,7 +14,7 @@ void ui_init(UIState& state, int width, int height) {
     state.last_y = height * 0.5;
     state.model = glm::mat4(1.0f);
     state.view_pos = state.camera_pos;
-    state.cubes.clear();
+    state.scene = SceneStore();
     
     // 初始化第一个立方体的配置
     CubeConfig c;
@@ -25,8 +26,7 @@ void ui_init(UIState& state, int width, int height) {
     c.color = state.cube_color;
     c.rot = state.cube_rot;
     c.visible = true;
-    state.cubes.push_back(c);
-    state.selected_cube = 0;
+    state.selected_cube = state.scene.create(c);
     
     // 计算初始矩阵
     ui_compute_matrices(state, width, height);
@@ -153,27 +153,27 @@ void ui_draw(UIState& state) {
         c.color = state.cube_color;
         c.rot = state.cube_rot;
         c.visible = true;
-        state.cubes.push_back(c);
-        state.selected_cube = int(state.cubes.size()) - 1;
+        state.selected_cube = state.scene.create(c);
     }
     ImGui::SameLine();
     if (ImGui::Button("Remove Selected")) {
-        if (state.selected_cube >= 0 && state.selected_cube < int(state.cubes.size())) {
-            state.cubes.erase(state.cubes.begin() + state.selected_cube);
-            if (state.cubes.empty()) {
-                state.selected_cube = -1;
-            } else if (state.selected_cube >= int(state.cubes.size())) {
-                state.selected_cube = int(state.cubes.size()) - 1;
-            }
+        if (state.scene.alive(state.selected_cube)) {
+            // 删除后选中编号相邻的立方体 (优先选编号更大的)
+            const uint32_t index = state.selected_cube.index;
+            state.scene.destroy(state.selected_cube);
+            state.selected_cube = state.scene.nearest(index, true);
         }
     }
     
-    // 当前选中立方体的属性编辑
-    int count = int(state.cubes.size());
-    if (count > 0) {
-        if (state.selected_cube < 0 || state.selected_cube >= count) state.selected_cube = 0;
-        ImGui::SliderInt("Selected Cube", &state.selected_cube, 0, count - 1);
-        CubeConfig& c = state.cubes[state.selected_cube];
+    // 当前选中立方体的属性编辑 (经句柄读出参数，编辑后写回)
+    // 编号为实体下标，立方体存在期间不随可见性或其他立方体的删除而变化；滑到已删除的编号时沿滑动方向跳到最近的立方体
+    if (state.scene.size() > 0) {
+        if (!state.scene.alive(state.selected_cube)) state.selected_cube = state.scene.nearest(0, true);
+        int selected = int(state.selected_cube.index);
+        if (ImGui::SliderInt("Selected Cube", &selected, 0, int(state.scene.indexCount()) - 1))
+            state.selected_cube = state.scene.nearest(uint32_t(selected), selected >= int(state.selected_cube.index));
+        CubeConfig c;
+        state.scene.get(state.selected_cube, c);
         ImGui::Checkbox("Visible", &c.visible);
         ImGui::SliderFloat3("Cube Pos", &c.pos.x, -10.0f, 10.0f);
         ImGui::SliderFloat3("Cube Rot", &c.rot.x, -180.0f, 180.0f);
@@ -182,10 +182,103 @@ void ui_draw(UIState& state) {
         ImGui::SliderFloat("Cube Length", &c.length, 0.1f, 10.0f);
         ImGui::SliderFloat("Cube Width", &c.width, 0.1f, 10.0f);
         ImGui::SliderFloat("Cube Height", &c.height, 0.1f, 10.0f);
+        state.scene.set(state.selected_cube, c);
     }
     ImGui::Separator();
 
     // 其他设置
     ImGui::DragFloat("outline width", &state.outlinewidth, 0.0001f, 0.0f, 0.1f, "%.4f");
+    // PCF 采样数 (每档为一个着色器变体，首次选择时编译)
+    const int pcfCounts[4] = { 1, 4, 8, 20 };
+    const char* pcfNames[4] = { "1", "4", "8", "20" };
+    int pcfIndex = 3;
+    for (int i = 0; i < 4; ++i) {
+        if (state.shadow_pcf_samples == pcfCounts[i]) pcfIndex = i;
+    }
+    if (ImGui::Combo("PCF samples", &pcfIndex, pcfNames, 4)) state.shadow_pcf_samples = pcfCounts[pcfIndex];
+    // 阴影渲染模式 (两种模式的耗时分别统计)
+    ImGui::Checkbox("layered shadow pass", &state.shadow_layered);
+    ImGui::Text("Shadow (%s): per-face CPU %.2f / GPU %.2f ms, layered CPU %.2f / GPU %.2f ms",
+                state.shadow_layered_active ? "layered" : "per-face",
+                state.shadow_cpu_ms[0], state.shadow_gpu_ms[0], state.shadow_cpu_ms[1], state.shadow_gpu_ms[1]);
+    ImGui::Text("Shadow cache: %d faces rendered, %d skipped (version %016llx)",
+                state.shadow_faces_rendered, state.shadow_faces_skipped, (unsigned long long)state.shadow_version);
+    ImGui::Text("Shadow casters per face: %zu %zu %zu %zu %zu %zu of %zu",
+                state.shadow_casters[0], state.shadow_casters[1], state.shadow_casters[2],
+                state.shadow_casters[3], state.shadow_casters[4], state.shadow_casters[5], state.shadow_caster_candidates);
+    ImGui::Separator();
+
+    // 模型加载进度
+    ImGui::Text("Model: %zu / %zu meshes", state.load_meshes, state.load_total);
+    ImGui::Text("First frame %.1f ms, first mesh %.1f ms, fully loaded %.1f ms",
+                state.load_first_frame_ms, state.load_first_mesh_ms, state.load_all_ms);
+    ImGui::Separator();
+
+    // 渲染部分每帧计数 (分配次数只在以 ANIM_COUNT_ALLOCS 构建时统计)
+    if (kAllocCountEnabled) ImGui::Text("Frame: %llu allocs", (unsigned long long)state.frame_allocs);
+    else ImGui::TextDisabled("Frame: allocs not counted (build with ANIM_COUNT_ALLOCS)");
+    ImGui::Text("Uniforms: %llu lookups / %llu uploads / %llu skipped", (unsigned long long)state.frame_uniform_lookups,
+                (unsigned long long)state.frame_uniform_uploads, (unsigned long long)state.frame_uniform_redundant);
+    ImGui::Text("GL state: %llu calls issued, %llu elided",
+                (unsigned long long)state.frame_gl_issued, (unsigned long long)state.frame_gl_elided);
+    ImGui::Text("Queue: %zu draws, %zu program / %zu material / %zu geometry changes",
+                state.queue_packets, state.queue_program_changes, state.queue_material_changes, state.queue_geometry_changes);
+    ImGui::Text("Cubes: %zu (%zu visible), %zu bytes uploaded", state.scene.size(), state.scene.visibleCount(),
+                state.frame_instance_bytes);
+    ImGui::Separator();
+
+    // LOD 控制与统计
+    ImGui::Text("LOD");
+    ImGui::Checkbox("LOD Enabled", &state.lod_enabled);
+    ImGui::SliderFloat("LOD Error (px)", &state.lod_error_px, 0.25f, 16.0f, "%.2f");
+    ImGui::SliderFloat("Shadow LOD Bias", &state.lod_shadow_bias, 1.0f, 16.0f, "%.1f");
+    ImGui::SliderFloat("LOD Hysteresis", &state.lod_hysteresis, 0.0f, 0.5f, "%.2f");
+    for (int l = 0; l < state.lod_levels && l < kMaxLodLevels; ++l) {
+        ImGui::Text("L%d: %zu tris, main %zu / shadow %zu meshes", l, state.lod_level_tris[l],
+                    state.lod_main_meshes[l], state.lod_shadow_meshes[l]);
+    }
+    ImGui::Text("Main tris: %zu / %zu", state.lod_main_tris, state.lod_full_tris);
+    ImGui::Text("Shadow tris: %zu / %zu", state.lod_shadow_tris, state.lod_full_tris * 6);
+    ImGui::Text("Frame: %.2f ms (LOD on) / %.2f ms (LOD off)", state.frame_ms_lod_on, state.frame_ms_lod_off);
+    ImGui::Separator();
+
+    // 逐簇剔除控制与统计
+    ImGui::Text("Cluster Culling (%zu clusters)", state.cluster_count);
+    ImGui::Checkbox("Cluster Culling", &state.cluster_culling);
+    ImGui::Checkbox("Backface Clusters (Main)", &state.cluster_backface_main);
+    ImGui::Checkbox("Backface Clusters (Shadow)", &state.cluster_backface_shadow);
+    const ClusterCullStats* passes[2] = { &state.cluster_main, &state.cluster_shadow };
+    const char* names[2] = { "Main", "Shadow" };
+    for (int p = 0; p < 2; ++p) {
+        const ClusterCullStats& c = *passes[p];
+        ImGui::Text("%s: %zu / %zu tris, meshes culled %zu, clusters frustum %zu backface %zu of %zu", names[p],
+                    c.triangles, c.fullTriangles, c.meshesCulled, c.frustumCulled, c.backfaceCulled, c.clusters);
+    }
+    ImGui::Separator();
+
+    // 主 Pass 视锥剔除
+    ImGui::Checkbox("Frustum Culling", &state.frustum_culling);
+    ImGui::Text("Visible: meshes %zu / %zu, cubes %zu / %zu (%.3f ms)",
+                state.frustum_meshes.visible, state.frustum_meshes.tested,
+                state.frustum_cubes.visible, state.frustum_cubes.tested, state.frustum_cull_ms);
+    ImGui::Text("Cube BVH: %zu nodes, SAH %.2fx of build, %zu rebuilds, %zu refits, frustum query %zu nodes",
+                state.bvh.nodes, state.bvh.sahRatio, state.bvh.rebuilds, state.bvh.refits, state.bvh_query_nodes);
+    ImGui::TextDisabled("Click a cube (UI mode) to select it");
+
+    // 遮挡剔除 (开启视锥剔除时只测试视锥内的候选)
+    ImGui::Checkbox("Occlusion Culling", &state.occlusion_culling);
+    ImGui::SameLine();
+    ImGui::Checkbox("Show Buffer", &state.occlusion_debug);
+    const size_t occluded = state.occlusion_meshes + state.occlusion_cubes;
+    ImGui::Text("Occluded: meshes %zu, cubes %zu of %zu tested (%.1f%%, %.3f ms)", state.occlusion_meshes, state.occlusion_cubes,
+                state.occlusion_tested, state.occlusion_tested ? 100.0f * float(occluded) / float(state.occlusion_tested) : 0.0f,
+                state.occlusion_ms);
+    ImGui::Text("Occluders: %zu meshes, %zu tris (%zu rasterized)", state.occlusion_raster.occluders,
+                state.occlusion_raster.triangles, state.occlusion_raster.rasterized);
+    if (state.occlusion_debug && state.occlusion_texture) {
+        // 缓冲区第 0 行为屏幕底部，纵向翻转显示
+        ImGui::Image((ImTextureID)(intptr_t)state.occlusion_texture,
+                     ImVec2(float(state.occlusion_size[0]), float(state.occlusion_size[1])), ImVec2(0, 1), ImVec2(1, 0));
+    }
     ImGui::End();
 }